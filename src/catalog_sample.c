@@ -0,0 +1,60 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <wchar.h>
+#include <locale.h>
+
+/* 대용량 테스트용 client, book, borrow 파일 생성
+ *
+ * 사용법: catalog_sample [도서 수]
+ * 회원 수는 도서 수의 1/10, 대여 수는 도서 수의 1/20로 만든다.
+ */
+int main(int argc, char *argv[])
+{
+	setlocale(LC_ALL, "");
+
+	long book_count = 400000;
+	if (argc > 1)
+		book_count = atol(argv[1]);
+	long client_count = book_count / 10;
+	long borrow_count = book_count / 20;
+	long i;
+	FILE *file;
+
+	/* 회원 */
+	file = fopen("client", "w");
+	if (file == NULL)
+		return 1;
+	for (i = 0; i < client_count; ++i)
+	{
+		fwprintf(file,
+			L"%08ld | %ls | %ls | %ls | %ls | ",
+			20180000 + i, L"1234", L"홍길동", L"서울시 동작구 상도동 숭실대학교", L"01012345678");
+	}
+	fclose(file);
+
+	/* 도서 */
+	file = fopen("book", "w");
+	if (file == NULL)
+		return 1;
+	for (i = 0; i < book_count; ++i)
+	{
+		fwprintf(file,
+			L"%07ld | Cygwin과 함께 배우는 C 프로그래밍%ld | %ls | %ls | 978%010ld | %ls | %lc | ",
+			i + 1, i / 4, L"홍릉과학출판사", L"김명호", i / 4, L"중앙도서관 3층 자연과학실", i < borrow_count ? L'N' : L'Y');
+	}
+	fclose(file);
+
+	/* 대여 */
+	file = fopen("borrow", "w");
+	if (file == NULL)
+		return 1;
+	for (i = 0; i < borrow_count; ++i)
+	{
+		fwprintf(file,
+			L"%08ld | Cygwin과 함께 배우는 C 프로그래밍%ld | %07ld | %lld | %lld | ",
+			20180000 + i % client_count, i / 4, i + 1, 1541203200LL + i * 60, 1541203200LL + i * 60 + 30 * 24 * 60 * 60);
+	}
+	fclose(file);
+
+	return 0;
+}
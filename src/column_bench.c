@@ -0,0 +1,134 @@
+#define main library_main
+#include "main.c"
+#undef main
+
+/* 도서 열 벤치마크
+ *
+ * 사용법: gcc -O2 -o column_bench src/column_bench.c && ./column_bench [도서 수]
+ * catalog_sample과 같은 도서(기본 400000권, 3권 중 2권 대여 중)를 열 색인과 연결 리스트에 같이 넣고,
+ * 대여 가능 수와 ISBN 범위의 대여 가능 수를 세는 시간을 비교한다. 각 값은 5번 중 가장 빠른 시간이다.
+ * 연결 리스트는 열을 만들기 전처럼 도서마다 노드와 Book을 따로 할당한다.
+ * 열을 번호 순서로 훑는 것은 세기만 하는 질의(count_book_columns)이고,
+ * 도서를 돌려주는 검색은 ISBN 순서를 지켜야 하므로 후보를 열로 거르기만 한다(match_book_columns).
+ */
+#define BENCH_REPEAT 5
+
+static double get_elapsed_ms(const struct timespec *begin)
+{
+	return get_elapsed_ns(begin) / 1000000.0;
+}
+
+static size_t count_list(const LinkedList *list, const uint64_t low, const uint64_t high)
+{
+	size_t count = 0;
+	const Book *book;
+
+	for (; list != NULL; list = list->next)
+	{
+		book = list->contents;
+		if (book->availability == L'Y' && book->ISBN >= low && book->ISBN < high)
+			++count;
+	}
+	return count;
+}
+
+static void count_visit(const Book *book, void *context)
+{
+	(void)book;
+	++*(size_t *)context;
+}
+
+int main(int argc, char *argv[])
+{
+	if (set_utf8_locale() == EOF)
+		return 1;
+
+	const wchar_t *queries[] = {L"available", L"isbn = 978000001 AND available"};
+	const uint64_t lows[] = {0, 9780000010000ULL};
+	const uint64_t highs[] = {ISBN_KEY_OTHER + 1, 9780000020000ULL};
+	long book_count = 400000;
+	if (argc > 1)
+		book_count = atol(argv[1]);
+
+	RecordArena arena;
+	Table books;
+	BookIndex index;
+	LinkedList *list = NULL;
+	LinkedList *node;
+	Book *book;
+	wchar_t name[SIZE_INPUT_MAX];
+	struct timespec begin;
+	double best[3];
+	size_t count[3];
+	long i;
+	int q, r;
+
+	/* 도서 */
+	init_record_arena(&arena, sizeof(Book));
+	init_table(&books);
+	init_book_index(&index);
+	for (i = 0; i < book_count; ++i)
+	{
+		swprintf(name, SIZE_INPUT_MAX, L"Cygwin과 함께 배우는 C 프로그래밍%ld", i / 4);
+		book = allocate_record(&arena);
+		memset(book, 0, sizeof(Book));
+		book->number = i + 1;
+		book->name = create_arena_string(&arena, name);
+		book->publisher = intern_arena_string(&arena, L"홍릉과학출판사");
+		book->author = intern_arena_string(&arena, L"김명호");
+		book->location = intern_arena_string(&arena, L"중앙도서관 3층 자연과학실");
+		book->ISBN = 9780000000000ULL + i / 4;
+		book->availability = (i + 1) % 3 ? L'N' : L'Y';
+		insert_book(&books, &index, book);
+
+		node = malloc(sizeof(LinkedList));
+		node->contents = malloc(sizeof(Book));
+		memcpy(node->contents, book, sizeof(Book));
+		node->next = list;
+		list = node;
+	}
+	finish_book_index(&index);
+
+	/* 연결 리스트, 세기만 하는 질의, 도서를 돌려주는 질의 */
+	Query *query = malloc(sizeof(Query));
+	for (q = 0; q < 2; ++q)
+	{
+		parse_query(queries[q], query);
+		plan_query(&index, query);
+		best[0] = best[1] = best[2] = 1e9;
+		for (r = 0; r < BENCH_REPEAT; ++r)
+		{
+			clock_gettime(CLOCK_MONOTONIC, &begin);
+			count[0] = count_list(list, lows[q], highs[q]);
+			if (get_elapsed_ms(&begin) < best[0])
+				best[0] = get_elapsed_ms(&begin);
+
+			clock_gettime(CLOCK_MONOTONIC, &begin);
+			count[1] = run_query(&index, query, NULL, NULL);
+			if (get_elapsed_ms(&begin) < best[1])
+				best[1] = get_elapsed_ms(&begin);
+
+			count[2] = 0;
+			clock_gettime(CLOCK_MONOTONIC, &begin);
+			run_query(&index, query, count_visit, &count[2]);
+			if (get_elapsed_ms(&begin) < best[2])
+				best[2] = get_elapsed_ms(&begin);
+		}
+		wprintf(L"%ls: list %zu books %.2f ms, count only %zu books %.2f ms, visiting books %zu books %.2f ms\n",
+			queries[q], count[0], best[0], count[1], best[1], count[2], best[2]);
+	}
+	free(query);
+
+	while (list != NULL)
+	{
+		node = list->next;
+		free(list->contents);
+		free(list);
+		list = node;
+	}
+	destroy_book_index(&index);
+	destroy_table(&books);
+	release_record_arena(&arena);
+
+	return 0;
+}
@@ -0,0 +1,100 @@
+#define main library_main
+#include "main.c"
+#undef main
+
+/* 비슷한 도서명 검색 벤치마크
+ *
+ * 사용법: gcc -O2 -o fuzzy_bench src/fuzzy_bench.c && ./fuzzy_bench [도서 수]
+ * catalog_sample과 같은 식으로 도서 수(기본 1000000)만큼 제목을 만들어 색인한 뒤,
+ * 틀린 제목으로 find_books_by_similar_name을 부르고 걸린 시간을 출력한다.
+ * 그램 목록을 합쳐 후보를 고르는 방법과 길이만 보고 모든 제목을 훑는 방법의 결과가 같은지도 확인한다.
+ */
+static double get_elapsed_ms(const struct timespec *begin)
+{
+	return get_elapsed_ns(begin) / 1000000.0;
+}
+
+int main(int argc, char *argv[])
+{
+	if (set_utf8_locale() == EOF)
+		return 1;
+
+	const wchar_t *titles[] = {
+		L"Cygwin과 함께 배우는 C 프로그래밍", L"자료구조와 알고리즘", L"운영체제 개념", L"Computer Networks",
+		L"데이터베이스 시스템", L"컴파일러 설계", L"선형대수학 입문", L"Linux System Programming"
+	};
+	const wchar_t *queries[] = {
+		L"자료구조와 알고리듬 1234", L"computer netwroks 777", L"운영체재 개념 5",
+		L"Linux Sytsem Programing 42", L"컴파일러 설게", L"운영체재"
+	};
+	long book_count = 1000000;
+	if (argc > 1)
+		book_count = atol(argv[1]);
+
+	RecordArena arena;
+	Table books;
+	BookIndex index;
+	Book *book;
+	wchar_t name[SIZE_INPUT_MAX];
+	struct timespec begin;
+	long i;
+
+	/* 도서 */
+	init_record_arena(&arena, sizeof(Book));
+	init_table(&books);
+	init_book_index(&index);
+	clock_gettime(CLOCK_MONOTONIC, &begin);
+	for (i = 0; i < book_count; ++i)
+	{
+		swprintf(name, SIZE_INPUT_MAX, L"%ls %ld", titles[i % 8], i / 8);
+		book = allocate_record(&arena);
+		memset(book, 0, sizeof(Book));
+		book->number = i + 1;
+		book->name = create_arena_string(&arena, name);
+		book->publisher = intern_arena_string(&arena, L"홍릉과학출판사");
+		book->author = intern_arena_string(&arena, L"김명호");
+		book->location = intern_arena_string(&arena, L"중앙도서관 3층 자연과학실");
+		book->ISBN = 9780000000000ULL + i / 4;
+		book->availability = L'Y';
+		insert_book(&books, &index, book);
+	}
+	finish_book_index(&index);
+	wprintf(L"index %ld books: %.0f ms\n", book_count, get_elapsed_ms(&begin));
+
+	/* 검색, is_building이면 그램 목록을 쓰지 않고 길이로만 거름 */
+	for (i = 0; i < (long)(sizeof(queries) / sizeof(queries[0])); ++i)
+	{
+		const size_t distance = get_fuzzy_distance(queries[i]);
+		LinkedList *found[2];
+		double elapsed[2];
+		size_t count[2];
+		int mode;
+
+		for (mode = 0; mode < 2; ++mode)
+		{
+			index.keyword_grams.is_building = mode;
+			clock_gettime(CLOCK_MONOTONIC, &begin);
+			found[mode] = find_books_by_similar_name(&index, queries[i], distance);
+			elapsed[mode] = get_elapsed_ms(&begin);
+			count[mode] = 0;
+			for (LinkedList *node = found[mode]; node != NULL; node = node->next)
+				++count[mode];
+		}
+		index.keyword_grams.is_building = 0;
+
+		int is_same = count[0] == count[1];
+		for (LinkedList *gram = found[0], *scan = found[1]; is_same && gram != NULL; gram = gram->next, scan = scan->next)
+			is_same = gram->contents == scan->contents;
+
+		wprintf(L"%ls (k=%zu): %zu books, grams %.2f ms, length scan %.2f ms, %ls\n",
+			queries[i], distance, count[0], elapsed[0], elapsed[1], is_same ? L"same" : L"DIFFERENT");
+		destroy_list(found[0]);
+		destroy_list(found[1]);
+	}
+
+	destroy_book_index(&index);
+	destroy_table(&books);
+	release_record_arena(&arena);
+
+	return 0;
+}
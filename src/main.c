@@ -1,11 +1,19 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
 #include <string.h>
 #include <wchar.h>
+#include <wctype.h>
 #include <time.h>
 #include <unistd.h>
 #include <locale.h>
+#include <langinfo.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 /*  Screen type define
  *
@@ -30,7 +38,8 @@
 #define SCREEN_RETURN_BOOK 8
 #define SCREEN_FIND_BOOK 9
 #define SCREEN_MODIFY_CLIENT 10
-#define SCREEN_MAX 11
+#define SCREEN_DUE_BORROW 11
+#define SCREEN_MAX 12
 
 /*  String size define
  */
@@ -38,15 +47,221 @@
 #define SIZE_PHONE_NUMBER 13
 
 #define SIZE_BOOK_NUMBER 7
+#define BOOK_NUMBER_MAX 9999999u
 #define SIZE_ISBN 13
 
 #define SIZE_INPUT_MAX 100
+// UTF-8 문자열을 변환할 때 쓰는 임시 버퍼 크기
+#define SIZE_TEXT_MAX 1024
+
+#define SIZE_READ_BLOCK 65536
+
+#define SIZE_CLIENT_INDEX_MIN 64
+
+#define TABLE_CHUNK_BITS 12
+#define SIZE_TABLE_CHUNK (1 << TABLE_CHUNK_BITS)
+
+#define BOOK_INDEX_PAGE_BITS 12
+#define SIZE_BOOK_INDEX_PAGE (1 << BOOK_INDEX_PAGE_BITS)
+
+#define SIZE_TREE_NODE 32
+
+#define SIZE_POSTING_INDEX_MIN 64
+#define SIZE_SYMBOL_TABLE_MIN 64
+#define SIZE_GRAM_INDEX_MIN 1024
+
+#define SIZE_ARENA_CHUNK 262144
+#define SIZE_ARENA_ALIGN 8
+
+/*  Student number define
+ *
+ *  Student number has 8 digits, so it's saved as number(less than 10^8).
+ *  admin has STUDENT_NUMBER_ADMIN, so it's sorted after students.
+ *  STUDENT_NUMBER_NONE means the string isn't student number.
+ */
+#define STUDENT_NUMBER_ADMIN 100000000u
+#define STUDENT_NUMBER_NONE 0xFFFFFFFFu
+
+/*  Phone number define
+ *
+ *  Digits of phone number are saved as number and the digit count is in low PHONE_NUMBER_COUNT_BITS bits,
+ *  so leading zeros are kept. 0 is empty phone number.
+ *  PHONE_NUMBER_NONE means the string isn't phone number.
+ */
+#define PHONE_NUMBER_COUNT_BITS 4
+#define PHONE_NUMBER_NONE 0xFFFFFFFFFFFFFFFFULL
+
+/*  ISBN key define
+ *
+ *  13 digits ISBN is converted to number(less than 10^13).
+ *  Book without valid ISBN has ISBN_KEY_OTHER, so it's sorted after valid ISBNs and printed as empty string.
+ */
+#define ISBN_KEY_OTHER 10000000000000ULL
+
+/*  Keyword gram define
+ *
+ *  Hangul syllable starts bigram, other character starts trigram.
+ *  Characters of gram are packed by GRAM_CHAR_BITS.
+ */
+#define GRAM_HANGUL_FIRST 0xAC00
+#define GRAM_HANGUL_LAST 0xD7A3
+#define GRAM_HANGUL_SIZE 2
+#define GRAM_OTHER_SIZE 3
+#define GRAM_CHAR_BITS 21
+
+/*  Choseong key define
+ *
+ *  Choseong of Hangul syllables are packed to 64 bits key from high bits.
+ *  Only first CHOSEONG_KEY_SIZE choseong are packed, longer keys are checked with string.
+ *  Choseong is numbered from 1, so shorter key is before longer key.
+ */
+#define CHOSEONG_COUNT 19
+#define CHOSEONG_BITS 5
+#define CHOSEONG_KEY_SIZE 12
+#define CHOSEONG_SYLLABLE_COUNT 588
+
+/*  Title suggestion define
+ *
+ *  Every node of title trie keeps SIZE_SUGGESTION most borrowed titles under it.
+ */
+#define SIZE_SUGGESTION 10
+
+/*  Due borrow define
+ *
+ *  Default count of due list, when count isn't given.
+ */
+#define SIZE_DUE_LIST 10
+
+/*  Fuzzy search define
+ *
+ *  Allowed edit distance is 1 for every FUZZY_LENGTH_PER_DISTANCE characters of query, at most FUZZY_DISTANCE_MAX.
+ *  Query is saved as bit vectors of FUZZY_WORD_BITS bits.
+ */
+#define FUZZY_LENGTH_PER_DISTANCE 4
+#define FUZZY_DISTANCE_MAX 3
+#define FUZZY_WORD_BITS 64
+#define FUZZY_WORD_COUNT ((SIZE_INPUT_MAX + FUZZY_WORD_BITS - 1) / FUZZY_WORD_BITS)
+#define SIZE_FUZZY_TABLE 256
+
+/*  Book query define
+ *
+ *  Query is disjunction of terms, term is conjunction of conditions.
+ *  e.g. author = 김명호 AND available OR keyword = 알고리즘
+ */
+#define QUERY_NAME 0
+#define QUERY_AUTHOR 1
+#define QUERY_PUBLISHER 2
+#define QUERY_ISBN 3
+#define QUERY_KEYWORD 4
+#define QUERY_CHOSEONG 5
+#define QUERY_AVAILABLE 6
+#define QUERY_FIELD_MAX 7
+#define SIZE_QUERY_TERM_MAX 8
+#define SIZE_QUERY_CONDITION_MAX 8
+#define STRING_QUERY_AND L" AND "
+#define STRING_QUERY_OR L" OR "
+#define STRING_QUERY_EXPLAIN L"EXPLAIN "
+
+/*  Book cursor type
+ *
+ *  BOOK_CURSOR_POSTINGS reads books array of postings.
+ *  BOOK_CURSOR_ISBN reads range of ISBN tree, same ISBN is read backward to be book number order.
+ *  BOOK_CURSOR_GRAMS reads book numbers of gram postings.
+ *  BOOK_CURSOR_CHOSEONG reads range of choseong tree.
+ *  BOOK_CURSOR_ALL reads all books in ISBN tree.
+ *  BOOK_CURSOR_LIST reads book list made by search.
+ */
+#define BOOK_CURSOR_EMPTY 0
+#define BOOK_CURSOR_POSTINGS 1
+#define BOOK_CURSOR_ISBN 2
+#define BOOK_CURSOR_GRAMS 3
+#define BOOK_CURSOR_CHOSEONG 4
+#define BOOK_CURSOR_ALL 5
+#define BOOK_CURSOR_LIST 6
 
 /* String const
  */
 #define STRING_CLIENT_FILE "client"
 #define STRING_BOOK_FILE "book"
 #define STRING_BORROW_FILE "borrow"
+#define STRING_CLIENT_SNAPSHOT_FILE "client.snapshot"
+#define STRING_BOOK_SNAPSHOT_FILE "book.snapshot"
+#define STRING_BORROW_SNAPSHOT_FILE "borrow.snapshot"
+#define STRING_HISTORY_FILE "history"
+#define STRING_BROKEN_EXTENSION ".broken"
+#define STRING_REJECTED_EXTENSION ".rejected"
+#define STRING_SNAPSHOT_MAGIC "LIBSNAP"
+#define STRING_TEMP_EXTENSION ".tmp"
+
+/*  Snapshot define
+ *
+ *  If you change record or header layout, increase SNAPSHOT_VERSION.
+ *  Snapshot with other version isn't loaded, text file is imported instead.
+ */
+#define SNAPSHOT_VERSION 7
+#define SNAPSHOT_CLIENT 0
+#define SNAPSHOT_BOOK 1
+#define SNAPSHOT_BORROW 2
+#define SNAPSHOT_MAX 3
+#define SNAPSHOT_HISTORY SNAPSHOT_MAX
+#define SNAPSHOT_SEGMENT_MAX 32
+
+/*  Loan history define
+ *
+ *  History file isn't made again from text file, so it has own version.
+ *  It starts from SNAPSHOT_VERSION of the first history file(7).
+ *  If you change LoanRecord layout, increase HISTORY_VERSION.
+ *  Loan history keeps loan date of first record of every SIZE_HISTORY_BLOCK records.
+ */
+#define HISTORY_VERSION 7
+#define SIZE_HISTORY_BLOCK 4096
+
+/*  Dirty flag define
+ *
+ *  DIRTY_INSERTED: Record isn't in snapshot file.
+ *  DIRTY_STRINGS: Record's strings are changed, record is appended to snapshot again.
+ *  DIRTY_AVAILABILITY, DIRTY_PHONE_NUMBER, DIRTY_LOAN_COUNT: Fixed size field is changed, it is patched in place.
+ */
+#define DIRTY_INSERTED 1
+#define DIRTY_STRINGS 2
+#define DIRTY_AVAILABILITY 4
+#define DIRTY_PHONE_NUMBER 8
+#define DIRTY_LOAN_COUNT 16
+
+/*  Journal define
+ *
+ *  Every change is appended to journal file as one entry.
+ *  Journal is replayed on the snapshot at start.
+ *  If journal has JOURNAL_CHECKPOINT_SIZE entries, snapshots are saved and journal is cleared.
+ */
+#define STRING_JOURNAL_FILE "journal"
+#define STRING_JOURNAL_FAILED L"변경 사항을 기록하지 못했습니다. 다음 변경이나 종료할 때 다시 기록합니다.\n"
+#define JOURNAL_CHECKPOINT_SIZE 1000
+
+/*  Group commit define
+ *
+ *  Entries are kept in memory and written with one fsync(group commit).
+ *  Changes are acknowledged after their group is committed.
+ *  Group is committed when JOURNAL_COMMIT_WINDOW_MS passed from the first entry
+ *  or it has JOURNAL_COMMIT_SIZE entries.
+ *  The program is single threaded, so nothing can join the group while waiting and the window is 0.
+ *  Raise it only when changes can come from other threads.
+ *  If JOURNAL_SYNC is 0, entries are written without fsync and waiting.
+ *  If commit fails, entries are kept in group and written again at the next commit.
+ */
+#define JOURNAL_SYNC 1
+#define JOURNAL_COMMIT_WINDOW_MS 0
+#define JOURNAL_COMMIT_SIZE 64
+#define JOURNAL_INSERT_CLIENT 0
+#define JOURNAL_UPDATE_CLIENT 1
+#define JOURNAL_REMOVE_CLIENT 2
+#define JOURNAL_INSERT_BOOK 3
+#define JOURNAL_REMOVE_BOOK 4
+#define JOURNAL_BORROW_BOOK 5
+#define JOURNAL_RETURN_BOOK 6
+#define JOURNAL_RESERVE_BOOK_NUMBERS 7
+#define JOURNAL_MAX 8
+#define SIZE_JOURNAL_FIELD_MAX 8
 
 struct _LinkedList
 {
@@ -55,40 +270,650 @@ struct _LinkedList
 };
 typedef struct _LinkedList LinkedList;
 
+/*  Table of records
+ *
+ *  Record pointers are kept in chunks of SIZE_TABLE_CHUNK slots.
+ *  Chunks aren't moved, so slot number is record's handle while it is in the table.
+ *  Removed slot is NULL and its number is pushed to free_handles, it is used again first.
+ *  Table has no order, ordered records are read by index trees.
+ *
+ *  size is the number of slots used once, count is the number of records.
+ */
+typedef struct Table
+{
+    void ***chunks;
+    size_t chunk_count;
+    uint32_t size;
+    uint32_t count;
+    uint32_t *free_handles;
+    size_t free_count;
+    size_t free_capacity;
+} Table;
+
+/*  Interned string
+ *
+ *  id is the order of interning, snapshot writer uses it as string's offset.
+ */
+typedef struct Symbol
+{
+    uint64_t hash;
+    const char *string;
+    uint64_t id;
+} Symbol;
+
+/*  Hash set of interned strings
+ *
+ *  Same strings share one copy, so they can be compared by address.
+ *  Symbols aren't removed until the table is destroyed.
+ */
+typedef struct SymbolTable
+{
+    Symbol *slots;
+    size_t count;
+    size_t capacity;
+} SymbolTable;
+
+/*  Chunk of arena
+ *
+ *  Memory of size bytes follows the header, used bytes of it are given.
+ */
+typedef struct ArenaChunk
+{
+    struct ArenaChunk *next;
+    size_t size;
+    size_t used;
+} ArenaChunk;
+
+/*  Arena of a table's records
+ *
+ *  Records and their strings are allocated from chunks of SIZE_ARENA_CHUNK.
+ *  Removed record is linked in free_records by it's first bytes and allocated again.
+ *  Strings aren't freed one by one, they are freed with the arena.
+ *  symbols has interned strings of the arena or the mapped snapshot.
+ *
+ *  record_count is the number of used records, chunk_bytes is the size of all chunks.
+ */
+typedef struct RecordArena
+{
+    size_t record_size;
+    ArenaChunk *record_chunks;
+    ArenaChunk *string_chunks;
+    void *free_records;
+    size_t record_count;
+    size_t chunk_bytes;
+    SymbolTable symbols;
+} RecordArena;
+
+/*  Record's strings
+ *
+ *  Strings are UTF-8, they are converted to wide string only when printed.
+ *  Strings are in the table's arena or the mapped snapshot.
+ *  They shouldn't be freed or changed, changed string is allocated again.
+ *  publisher, author and location of Book are interned, same strings have same address.
+ *  student_number, phone_number and ISBN are saved as numbers, see STUDENT_NUMBER_*, PHONE_NUMBER_* and ISBN_KEY_OTHER.
+ *
+ *  handle is record's slot in it's table.
+ *  snapshot_offset is record's position in snapshot file, 0 if it isn't saved.
+ *  dirty has DIRTY_* flags changed after saving snapshot.
+ */
 typedef struct Client
 {
-    wchar_t student_number[SIZE_STUDENT_NUMBER + 1];
-    wchar_t phone_number[SIZE_PHONE_NUMBER + 1];
-    wchar_t *password;
-    wchar_t *name;
-    wchar_t *address;
+    uint32_t student_number;
+    uint32_t handle;
+    uint64_t phone_number;
+    char *password;
+    char *name;
+    char *address;
+    unsigned char dirty;
+    uint64_t snapshot_offset;
 } Client;
 
 typedef struct Book
 {
-    wchar_t number[SIZE_BOOK_NUMBER + 1];
-    wchar_t ISBN[SIZE_ISBN + 1];
+    uint32_t number;
+    uint32_t loan_count;
+    uint64_t ISBN;
     wchar_t availability;
-    wchar_t *name;
-    wchar_t *publisher;
-    wchar_t *author;
-    wchar_t *location;
+    uint32_t handle;
+    char *name;
+    char *publisher;
+    char *author;
+    char *location;
+    unsigned char dirty;
+    uint64_t snapshot_offset;
 } Book;
 
 typedef struct Borrow
 {
-    wchar_t student_number[SIZE_STUDENT_NUMBER + 1];
-    wchar_t book_number[SIZE_BOOK_NUMBER + 1];
-    wchar_t *book_name;
+    uint32_t student_number;
+    uint32_t book_number;
+    char *book_name;
     time_t loan_date;
     time_t return_date;
+    unsigned char dirty;
+    uint32_t handle;
+    uint64_t snapshot_offset;
 } Borrow;
 
+/*  Snapshot file layout
+ *
+ *  [SnapshotHeader][segment][segment]...
+ *  segment: [SnapshotSegmentHeader][records...][string table]
+ *  Record has fixed size, string is saved as offset(byte) in segment's string table.
+ *  String table has NUL terminated UTF-8 strings.
+ *  Same publisher, author and location of books in a segment are saved once and share the offset.
+ *
+ *  Checkpoint appends new or changed records as a new segment,
+ *  patches fixed size fields in place and sets is_removed of removed records.
+ *  Record in later segment replaces record which has same key.
+ *
+ *  next_key is the next book number to allocate, only book snapshot uses it.
+ */
+typedef struct SnapshotHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t type;
+    uint32_t wchar_size;
+    uint32_t record_size;
+    uint64_t segment_count;
+    uint64_t record_count;
+    uint64_t removed_count;
+    uint64_t file_size;
+    uint64_t next_key;
+} SnapshotHeader;
+
+typedef struct SnapshotSegmentHeader
+{
+    uint64_t record_count;
+    uint64_t string_size;
+} SnapshotSegmentHeader;
+
+typedef struct ClientRecord
+{
+    uint32_t student_number;
+    uint64_t phone_number;
+    uint64_t password;
+    uint64_t name;
+    uint64_t address;
+    uint32_t is_removed;
+} ClientRecord;
+
+typedef struct BookRecord
+{
+    uint32_t number;
+    uint32_t loan_count;
+    uint64_t ISBN;
+    wchar_t availability;
+    uint64_t name;
+    uint64_t publisher;
+    uint64_t author;
+    uint64_t location;
+    uint32_t is_removed;
+} BookRecord;
+
+typedef struct BorrowRecord
+{
+    uint32_t student_number;
+    uint32_t book_number;
+    uint64_t book_name;
+    int64_t loan_date;
+    int64_t return_date;
+    uint32_t is_removed;
+} BorrowRecord;
+
+/*  Segment in mapped snapshot
+ */
+typedef struct SnapshotSegment
+{
+    const void *records;
+    uint64_t record_count;
+    const char *strings;
+    uint64_t string_size;
+} SnapshotSegment;
+
+/*  Snapshot of table
+ *
+ *  address, size: Mapped snapshot file.
+ *  need_rewrite: Snapshot file isn't valid, all records should be written again.
+ *  dirty_list: Records changed after saving snapshot.
+ *  removed_offsets: Offsets of removed records in snapshot file.
+ */
+typedef struct Snapshot
+{
+    void *address;
+    size_t size;
+    _Bool need_rewrite;
+    LinkedList *dirty_list;
+    uint64_t *removed_offsets;
+    size_t removed_count;
+    size_t removed_capacity;
+} Snapshot;
+
+/*  Loan history file layout
+ *
+ *  [SnapshotHeader][LoanRecord...]
+ *  Every loan made is saved, returned loan too.
+ *  Records are sorted by loan date, student number and book number.
+ *  Checkpoint appends new loans, file is written again only if a loan is older than the last.
+ */
+typedef struct LoanRecord
+{
+    int64_t loan_date;
+    uint32_t student_number;
+    uint32_t book_number;
+} LoanRecord;
+
+/*  Loan history
+ *
+ *  snapshot, records: Mapped history file.
+ *  is_broken: History file exists but can't be read, it is moved aside before saving.
+ *  fences: Loan date of first record of every block, made at first search.
+ *  pending: Loans after last checkpoint, sorted.
+ */
+typedef struct LoanHistory
+{
+    Snapshot snapshot;
+    const LoanRecord *records;
+    size_t count;
+    _Bool is_broken;
+    int64_t *fences;
+    size_t fence_count;
+    LoanRecord *pending;
+    size_t pending_count;
+    size_t pending_capacity;
+} LoanHistory;
+
+/*  Journal file layout
+ *
+ *  [JournalEntryHeader][fields]...
+ *  Fields are NUL terminated wide strings, numbers are saved as decimal string.
+ *  Checksum is calculated by header(except checksum) and fields.
+ */
+typedef struct JournalEntryHeader
+{
+    uint32_t type;
+    uint32_t count;
+    uint32_t size;
+    uint32_t checksum;
+} JournalEntryHeader;
+
+/*  Journal statistics
+ *
+ *  Latency is time from the first entry of group to the end of commit.
+ */
+typedef struct JournalStat
+{
+    uint64_t commit_count;
+    uint64_t entry_count;
+    uint64_t total_latency_ns;
+    uint64_t max_latency_ns;
+} JournalStat;
+
+typedef struct Journal
+{
+    int file;
+    _Bool is_read_only;
+    uint64_t entry_count;
+    char *buffer;
+    size_t buffer_size;
+    size_t buffer_capacity;
+    uint32_t pending_count;
+    struct timespec pending_time;
+    JournalStat stat;
+} Journal;
+
+/*  Client index slot
+ *
+ *  Empty slot has NULL client.
+ */
+typedef struct ClientIndexSlot
+{
+    uint32_t key;
+    Client *client;
+} ClientIndexSlot;
+
+/*  B+tree key
+ *
+ *  Keys are sorted by major, and by minor if major is same.
+ */
+typedef struct TreeKey
+{
+    uint64_t major;
+    uint64_t minor;
+} TreeKey;
+
+/*  B+tree node
+ *
+ *  Internal node has count keys and count + 1 children in pointers.
+ *  keys[i] is the smallest key of pointers[i + 1] when it was split.
+ *  Leaf node has count keys and values in pointers, leaves are linked in key order.
+ */
+typedef struct TreeNode
+{
+    _Bool is_leaf;
+    int count;
+    TreeKey keys[SIZE_TREE_NODE];
+    void *pointers[SIZE_TREE_NODE + 1];
+    struct TreeNode *prev;
+    struct TreeNode *next;
+} TreeNode;
+
+/*  B+tree
+ *
+ *  Key is removed from it's leaf only, nodes aren't merged.
+ *  Empty leaf is skipped while iterating.
+ */
+typedef struct Tree
+{
+    TreeNode *root;
+    size_t count;
+} Tree;
+
+/*  Position in B+tree leaves
+ */
+typedef struct TreeCursor
+{
+    const TreeNode *node;
+    int position;
+} TreeCursor;
+
+/*  Hash index of clients by student number
+ *
+ *  Open addressing with linear probing, capacity is power of 2.
+ *  Removed slot is filled by shifting next slots, so there is no tombstone.
+ *
+ *  name_tree has clients by choseong key of name and client key.
+ *  number_tree has clients by student number, saved files are in this order.
+ */
+typedef struct ClientIndex
+{
+    ClientIndexSlot *slots;
+    size_t count;
+    size_t capacity;
+    Tree name_tree;
+    Tree number_tree;
+} ClientIndex;
+
+/*  Index of borrows
+ *
+ *  All borrows are active loans, returned borrow is removed.
+ *  student_tree has borrows by student number, and by loan date(descending) and book number.
+ *  book_tree has borrows by book number and student number.
+ *  due_tree has borrows by return date, student number and book number.
+ */
+typedef struct BorrowIndex
+{
+    Tree student_tree;
+    Tree book_tree;
+    Tree due_tree;
+} BorrowIndex;
+
+/*  Books have same term
+ *
+ *  books are sorted by ISBN, and by book number for same ISBN.
+ *  Term isn't copied, it is the field of books[0].
+ */
+typedef struct Postings
+{
+    uint64_t hash;
+    Book **books;
+    size_t count;
+    size_t capacity;
+} Postings;
+
+/*  Hash multimap from book's string field to postings
+ *
+ *  Open addressing with linear probing, empty slot has NULL books.
+ *  field_offset is the offset of the string field(name, author, publisher) in Book.
+ */
+typedef struct PostingIndex
+{
+    Postings *slots;
+    size_t count;
+    size_t capacity;
+    size_t field_offset;
+} PostingIndex;
+
+/*  Book numbers have same gram
+ *
+ *  numbers are sorted, empty postings isn't removed.
+ */
+typedef struct GramPostings
+{
+    uint64_t gram;
+    uint32_t *numbers;
+    uint32_t count;
+    uint32_t capacity;
+} GramPostings;
+
+/*  Inverted index from gram to book numbers
+ *
+ *  Grams of book's name, author and publisher are indexed.
+ *  Open addressing with linear probing, empty slot has NULL numbers.
+ *  While is_building is true, numbers are appended and sorted at once by finish_gram_index.
+ */
+typedef struct GramIndex
+{
+    GramPostings *slots;
+    size_t count;
+    size_t capacity;
+    _Bool is_building;
+} GramIndex;
+
+/*  Title in title trie
+ *
+ *  book_count is the number of books have the title.
+ *  loan_count is the sum of loan counts of the books.
+ */
+typedef struct TitleEntry
+{
+    wchar_t *title;
+    uint32_t book_count;
+    uint64_t loan_count;
+} TitleEntry;
+
+/*  Node of compressed title trie
+ *
+ *  label is the part of title from parent node, root has empty label.
+ *  children are sorted by first character of label.
+ *  entry isn't NULL if a title ends at this node.
+ *  top has most borrowed titles of this node and it's children.
+ */
+typedef struct TitleNode
+{
+    wchar_t *label;
+    size_t label_length;
+    struct TitleNode **children;
+    size_t child_count;
+    TitleEntry *entry;
+    TitleEntry *top[SIZE_SUGGESTION];
+    size_t top_count;
+} TitleNode;
+
+/*  Compressed trie of book titles
+ *
+ *  count is the number of titles.
+ */
+typedef struct TitleTrie
+{
+    TitleNode *root;
+    size_t count;
+} TitleTrie;
+
+/*  Bit vectors of fuzzy search query
+ *
+ *  Bit i of masks is set if i-th character of query is the character.
+ *  Empty slot has 0 character, open addressing with linear probing.
+ */
+typedef struct FuzzyPatternSlot
+{
+    wchar_t character;
+    uint64_t masks[FUZZY_WORD_COUNT];
+} FuzzyPatternSlot;
+
+typedef struct FuzzyPattern
+{
+    FuzzyPatternSlot slots[SIZE_FUZZY_TABLE];
+    size_t length;
+    size_t word_count;
+} FuzzyPattern;
+
+/*  Condition of book query
+ *
+ *  estimate is the number of books from condition's index, it is set by plan_query.
+ *  symbol is interned author or publisher of value set by plan_query, books are compared by address.
+ *  low and high are ISBN range of QUERY_ISBN, and choseong key and mask of QUERY_CHOSEONG.
+ */
+typedef struct QueryCondition
+{
+    int field;
+    wchar_t value[SIZE_INPUT_MAX];
+    const char *symbol;
+    size_t estimate;
+    uint64_t low;
+    uint64_t high;
+} QueryCondition;
+
+/*  Conjunction of conditions
+ *
+ *  driver is the condition whose index gives candidates, others filter them.
+ */
+typedef struct QueryTerm
+{
+    QueryCondition conditions[SIZE_QUERY_CONDITION_MAX];
+    size_t count;
+    size_t driver;
+} QueryTerm;
+
+/*  Disjunction of terms
+ *
+ *  is_explain is true if query starts with STRING_QUERY_EXPLAIN.
+ */
+typedef struct Query
+{
+    QueryTerm terms[SIZE_QUERY_TERM_MAX];
+    size_t count;
+    _Bool is_explain;
+} Query;
+
+/*  Page of book columns
+ *
+ *  Slot of page is book number, so the number column isn't saved.
+ *  Hot fields read by scans are copied to dense columns, so scans don't read Book.
+ *  Only count_book_columns loops over the columns, because it doesn't need ISBN order.
+ *  Book cursors(find_books_* and queries returning books) keep ISBN order by their index,
+ *  and columns only filter candidates before Book is read, see match_book_columns.
+ *  Book keeps all fields, cold fields(strings) are read from Book only for matched books.
+ *  Empty slot has NULL book and 0 availability.
+ */
+typedef struct BookPage
+{
+    Book *books[SIZE_BOOK_INDEX_PAGE];
+    uint64_t ISBNs[SIZE_BOOK_INDEX_PAGE];
+    unsigned char availability[SIZE_BOOK_INDEX_PAGE];
+} BookPage;
+
+/*  Index of books by book number
+ *
+ *  Book number is used as address directly.
+ *  Pages of SIZE_BOOK_INDEX_PAGE slots are allocated when they are used,
+ *  so holes in book numbers don't use memory.
+ *  Availability should be changed by set_book_availability to keep columns.
+ *
+ *  next_number is the next book number to allocate.
+ *  It only increases, so removed book's number isn't used again.
+ *
+ *  ISBN_tree has books by ISBN and book number(descending),
+ *  saved files are in this order.
+ *
+ *  name_postings, author_postings and publisher_postings find books has same string.
+ *  keyword_grams finds books has keyword in name, author or publisher.
+ *  choseong_tree has books by choseong key of name, author and publisher.
+ *  Its minor key is book number and field number.
+ *  title_trie suggests titles by prefix.
+ */
+typedef struct BookIndex
+{
+    BookPage **pages;
+    size_t page_count;
+    size_t count;
+    uint32_t next_number;
+    Tree ISBN_tree;
+    PostingIndex name_postings;
+    PostingIndex author_postings;
+    PostingIndex publisher_postings;
+    GramIndex keyword_grams;
+    Tree choseong_tree;
+    TitleTrie title_trie;
+} BookIndex;
+
+/*  Cursor of found books
+ *
+ *  Books are read from the index by next_book_cursor, no list is made.
+ *  Copy of cursor reads same books again.
+ *  value isn't copied, it should live while cursor is used.
+ *
+ *  field, value, low and high are same as QueryCondition.
+ *  If query isn't NULL, books are filtered by it's term_number-th term and books of previous terms are skipped.
+ *  run is the cursor reading same ISBN backward and run_count is the number of books left in it.
+ */
+typedef struct BookCursor
+{
+    int type;
+    const BookIndex *index;
+    int field;
+    const wchar_t *value;
+    uint64_t low;
+    uint64_t high;
+    const Query *query;
+    size_t term_number;
+    Book *const *books;
+    const uint32_t *numbers;
+    size_t count;
+    size_t position;
+    const LinkedList *list;
+    TreeCursor tree;
+    TreeCursor run;
+    size_t run_count;
+} BookCursor;
+
+/*  Cursor of borrows
+ *
+ *  Borrows are read from a tree of borrow index, no list is made.
+ *  Cursor ends before the key whose major is high or larger.
+ */
+typedef struct BorrowCursor
+{
+    TreeCursor tree;
+    uint64_t high;
+} BorrowCursor;
+
+/*  Cursor of loan history
+ *
+ *  Records of file and pending loans are merged by key.
+ *  Cursor ends before the loan whose loan date is high or later.
+ */
+typedef struct LoanHistoryCursor
+{
+    const LoanHistory *history;
+    size_t record;
+    size_t pending;
+    int64_t high;
+} LoanHistoryCursor;
+
 struct Screens;
 
 typedef struct Data
 {
-    LinkedList *clients, *books, *borrows;
+    Table clients, books, borrows;
+    ClientIndex client_index;
+    BookIndex book_index;
+    BorrowIndex borrow_index;
+    LoanHistory history;
+    Snapshot snapshots[SNAPSHOT_MAX];
+    RecordArena arenas[SNAPSHOT_MAX];
+    Journal journal;
     struct Screens *screens;
     Client *login_client;
     _Bool is_running;
@@ -109,1470 +934,7456 @@ typedef struct Screens
     char pre_screen_type;
 } Screens;
 
-/*  @brief Init client list.
+/*  Field view
+ *
+ *  Points to one field inside the reader's buffer, it isn't NUL terminated.
+ *  It is valid until next read_fields call.
+ */
+typedef struct FieldView
+{
+    const char *text;
+    size_t size;
+} FieldView;
+
+/*  Field reader
+ *
+ *  Read file by large block and divide it to fields without copying.
+ */
+typedef struct FieldReader
+{
+    FILE *file;
+    char *buffer;
+    size_t capacity;
+    size_t begin;
+    size_t end;
+    _Bool is_eof;
+} FieldReader;
+
+/*  @brief Init client table.
  *
- *  Get client data for file and allocate client and link the list.
+ *  Get client data for file and allocate client and add to the table.
+ *  A row with invalid student number or phone number or duplicated student number isn't loaded, see reject_fields.
  *
  *  @param file_name The file name to get data.
- *  @return LinkedList* Allocated and sorted linked list.
+ *  @param clients The client table to init.
+ *  @param index The client index to build.
+ *  @param arena The arena to allocate client.
+ *  @param is_read_only 1 not to write rejected rows.
+ *  @return int EOF if rejected rows can't be kept.
  */
-LinkedList *init_clients(const char *file_name);
-/*  @brief Init book list.
+int init_clients(const char *file_name, Table *clients, ClientIndex *index, RecordArena *arena, const _Bool is_read_only);
+/*  @brief Init book table.
  *
- *  Get book data for file and allocate book and link the list.
+ *  Get book data for file and allocate book and add to the table.
+ *  Book is added to book index, it should be initialized by init_books_by_snapshot.
+ *  A row with invalid book number, ISBN or availability or duplicated book number isn't loaded, see reject_fields.
  *
  *  @param file_name The file name to get data.
- *  @return LinkedList* Allocated and sorted linked list.
+ *  @param books The book table to init.
+ *  @param index The book index to build.
+ *  @param arena The arena to allocate book.
+ *  @param is_read_only 1 not to write rejected rows.
+ *  @return int EOF if rejected rows can't be kept.
  */
-LinkedList *init_books(const char *file_name);
-/*  @brief Init borrow list.
+int init_books(const char *file_name, Table *books, BookIndex *index, RecordArena *arena, const _Bool is_read_only);
+/*  @brief Init borrow table.
  *
- *  Get borrow data for file and allocate borrow and link the list.
+ *  Get borrow data for file and allocate borrow and add to the table.
+ *  Borrow is added to borrow index.
+ *  A row with invalid student number, book number or date or already borrowed book isn't loaded, see reject_fields.
  *
  *  @param file_name The file name to get data.
- *  @return LinkedList* Allocated and sorted linked list.
+ *  @param borrows The borrow table to init.
+ *  @param index The borrow index to build.
+ *  @param arena The arena to allocate borrow.
+ *  @param is_read_only 1 not to write rejected rows.
+ *  @return int EOF if rejected rows can't be kept.
+ */
+int init_borrows(const char *file_name, Table *borrows, BorrowIndex *index, RecordArena *arena, const _Bool is_read_only);
+
+/*  @brief Init client table by snapshot.
+ *
+ *  Map snapshot file and allocate client and add to the table.
+ *  Client's strings are pointing to the mapped file.
+ *  If snapshot can't be loaded or has a broken segment or string, snapshot's address is NULL
+ *  and the table and the index are left empty.
+ *  Client index is built after the first segment, later segments update it.
+ *
+ *  @param file_name The snapshot file name.
+ *  @param snapshot The snapshot to save mapped memory.
+ *  @param clients The client table to init.
+ *  @param index The client index to build.
+ *  @param arena The arena to allocate client.
+ *  @return void.
+ */
+void init_clients_by_snapshot(const char *file_name, Snapshot *snapshot, Table *clients, ClientIndex *index, RecordArena *arena);
+/*  @brief Init book table by snapshot.
+ *
+ *  Map snapshot file and allocate book and add to the table.
+ *  Book's strings are pointing to the mapped file.
+ *  If snapshot can't be loaded or has a broken segment or string, snapshot's address is NULL
+ *  and the table and the index are left empty.
+ *  The index keeps next_key of a broken snapshot, so removed books' numbers aren't used again.
+ *
+ *  Book is added to book index.
+ *
+ *  @param file_name The snapshot file name.
+ *  @param snapshot The snapshot to save mapped memory.
+ *  @param books The book table to init.
+ *  @param index The book index to build.
+ *  @param arena The arena to allocate book.
+ *  @return void.
+ */
+void init_books_by_snapshot(const char *file_name, Snapshot *snapshot, Table *books, BookIndex *index, RecordArena *arena);
+/*  @brief Init borrow table by snapshot.
+ *
+ *  Map snapshot file and allocate borrow and add to the table.
+ *  Borrow's strings are pointing to the mapped file.
+ *  If snapshot can't be loaded or has a broken segment or string, snapshot's address is NULL
+ *  and the table and the index are left empty.
+ *
+ *  Borrow is added to borrow index.
+ *
+ *  @param file_name The snapshot file name.
+ *  @param snapshot The snapshot to save mapped memory.
+ *  @param borrows The borrow table to init.
+ *  @param index The borrow index to build.
+ *  @param arena The arena to allocate borrow.
+ *  @return void.
  */
-LinkedList *init_borrows(const char *file_name);
+void init_borrows_by_snapshot(const char *file_name, Snapshot *snapshot, Table *borrows, BorrowIndex *index, RecordArena *arena);
 
 /*  @brief Create book.
  *
  *  Create book by ISBN, publisher, author, location and name.
  *  Book's number and availability are specified in this function.
+ *  Book number is the next number of index, it is used when book is inserted.
+ *  If the next number is bigger than BOOK_NUMBER_MAX, book isn't created.
  *
- *  @param book_list The book list to fine book numbet to use.
+ *  @param arena The arena to allocate book.
+ *  @param index The book index to get book number.
  *  @param name The book's name.
  *  @param publisher The book's publisher.
  *  @param author The book's author.
  *  @param ISBN The book's ISBN.
  *  @param location The book's location.
- *  @return Book* new Book made by datas.
+ *  @return Book* new Book made by datas, NULL if book numbers are used up.
  */
-Book *create_book(const LinkedList *book_list, const wchar_t *name, const wchar_t *publisher, const wchar_t *author, const wchar_t *ISBN, const wchar_t *location);
+Book *create_book(RecordArena *arena, const BookIndex *index, const wchar_t *name, const wchar_t *publisher, const wchar_t *author, const uint64_t ISBN, const wchar_t *location);
 /*  @brief Create borrow.
  *
  *  Create borrow by client and book.
  *
+ *  @param arena The arena to allocate borrow.
  *  @param client The client to borrow.
  *  @param book The book to borrow.
  *  @return Borrow* new borrow made by client and book.
  */
-Borrow *create_borrow(Client *client, Book *book);
+Borrow *create_borrow(RecordArena *arena, Client *client, Book *book);
 
-/*  @brief Print client.
+/*  @brief Create client.
  *
- *  Print client data.
+ *  Create client by all datas.
  *
- *  @param client Client pointer to print.
+ *  @param arena The arena to allocate client.
+ *  @param student_number The client's student number.
+ *  @param password The client's password.
+ *  @param name The client's name.
+ *  @param address The client's address.
+ *  @param phone_number The client's phone number.
+ *  @return Client* new Client made by datas.
+ */
+Client *create_client(RecordArena *arena, const uint32_t student_number, const wchar_t *password, const wchar_t *name, const wchar_t *address, const uint64_t phone_number);
+/*  @brief Init table.
+ *
+ *  @param table The table to init.
  *  @return void.
  */
-void print_client(const Client *client);
-/*  @brief Print book.
+void init_table(Table *table);
+/*  @brief Insert record to table.
  *
- *  Print book data.
+ *  Removed slot is used first, chunk is added if all slots are used.
  *
- *  @param book Book pointer to print.
- *  @return void.
+ *  @param table The table.
+ *  @param record The record to insert.
+ *  @return uint32_t Handle of record.
  */
-void print_book(const Book *book);
-/*  @brief Print borrow.
+uint32_t insert_table(Table *table, void *record);
+/*  @brief Get record by handle.
  *
- *  Print borrow data.
+ *  @param table The table.
+ *  @param handle Handle of record.
+ *  @return void* The record, NULL if slot is empty.
+ */
+void *get_table(const Table *table, const uint32_t handle);
+/*  @brief Remove record from table.
  *
- *  @param borrow Borrow pointer to print.
+ *  Slot is emptied and it's handle is given again by insert_table.
+ *
+ *  @param table The table.
+ *  @param handle Handle of record.
  *  @return void.
  */
-void print_borrow(const Borrow *borrow);
-
-/*  @brief Print All clients.
+void remove_table(Table *table, const uint32_t handle);
+/*  @brief Get next record of table.
  *
- *  Print all clients data using linked list.
+ *  Records are read in slot order, empty slots are skipped.
  *
- *  @param client_list Lined list to print.
- *  @return void.
+ *  @param table The table.
+ *  @param position The next slot to read, start from 0.
+ *  @return void* Next record, NULL if table is at the end.
  */
-void print_clients(const LinkedList *client_list);
-/*  @brief Print All books.
+void *next_table(const Table *table, size_t *position);
+/*  @brief Destroy table.
  *
- *  Print all books data using linked list.
+ *  Free all chunks, records aren't freed.
  *
- *  @param book_list Lined list to print.
+ *  @param table The table.
  *  @return void.
  */
-void print_books(const LinkedList *book_list);
-/*  @brief Print All borrows.
- *
- *  Print all borrows data using linked list.
+void destroy_table(Table *table);
+/*  @brief Init record arena.
  *
- *  @param borrow_list Linked list to print.
+ *  @param arena The arena to init.
+ *  @param record_size Size of a record.
  *  @return void.
  */
-void print_borrows(const LinkedList *borrow_list);
-
-/*  @brief Save clients to file.
+void init_record_arena(RecordArena *arena, const size_t record_size);
+/*  @brief Allocate memory in arena's chunks.
  *
- *  Save clients to file.
- *  All clients should be sorted and data in file also should be sorted.
+ *  Memory bigger than quarter of chunk has it's own chunk.
+ *  Size isn't aligned, records are aligned because record_size is aligned.
  *
- *  @param client_list Linked list to save.
- *  @param file_name File name to save.
- *  @return void.
+ *  @param arena The arena.
+ *  @param chunks The chunk list, record_chunks or string_chunks.
+ *  @param size Size to allocate.
+ *  @return void* Allocated memory.
  */
-void save_clients(const LinkedList *client_list, const char *file_name);
-/*  @brief Save books to file.
+void *allocate_arena(RecordArena *arena, ArenaChunk **chunks, size_t size);
+/*  @brief Allocate record.
  *
- *  Save books to file.
- *  All books should be sorted and data in file also should be sorted.
+ *  Removed record is used first.
  *
- *  @param book_list Linked list to save.
- *  @param file_name File name to save.
- *  @return void.
+ *  @param arena The arena.
+ *  @return void* Allocated record.
  */
-void save_books(const LinkedList *book_list, const char *file_name);
-/*  @brief Save borrows to file.
+void *allocate_record(RecordArena *arena);
+/*  @brief Free record.
  *
- *  Save borrows to file.
- *  All borrows should be sorted and data in file also should be sorted.
+ *  Record is linked in free_records, it's strings aren't freed.
  *
- *  @param borrow_list Linked list to save.
- *  @param file_name File name to save.
+ *  @param arena The arena.
+ *  @param record The record to free, it can be NULL.
  *  @return void.
  */
-void save_borrows(const LinkedList *borrow_list, const char *file_name);
-
-/*  @brief Insert client in the linked list.
+void free_record(RecordArena *arena, void *record);
+/*  @brief Create UTF-8 string in arena by wide string.
  *
- *  Fined the current position in linked list.
- *  Create new node and add to the list.
- *  All times list should be sorted.
+ *  @param arena The arena.
+ *  @param string The wide string to convert.
+ *  @return char* Allocated string.
+ */
+char *create_arena_string(RecordArena *arena, const wchar_t *string);
+/*  @brief Create string in arena by UTF-8 string.
  *
- *  @param client_list Linked list.
- *  @param client Client to insert.
- *  @return LinkedList* Linked list's first member.
+ *  @param arena The arena.
+ *  @param text The UTF-8 string to copy.
+ *  @return char* Allocated string.
  */
-LinkedList *insert_client(LinkedList *client_list, Client *client);
-/*  @brief Insert client in the linked list.
+char *create_arena_text(RecordArena *arena, const char *text);
+/*  @brief Create string in arena by field.
  *
- *  Fined the current position in linked list.
- *  Create new node and add to the list.
- *  All times list should be sorted.
+ *  Field of UTF-8 file is copied without converting, LC_CTYPE should be set by set_utf8_locale.
  *
- *  @param client_list Linked list.
- *  @param client Client to insert.
- *  @return LinkedList* Linked list's first member.
+ *  @param arena The arena.
+ *  @param field The field to copy.
+ *  @return char* Allocated string.
  */
-LinkedList *insert_book(LinkedList *book_list, Book *book);
-/*  @brief Insert client in the linked list.
+char *create_arena_string_by_field(RecordArena *arena, const FieldView *field);
+/*  @brief Give back string to arena.
  *
- *  Fined the current position in linked list.
- *  Create new node and add to the list.
- *  All times list should be sorted.
+ *  Only the last string of arena is given back, other string is freed with the arena.
  *
- *  @param client_list Linked list.
- *  @param client Client to insert.
- *  @return LinkedList* Linked list's first member.
+ *  @param arena The arena.
+ *  @param text The string just allocated.
+ *  @return void.
  */
-LinkedList *insert_borrow(LinkedList *borrow_list, Borrow *borrow);
-
-/*  @brief Find client by student number.
+void free_arena_string(RecordArena *arena, char *text);
+/*  @brief Release record arena.
  *
- *  Find client by student number.
+ *  Free all chunks, records and strings of arena are freed at once.
  *
- *  @param client_list The client list to get client.
- *  @param student_number The client's student number.
- *  @return Client* Fined client.
+ *  @param arena The arena to release.
+ *  @return void.
  */
-Client *find_client_by_student_number(const LinkedList *client_list, const wchar_t *student_number);
-/*  @brief Find client by student name.
+void release_record_arena(RecordArena *arena);
+/*  @brief Intern UTF-8 string in arena.
  *
- *  Find client by student name.
+ *  If same string is interned, it is returned.
+ *  Otherwise text is copied to arena if is_copied, or text itself is interned.
  *
- *  @param client_list The client list to get client.
- *  @param student_number The client's student name.
- *  @return Client* Fined client.
+ *  @param arena The arena.
+ *  @param text The string to intern, it can be NULL.
+ *  @param is_copied True to copy text, false if text lives as long as arena.
+ *  @return char* Interned string, NULL if text is NULL.
  */
-Client *find_client_by_name(const LinkedList *client_list, const wchar_t * name);
-/*  @brief Find books by name.
+char *intern_arena_text(RecordArena *arena, const char *text, const _Bool is_copied);
+/*  @brief Intern wide string in arena.
  *
- *  Find book by name.
- *
- *  @param book_list The book list to get book.
- *  @param book_name The book name.
- *  @return LinkedList* Fined Book.
+ *  @param arena The arena.
+ *  @param string The wide string to convert and intern.
+ *  @return char* Interned string.
  */
-LinkedList *find_books_by_name(const LinkedList *book_list, const wchar_t *book_name);
-/*  @brief Find books by author.
+char *intern_arena_string(RecordArena *arena, const wchar_t *string);
+/*  @brief Intern string in arena by field.
  *
- *  Find book by author.
+ *  If same string is interned, copied field is given back.
  *
- *  @param book_list The book list to get book.
- *  @param book_author The book's author.
- *  @return LinkedList* Fined Book list.
+ *  @param arena The arena.
+ *  @param field The field to copy.
+ *  @return char* Interned string.
  */
-LinkedList *find_books_by_author(const LinkedList *book_list, const wchar_t *book_author);
-/*  @brief Find books by publisher.
- *
- *  Find book by publisher.
+char *intern_arena_string_by_field(RecordArena *arena, const FieldView *field);
+/*  @brief Find symbol.
  *
- *  @param book_list The book list to get book.
- *  @param book_publisher The book's publisher.
- *  @return LinkedList* Fined Book list.
+ *  @param table The symbol table.
+ *  @param string The string to find.
+ *  @param hash Hash of string by get_term_hash.
+ *  @return Symbol* Symbol of string, NULL if there isn't.
  */
-LinkedList *find_books_by_publisher(const LinkedList *book_list, const wchar_t *book_publisher);
-/*  @brief Find books by ISBN.
+Symbol *find_symbol(const SymbolTable *table, const char *string, const uint64_t hash);
+/*  @brief Insert symbol.
  *
- *  Find book by ISBN.
+ *  String shouldn't be in table, id is the number of symbols before.
  *
- *  @param book_list The book list to get book.
- *  @param book_ISBN The book's ISBN.
- *  @return LinkedList* Fined Book list.
+ *  @param table The symbol table.
+ *  @param string The string to insert, it isn't copied.
+ *  @param hash Hash of string by get_term_hash.
+ *  @return Symbol* Inserted symbol.
  */
-LinkedList *find_books_by_ISBN(const LinkedList *book_list, const wchar_t *book_ISBN);
-/*  @brief Find books by number.
+Symbol *insert_symbol(SymbolTable *table, const char *string, const uint64_t hash);
+/*  @brief Resize symbol table.
+ *
+ *  @param table The symbol table.
+ *  @param capacity New capacity, it should be power of 2.
+ *  @return void.
+ */
+void resize_symbol_table(SymbolTable *table, const size_t capacity);
+/*  @brief Destroy symbol table.
  *
- *  Find book by number.
+ *  Strings aren't freed.
  *
- *  @param book_list The book list to get book.
- *  @param book_number The book's number.
- *  @return Book* Fined Book list.
+ *  @param table The symbol table.
+ *  @return void.
  */
-Book *find_book_by_number(const LinkedList *book_list, const wchar_t *book_number);
-/*  @brief Find borrow list by client.
+void destroy_symbol_table(SymbolTable *table);
+
+/*  @brief Print client.
  *
- *   Find borrow list by client.
+ *  Print client data.
  *
- *  @param borrow_list The borrow list to get borrow.
- *  @param client The client to get borrow.
- *  @return LinkedList* Fined Borrow list.
+ *  @param client Client pointer to print.
+ *  @return void.
  */
-LinkedList *find_borrows_by_client(const LinkedList *borrow_list, Client *client);
-/*  @brief Find borrow by client and book.
+void print_client(const Client *client);
+/*  @brief Print book.
  *
- *  Find borrow by client and book.
+ *  Print book data.
  *
- *  @param borrow_list The borrow list to get borrow.
- *  @param client The client to get borrow.
- *  @param book The book to get borrow.
- *  @return Borrow* Fined Borrow.
+ *  @param book Book pointer to print.
+ *  @return void.
  */
-Borrow *find_borrow(const LinkedList *borrow_list, Client *client, Book *book);
-
-/*  @brief remove client to client list.
+void print_book(const Book *book);
+/*  @brief Print borrow.
  *
- *  Find client and remove the list.
- *  Free client, unused list memory.
+ *  Print borrow data.
  *
- *  @param client_list The client list to remove client.
- *  @param client The client will be removed.
- *  @return LinkedList * Linked list's first node.
+ *  @param borrow Borrow pointer to print.
+ *  @return void.
  */
-LinkedList *remove_client(LinkedList *client_list, Client *client);
-/*  @brief remove book to book list.
+void print_borrow(const Borrow *borrow);
+
+/*  @brief Print All clients.
  *
- *  Find book and remove the list.
- *  Free book, unused list memory.
+ *  Print all clients data by student number order.
  *
- *  @param book_list The book list to remove book.
- *  @param book The book will be removed.
- *  @return LinkedList * Linked list's first node.
+ *  @param index Client index has clients to print.
+ *  @return void.
  */
-LinkedList *remove_book(LinkedList *book_list, Book *book);
-/*  @brief remove borrow to borrow list.
+void print_clients(const ClientIndex *index);
+/*  @brief Print All books.
  *
- *  Find borrow and remove the list.
- *  Free borrow, unused list memory.
+ *  Print all books data using book cursor.
  *
- *  @param borrow_list The borrow list to remove borrow.
- *  @param borrow The borrow will be removed.
-  *  @return LinkedList * Linked list's first node.
+ *  @param cursor Cursor to print, it is moved to the end.
+ *  @return void.
  */
-LinkedList *remove_borrow(LinkedList *borrow_list, Borrow *borrow);
-
-/*  @brief Free memory for list.
+void print_books(BookCursor *cursor);
+/*  @brief Print All borrows.
  *
- *  Free momory for list but, It isn't free list's member.
+ *  Print all borrows data using borrow cursor.
  *
- *  @param list Linked list to free memory.
+ *  @param cursor Cursor to print, it is moved to the end.
  *  @return void.
  */
-void destroy_list(LinkedList *list);
+void print_borrows(BorrowCursor *cursor);
 
-/*  @brief Destroy client list.
+/*  @brief Save clients to file.
  *
- *  Save client data to file.
- *  Free memory to list.
- *  Data in the file is sorted.
+ *  Save clients to file.
+ *  All clients should be sorted and data in file also should be sorted.
  *
- *  @param client_list Linked list, it have client data.
- *  @param file_name Saving file name.
+ *  @param index Client index has clients to save.
+ *  @param file_name File name to save.
  *  @return void.
  */
-void destroy_clients(LinkedList *client_list, const char *file_name);
-/*  @brief Destroy book list.
+void save_clients(const ClientIndex *index, const char *file_name);
+/*  @brief Save books to file.
  *
- *  Save book data to file.
- *  Free memory to list.
- *  Data in the file is sorted.
+ *  Save books to file.
+ *  All books should be sorted and data in file also should be sorted.
  *
- *  @param book_list Linked list, it have book data.
- *  @param file_name Saving file name.
+ *  @param index Book index has books to save.
+ *  @param file_name File name to save.
  *  @return void.
  */
-void destroy_books(LinkedList *book_list, const char *file_name);
-/*  @brief Destroy borrow list.
+void save_books(const BookIndex *index, const char *file_name);
+/*  @brief Save borrows to file.
  *
- *  Save borrow data to file.
- *  Free memory to list.
- *  Data in the file is sorted.
+ *  Save borrows to file.
+ *  Borrows are saved in table order.
  *
- *  @param borrow_list Linked list, it have borrow data.
- *  @param file_name Saving file name.
+ *  @param borrows Borrow table to save.
+ *  @param file_name File name to save.
  *  @return void.
  */
-void destroy_borrows(LinkedList *borrow_list, const char *file_name);
+void save_borrows(const Table *borrows, const char *file_name);
 
-/*  @brief Destroy client.
+/*  @brief Save clients to snapshot file.
  *
- *  Free client's member
- *  Free client
+ *  Write all clients as one segment to temporary file and rename it to file name.
+ *  Mapped old snapshot is still valid after saving.
  *
- *  @param client Client to free.
+ *  @param index Client index has clients to save.
+ *  @param file_name Snapshot file name to save.
  *  @return void.
  */
-void destroy_client(Client *client);
-/*  @brief Destroy book.
+void save_clients_snapshot(const ClientIndex *index, const char *file_name);
+/*  @brief Save books to snapshot file.
  *
- *  Free book's member
- *  Free book
+ *  Write all books as one segment to temporary file and rename it to file name.
+ *  Mapped old snapshot is still valid after saving.
  *
- *  @param book Book to free.
+ *  @param index Book index has books and the next book number.
+ *  @param file_name Snapshot file name to save.
  *  @return void.
  */
-void destroy_book(Book *book);
-/*  @brief Destroy borrow.
+void save_books_snapshot(const BookIndex *index, const char *file_name);
+/*  @brief Save borrows to snapshot file.
  *
- *  Free borrow's member
- *  Free borrow
+ *  Write all borrows as one segment to temporary file and rename it to file name.
+ *  Mapped old snapshot is still valid after saving.
  *
- *  @param borrow Borrow to free.
+ *  @param borrows Borrow table to save.
+ *  @param file_name Snapshot file name to save.
  *  @return void.
  */
-void destroy_borrow(Borrow *borrow);
+void save_borrows_snapshot(const Table *borrows, const char *file_name);
 
-/*  @brief Init screens.
+/*  @brief Save changed clients to snapshot file.
  *
- *  Allocate memory for screens.
- *  Set screen's type.
- *  Link screen's function pointer.
- *  Init type to init screen.
+ *  Append inserted clients and clients changed strings as a new segment.
+ *  Patch phone number in place, mark removed clients.
+ *  If snapshot has too many segments or removed records, nothing is written.
  *
- *  @param void.
- *  @return Screens* Initaled screens.
+ *  @param snapshot Snapshot has changed clients.
+ *  @param file_name Snapshot file name to save.
+ *  @return int EOF if snapshot should be saved again by save_clients_snapshot.
  */
-Screens *init_screens(void);
-/*  @brief Change screen.
+int append_clients_snapshot(Snapshot *snapshot, const char *file_name);
+/*  @brief Save changed books to snapshot file.
  *
- *  Change screens's type
+ *  Append inserted books as a new segment.
+ *  Patch availability in place, mark removed books.
+ *  If snapshot has too many segments or removed records, nothing is written.
  *
- *  @param screens The screens to change.
- *  @param type The type to change.
- *  @return void.
+ *  @param snapshot Snapshot has changed books.
+ *  @param next_number The next book number to allocate.
+ *  @param file_name Snapshot file name to save.
+ *  @return int EOF if snapshot should be saved again by save_books_snapshot.
  */
-void change_screen(Screens *screens, char type);
-/*  @brief Clear screen.
+int append_books_snapshot(Snapshot *snapshot, const uint32_t next_number, const char *file_name);
+/*  @brief Save changed borrows to snapshot file.
  *
- *  Clear screen.
+ *  Append inserted borrows as a new segment and mark removed borrows.
+ *  If snapshot has too many segments or removed records, nothing is written.
  *
- *  @param void.
- *  @return void.
+ *  @param snapshot Snapshot has changed borrows.
+ *  @param file_name Snapshot file name to save.
+ *  @return int EOF if snapshot should be saved again by save_borrows_snapshot.
  */
-void clear_screen(void);
-/*  @brief Draw screen.
+int append_borrows_snapshot(Snapshot *snapshot, const char *file_name);
+
+/*  @brief Write clients segment.
  *
- *  Fine current screen by type.
- *  Call draw function linked current screen.
+ *  Write segment has all clients in array at offset.
+ *  Client's snapshot offset is changed, and dirty is cleared.
  *
- *  @param screens screen data.
- *  @param data program's all data.
- *  @return void.
+ *  @param file Snapshot file.
+ *  @param clients Clients to write.
+ *  @param count The number of clients.
+ *  @param offset Segment's offset in file.
+ *  @return uint64_t The end offset of segment.
  */
-void draw_screen(Screens *screens, Data *data);
-/*  @brief Get input data and call current function.
+uint64_t write_clients_segment(FILE *file, Client *const *clients, const size_t count, const uint64_t offset);
+/*  @brief Write books segment.
  *
- *  Fine current screen by type.
- *  Call input function linked current screen.
+ *  Write segment has all books in array at offset.
+ *  Book's snapshot offset is changed, and dirty is cleared.
  *
- *  @param screens screen data.
- *  @param data program's all data.
- *  @return void.
+ *  @param file Snapshot file.
+ *  @param books Books to write.
+ *  @param count The number of books.
+ *  @param offset Segment's offset in file.
+ *  @return uint64_t The end offset of segment.
  */
-void input_screen(Screens *screens, Data *data);
-/*  @brief Destroy screens.
+uint64_t write_books_segment(FILE *file, Book *const *books, const size_t count, const uint64_t offset);
+/*  @brief Write borrows segment.
  *
- *  Free memory to screens.
+ *  Write segment has all borrows in array at offset.
+ *  Borrow's snapshot offset is changed, and dirty is cleared.
  *
- *  @param screens screen data.
- *  @return void.
+ *  @param file Snapshot file.
+ *  @param borrows Borrows to write.
+ *  @param count The number of borrows.
+ *  @param offset Segment's offset in file.
+ *  @return uint64_t The end offset of segment.
  */
-void destroy_screens(Screens *screens);
+uint64_t write_borrows_segment(FILE *file, Borrow *const *borrows, const size_t count, const uint64_t offset);
 
-/*  @brief Draw init screen.
+/*  @brief Map snapshot file.
  *
- *  Draw init screen.
+ *  Map snapshot file to memory and check the header.
+ *  If file isn't valid, snapshot should be rewritten.
  *
- *  @param data program's all data.
- *  @return void.
+ *  @param file_name The snapshot file name.
+ *  @param type Snapshot type(SNAPSHOT_CLIENT, SNAPSHOT_BOOK, SNAPSHOT_BORROW).
+ *  @param record_size The size of record.
+ *  @param snapshot The snapshot to save mapped memory.
+ *  @return const SnapshotHeader* Mapped header, NULL if file isn't valid.
  */
-void draw_init_screen(Data *data);
-/*  @brief Process init screen's input data.
+const SnapshotHeader *map_snapshot(const char *file_name, const uint32_t type, const size_t record_size, Snapshot *snapshot);
+/*  @brief Get segment in snapshot.
  *
- *  Process init screen's input data.
+ *  Check segment at offset and move offset to next segment.
  *
- *  @param input input string.
- *  @param data program's all data.
- *  @return void.
+ *  @param header Mapped snapshot header.
+ *  @param offset Segment's offset, it is changed to next segment's offset.
+ *  @param segment The segment to save.
+ *  @return int EOF if segment isn't valid.
  */
-void input_init_screen(const wchar_t *input, Data *data);
-
-/*  @brief Draw sign up screen.
+int get_snapshot_segment(const SnapshotHeader *header, uint64_t *offset, SnapshotSegment *segment);
+/*  @brief Get string in snapshot.
  *
- *  Draw sign up screen.
+ *  Get string in segment's string table by offset.
  *
- *  @param data program's all data.
- *  @return void.
+ *  @param segment Segment in mapped snapshot.
+ *  @param offset The string's offset in string table.
+ *  @return char* String in the mapped snapshot, NULL if offset isn't valid.
  */
-void draw_sign_up_screen(Data *data);
-/*  @brief Process sign up screen's input data.
+char *get_snapshot_string(const SnapshotSegment *segment, const uint64_t offset);
+/*  @brief Unmap snapshot file.
  *
- *  Process sign up screen's input data.
+ *  Unmap snapshot and free changes, all strings pointing to it aren't valid after this.
  *
- *  @param input Input string.
- *  @param data Program's all data.
+ *  @param snapshot The snapshot to unmap.
  *  @return void.
  */
-void input_sign_up_screen(const wchar_t *input, Data *data);
-
-/*  @brief Draw sign in screen.
+void unmap_snapshot(Snapshot *snapshot);
+/*  @brief Open snapshot file to write.
  *
- *  Draw sign in screen.
+ *  Open temporary file and skip the header.
  *
- *  @param data program's all data.
- *  @return void.
+ *  @param file_name Snapshot file name.
+ *  @param header The header to init.
+ *  @param type Snapshot type.
+ *  @param record_size The size of record.
+ *  @return FILE* Opened temporary file.
  */
-void draw_sign_in_screen(Data *data);
-/*  @brief Process sign in screen's input data.
+FILE *open_snapshot_file(const char *file_name, SnapshotHeader *header, const uint32_t type, const size_t record_size);
+/*  @brief Open snapshot file to append.
  *
- *  Process sign in screen's input data.
+ *  Open snapshot file and read the header.
  *
- *  @param input Input string.
- *  @param data Program's all data.
- *  @return void.
+ *  @param file_name Snapshot file name.
+ *  @param header The header to read.
+ *  @param type Snapshot type.
+ *  @param record_size The size of record.
+ *  @return FILE* Opened file, NULL if file isn't valid.
  */
-void input_sign_in_screen(const wchar_t *input, Data *data);
-
-/*  @brief Draw menu member screen.
- *
- *  Draw menu member screen.
+FILE *open_snapshot_to_append(const char *file_name, SnapshotHeader *header, const uint32_t type, const size_t record_size);
+/*  @brief Get version of snapshot type.
  *
- *  @param data program's all data.
- *  @return void.
+ *  @param type Snapshot type.
+ *  @return uint32_t HISTORY_VERSION for loan history, SNAPSHOT_VERSION for others.
  */
-void draw_menu_member_screen(Data *data);
-/*  @brief Process menu member screen's input data.
+uint32_t get_snapshot_version(const uint32_t type);
+/*  @brief Check snapshot can be appended.
  *
- *  Process menu member screen's input data.
+ *  If snapshot has too many segments or removed records, it should be saved again.
  *
- *  @param input Input string.
- *  @param data Program's all data.
+ *  @param header The snapshot file's header.
+ *  @param snapshot The snapshot has removed records.
+ *  @param append_count The number of records to append.
+ *  @return _Bool true if records can be appended.
+ */
+_Bool can_append_snapshot(const SnapshotHeader *header, const Snapshot *snapshot, const uint64_t append_count);
+/*  @brief Write field to snapshot file.
+ *
+ *  @param file Snapshot file.
+ *  @param offset Field's offset in file.
+ *  @param field Field's data.
+ *  @param size Field's size.
  *  @return void.
  */
-void input_menu_member_screen(const wchar_t *input, Data *data);
-
-/*  @brief Draw menu admin screen.
+void write_snapshot_field(FILE *file, const uint64_t offset, const void *field, const size_t size);
+/*  @brief Write removed records to snapshot file.
  *
- *  Draw menu admin screen.
+ *  Set is_removed of all removed records and write header.
  *
- *  @param data program's all data.
- *  @return void.
+ *  @param file Snapshot file.
+ *  @param snapshot The snapshot has removed records.
+ *  @param header The header to write.
+ *  @param field_offset is_removed's offset in record.
+ *  @return int EOF if file can't be written.
  */
-void draw_menu_admin_screen(Data *data);
-/*  @brief Process menu admin screen's input data.
+int write_snapshot_removed(FILE *file, const Snapshot *snapshot, SnapshotHeader *header, const size_t field_offset);
+/*  @brief Sync snapshot file.
  *
- *  Process menu admin screen's input data.
+ *  Sync written data, and write header and sync again.
+ *  Header is written after data, so broken data isn't referenced.
  *
- *  @param input Input string.
- *  @param data Program's all data.
- *  @return void.
+ *  @param file Snapshot file.
+ *  @param header The header to write.
+ *  @return int EOF if file can't be written.
  */
-void input_menu_admin_screen(const wchar_t *input, Data *data);
-
-/*  @brief Draw regist book screen.
+int sync_snapshot_file(FILE *file, const SnapshotHeader *header);
+/*  @brief Write string to snapshot file.
  *
- *  Draw regist book screen.
+ *  Write string in string table.
  *
- *  @param data program's all data.
+ *  @param file Snapshot file.
+ *  @param string The string to write.
  *  @return void.
  */
-void draw_regist_book_screen(Data *data);
-/*  @brief Process regist book screen's input data.
+void write_snapshot_string(FILE *file, const char *string);
+/*  @brief Close snapshot file.
  *
- *  Process regist book screen's input data.
+ *  Write header and rename temporary file to snapshot file name.
  *
- *  @param input Input string.
- *  @param data Program's all data.
+ *  @param file Snapshot file.
+ *  @param file_name Snapshot file name.
+ *  @param header The header to write.
  *  @return void.
  */
-void input_regist_book_screen(const wchar_t *input, Data *data);
-
-/*  @brief Draw remove book screen.
+void close_snapshot_file(FILE *file, const char *file_name, SnapshotHeader *header);
+/*  @brief Get string size in snapshot.
  *
- *  Draw remove book screen.
+ *  Get string size include NUL.
  *
- *  @param data program's all data.
- *  @return void.
+ *  @param string The string.
+ *  @return uint64_t The size of string in snapshot.
  */
-void draw_remove_book_screen(Data *data);
-/*  @brief Process remove book screen's input data.
+uint64_t get_snapshot_string_size(const char *string);
+/*  @brief Put string to string table of snapshot segment once.
  *
- *  Process remove book screen's input data.
+ *  First string gets string_offset and string_offset is moved,
+ *  same string after it gets the first offset.
+ *  Call with same strings in same order to get same offsets again.
  *
- *  @param input Input string.
- *  @param data Program's all data.
- *  @return void.
+ *  @param symbols Strings of segment and their offsets.
+ *  @param string The string.
+ *  @param string_offset Offset of next new string.
+ *  @return uint64_t Offset of string.
  */
-void input_remove_book_screen(const wchar_t *input, Data *data);
+uint64_t put_snapshot_symbol(SymbolTable *symbols, const char *string, uint64_t *string_offset);
 
-/*  @brief Draw borrow book screen.
+/*  @brief Mark record dirty.
  *
- *  Draw borrow book screen.
+ *  Add record to snapshot's dirty list and set dirty flags.
  *
- *  @param data program's all data.
+ *  @param snapshot The snapshot has record.
+ *  @param record The changed record.
+ *  @param dirty Record's dirty member.
+ *  @param flags DIRTY_* flags to set.
  *  @return void.
  */
-void draw_borrow_book_screen(Data *data);
-/*  @brief Process borrow book screen's input data.
+void mark_dirty(Snapshot *snapshot, void *record, unsigned char *dirty, const unsigned char flags);
+/*  @brief Mark record removed.
  *
- *  Process borrow book screen's input data.
+ *  Remove record from snapshot's dirty list and save it's offset.
+ *  It should be called before record is removed.
  *
- *  @param input Input string.
- *  @param data Program's all data.
+ *  @param snapshot The snapshot has record.
+ *  @param record The record will be removed.
+ *  @param snapshot_offset Record's offset in snapshot file.
+ *  @param dirty Record's dirty flags.
  *  @return void.
  */
-void input_borrow_book_screen(const wchar_t *input, Data *data);
-
-/*  @brief Draw return book screen.
+void mark_removed(Snapshot *snapshot, void *record, const uint64_t snapshot_offset, const unsigned char dirty);
+/*  @brief Clear snapshot changes.
  *
- *  Draw return book screen.
+ *  Clear dirty list and removed records after saving snapshot.
  *
- *  @param data program's all data.
+ *  @param snapshot The snapshot to clear.
  *  @return void.
  */
-void draw_return_book_screen(Data *data);
-/*  @brief Process return book screen's input data.
+void clear_snapshot_changes(Snapshot *snapshot);
+
+/*  @brief Insert client in the table.
  *
- *  Process return book screen's input data.
+ *  Client's handle is set, and client is added to the index too.
  *
- *  @param input Input string.
- *  @param data Program's all data.
+ *  @param clients Client table.
+ *  @param index Client index.
+ *  @param client Client to insert.
  *  @return void.
  */
-void input_return_book_screen(const wchar_t *input, Data *data);
-
-/*  @brief Draw find book screen.
+void insert_client(Table *clients, ClientIndex *index, Client *client);
+/*  @brief Insert book in the table.
  *
- *  Draw find book screen.
+ *  Book's handle is set, and book is added to the index too.
  *
- *  @param data program's all data.
+ *  @param books Book table.
+ *  @param index Book index.
+ *  @param book Book to insert.
  *  @return void.
  */
-void draw_find_book_screen(Data *data);
-/*  @brief Process find book screen's input data.
+void insert_book(Table *books, BookIndex *index, Book *book);
+/*  @brief Insert borrow in the table.
  *
- *  Process find book screen's input data.
+ *  Borrow's handle is set, and borrow is added to the index too.
  *
- *  @param input Input string.
- *  @param data Program's all data.
+ *  @param borrows Borrow table.
+ *  @param index Borrow index.
+ *  @param borrow Borrow to insert.
  *  @return void.
  */
-void input_find_book_screen(const wchar_t *input, Data *data);
+void insert_borrow(Table *borrows, BorrowIndex *index, Borrow *borrow);
 
-/*  @brief Draw modify client screen.
+/*  @brief Find client by student number.
  *
- *  Draw modify client screen.
+ *  Find client by student number in client index.
  *
- *  @param data program's all data.
- *  @return void.
+ *  @param index The client index to get client.
+ *  @param student_number The client's student number.
+ *  @return Client* Fined client.
  */
-void draw_modify_client_screen(Data *data);
-/*  @brief Process modify client screen's input data.
+Client *find_client_by_student_number(const ClientIndex *index, const uint32_t student_number);
+/*  @brief Get student number.
  *
- *  Process modify client screen's input data.
+ *  Convert 8 digits student number string to number, admin is STUDENT_NUMBER_ADMIN.
  *
- *  @param input Input string.
- *  @param data Program's all data.
- *  @return void.
+ *  @param string Student number string.
+ *  @return uint32_t Student number, STUDENT_NUMBER_NONE if string isn't valid.
  */
-void input_modify_client_screen(const wchar_t *input, Data *data);
-
-/*  @brief Read string by token.
+uint32_t get_student_number(const wchar_t *string);
+/*  @brief Format student number.
  *
- *  Read string by token.
+ *  @param student_number The student number.
+ *  @param string The string to save, it's size should be bigger than SIZE_STUDENT_NUMBER.
+ */
+void format_student_number(const uint32_t student_number, wchar_t *string);
+/*  @brief Get phone number.
  *
- *  @param file The file to get string.
- *  @param token Token to divide string.
- *  @param string String data.
- *  @return int.
+ *  Convert phone number string to number, hyphens are ignored.
+ *
+ *  @param string Phone number string.
+ *  @return uint64_t Phone number, PHONE_NUMBER_NONE if string is empty or isn't valid.
  */
-int read_string_by_token(FILE *file, const wchar_t *token, const size_t len, wchar_t *string);
-
-/*   @prog Library manager
+uint64_t get_phone_number(const wchar_t *string);
+/*  @brief Format phone number.
  *
- *   Library manager program for programming team project
- *  1. Init datas.
- *  2. Clear screen.
- *  3. Draw screen.
- *  4. Get input string and processing.
- *  5. If program is running, go to step 2.
- *  6. Save all data and free the memory.
- *  7. End the program.
+ *  @param phone_number The phone number.
+ *  @param string The string to save, it's size should be bigger than SIZE_PHONE_NUMBER.
+ */
+void format_phone_number(const uint64_t phone_number, wchar_t *string);
+/*  @brief Get home slot of key.
  *
- *   @author Park Si-Yual.
- *  @recent 2018-11-03.
+ *  @param index The client index.
+ *  @param key Client key.
+ *  @return size_t Slot position for key.
+ */
+size_t get_client_slot(const ClientIndex *index, const uint32_t key);
+/*  @brief Build client index.
+ *
+ *  Allocate index for all clients in table and add them.
+ *
+ *  @param index The client index to build.
+ *  @param clients Clients to add.
+ *  @return void.
+ */
+void build_client_index(ClientIndex *index, const Table *clients);
+/*  @brief Add client to client index.
+ *
+ *  If index has same student number, the client is replaced.
+ *
+ *  @param index The client index.
+ *  @param client The client to add.
+ *  @return void.
+ */
+void insert_client_index(ClientIndex *index, Client *client);
+/*  @brief Remove client from client index.
+ *
+ *  Shift next slots in probe sequence to the removed slot.
+ *
+ *  @param index The client index.
+ *  @param client The client to remove.
+ *  @return void.
+ */
+void remove_client_index(ClientIndex *index, const Client *client);
+/*  @brief Resize client index.
+ *
+ *  @param index The client index.
+ *  @param capacity New capacity, it should be power of 2.
+ *  @return void.
+ */
+void resize_client_index(ClientIndex *index, const size_t capacity);
+/*  @brief Destroy client index.
+ *
+ *  Free slots, clients aren't freed.
+ *
+ *  @param index The client index.
+ *  @return void.
+ */
+void destroy_client_index(ClientIndex *index);
+
+/*  @brief Find client by student name.
+ *
+ *  Find client by student name.
+ *  If clients have same name, client has the smallest student number is fined.
+ *
+ *  @param clients The client table to get client.
+ *  @param student_number The client's student name.
+ *  @return Client* Fined client.
+ */
+Client *find_client_by_name(const Table *clients, const wchar_t * name);
+/*  @brief Find clients by choseong.
+ *
+ *  Find clients which name starts with choseong of prefix.
+ *  Hangul syllable in prefix is same as it's choseong.
+ *
+ *  @param index The client index to get client.
+ *  @param prefix Choseong to find like ㅎㄱㄷ.
+ *  @return LinkedList* Fined client list sorted by choseong.
+ */
+LinkedList *find_clients_by_choseong(const ClientIndex *index, const wchar_t *prefix);
+/*  @brief Get client key of name tree.
+ *
+ *  @param client The client.
+ *  @return TreeKey Choseong key of name and client key.
+ */
+TreeKey get_client_name_key(const Client *client);
+/*  @brief Find books by name.
+ *
+ *  Find book by name in name postings.
+ *
+ *  @param index The book index to get book.
+ *  @param book_name The book name.
+ *  @param cursor Cursor of fined books sorted by ISBN.
+ *  @return void.
+ */
+void find_books_by_name(const BookIndex *index, const wchar_t *book_name, BookCursor *cursor);
+/*  @brief Find books by similar name.
+ *
+ *  Find books which name is in max_distance edits from book_name.
+ *  One edit changes at most GRAM_OTHER_SIZE grams, so books which have few grams of book_name are skipped.
+ *  Book which has enough grams is in one of the shortest gram postings at least,
+ *  so candidates are merged from them and counted in others by seek_numbers.
+ *  If book_name is too short to skip by grams, names of other length are skipped.
+ *  Edit distance is computed by bit-parallel algorithm.
+ *  Case of latin letter is ignored.
+ *
+ *  @param index The book index to get book.
+ *  @param book_name The book's name, it should be shorter than SIZE_INPUT_MAX.
+ *  @param max_distance Allowed edit distance.
+ *  @return LinkedList* Fined Book list sorted by edit distance, and by ISBN.
+ */
+LinkedList *find_books_by_similar_name(const BookIndex *index, const wchar_t *book_name, const size_t max_distance);
+/*  @brief Get allowed edit distance of query.
+ *
+ *  @param book_name The query.
+ *  @return size_t Allowed edit distance.
+ */
+size_t get_fuzzy_distance(const wchar_t *book_name);
+/*  @brief Find books by author.
+ *
+ *  Find book by author in author postings.
+ *
+ *  @param index The book index to get book.
+ *  @param book_author The book's author.
+ *  @param cursor Cursor of fined books sorted by ISBN.
+ *  @return void.
+ */
+void find_books_by_author(const BookIndex *index, const wchar_t *book_author, BookCursor *cursor);
+/*  @brief Find books by publisher.
+ *
+ *  Find book by publisher in publisher postings.
+ *
+ *  @param index The book index to get book.
+ *  @param book_publisher The book's publisher.
+ *  @param cursor Cursor of fined books sorted by ISBN.
+ *  @return void.
+ */
+void find_books_by_publisher(const BookIndex *index, const wchar_t *book_publisher, BookCursor *cursor);
+/*  @brief Find books by ISBN.
+ *
+ *  Find book by ISBN in ISBN tree.
+ *
+ *  @param index The book index to get book.
+ *  @param book_ISBN The book's ISBN.
+ *  @param cursor Cursor of fined books sorted by book number.
+ *  @return void.
+ */
+void find_books_by_ISBN(const BookIndex *index, const wchar_t *book_ISBN, BookCursor *cursor);
+/*  @brief Find books by ISBN prefix.
+ *
+ *  Find books which ISBN starts with prefix, '-' in prefix is ignored.
+ *  If prefix isn't digits, find books has same ISBN.
+ *
+ *  @param index The book index to get book.
+ *  @param prefix ISBN prefix like 978-89-.
+ *  @param cursor Cursor of fined books sorted by ISBN.
+ *  @return void.
+ */
+void find_books_by_ISBN_prefix(const BookIndex *index, const wchar_t *prefix, BookCursor *cursor);
+/*  @brief Find books by keyword.
+ *
+ *  Find books which name, author or publisher has keyword.
+ *  Books of the shortest posting list of keyword's grams are checked.
+ *  If keyword is too short to have gram, all books are checked.
+ *
+ *  @param index The book index to get book.
+ *  @param keyword Keyword to find, case of latin letter is ignored.
+ *  @param cursor Cursor of fined books sorted by book number.
+ *  @return void.
+ */
+void find_books_by_keyword(const BookIndex *index, const wchar_t *keyword, BookCursor *cursor);
+/*  @brief Find books by choseong.
+ *
+ *  Find books which name, author or publisher starts with choseong of prefix.
+ *  Hangul syllable in prefix is same as it's choseong.
+ *
+ *  @param index The book index to get book.
+ *  @param prefix Choseong to find like ㅎㄹㄱㅎ.
+ *  @param cursor Cursor of fined books sorted by choseong.
+ *  @return void.
+ */
+void find_books_by_choseong(const BookIndex *index, const wchar_t *prefix, BookCursor *cursor);
+/*  @brief Init book cursor.
+ *
+ *  Cursor reads books from the index of field.
+ *  Field without index or QUERY_FIELD_MAX reads all books, negative field reads nothing.
+ *
+ *  @param index The book index.
+ *  @param field QUERY_* field.
+ *  @param value Value to find.
+ *  @param low Same as QueryCondition.
+ *  @param high Same as QueryCondition.
+ *  @param cursor The cursor to init.
+ *  @return void.
+ */
+void init_book_cursor(const BookIndex *index, const int field, const wchar_t *value, const uint64_t low, const uint64_t high, BookCursor *cursor);
+/*  @brief Init book cursor by book list.
+ *
+ *  @param book_list The book list, it should live while cursor is used.
+ *  @param cursor The cursor to init.
+ *  @return void.
+ */
+void init_book_list_cursor(const LinkedList *book_list, BookCursor *cursor);
+/*  @brief Init book cursor by a term of query.
+ *
+ *  @param index The book index.
+ *  @param query Planned query.
+ *  @param term_number Position of term.
+ *  @param cursor The cursor to init.
+ *  @return void.
+ */
+void init_query_cursor(const BookIndex *index, const Query *query, const size_t term_number, BookCursor *cursor);
+/*  @brief Get next book of cursor.
+ *
+ *  @param cursor The cursor.
+ *  @return Book* Next book, NULL if cursor is at the end.
+ */
+Book *next_book_cursor(BookCursor *cursor);
+/*  @brief Check book is a result of cursor.
+ *
+ *  Candidate from the index is checked if the index can't check it.
+ *
+ *  @param cursor The cursor.
+ *  @param book Candidate book.
+ *  @return _Bool true if book is a result.
+ */
+_Bool match_book_cursor(const BookCursor *cursor, const Book *book);
+/*  @brief Check candidate by columns.
+ *
+ *  Conditions of hot fields are checked by book columns without reading Book.
+ *
+ *  @param cursor The cursor.
+ *  @param number Candidate book number.
+ *  @return int 1 if book is a result, 0 if it isn't, EOF if Book should be checked by match_book_cursor.
+ */
+int match_book_columns(const BookCursor *cursor, const uint32_t number);
+/*  @brief Check query term by columns.
+ *
+ *  @param page The book page.
+ *  @param slot Slot of book in page.
+ *  @param term The query term.
+ *  @return int 1 if book matches, 0 if it doesn't, EOF if term has conditions of cold fields.
+ */
+int match_term_columns(const BookPage *page, const size_t slot, const QueryTerm *term);
+/*  @brief Get book key of choseong tree.
+ *
+ *  @param book The book.
+ *  @param field 0 for name, 1 for author, 2 for publisher.
+ *  @return TreeKey Choseong key of field, book number and field.
+ */
+TreeKey get_book_choseong_key(const Book *book, const int field);
+/*  @brief Suggest titles by prefix.
+ *
+ *  Titles are sorted by loan count, and by title if loan count is same.
+ *
+ *  @param index The book index.
+ *  @param prefix Typed part of title.
+ *  @param suggestions Array of SIZE_SUGGESTION to save titles.
+ *  @return size_t The number of suggested titles.
+ */
+size_t find_title_suggestions(const BookIndex *index, const wchar_t *prefix, const TitleEntry **suggestions);
+
+/*  @brief Parse book query.
+ *
+ *  Condition is "field = value" or "available".
+ *  field is name, author, publisher, isbn(prefix), keyword or choseong.
+ *  AND is evaluated before OR.
+ *
+ *  @param text The query text.
+ *  @param query The parsed query is saved.
+ *  @return int 0 if query is valid, EOF otherwise.
+ */
+int parse_query(const wchar_t *text, Query *query);
+/*  @brief Parse condition of book query.
+ *
+ *  @param text Start of condition.
+ *  @param length The length of condition.
+ *  @param condition The parsed condition is saved.
+ *  @return int 0 if condition is valid, EOF otherwise.
+ */
+int parse_query_condition(const wchar_t *text, size_t length, QueryCondition *condition);
+/*  @brief Plan book query.
+ *
+ *  Estimate every condition and choose the most selective condition of each term as driver.
+ *
+ *  @param index The book index.
+ *  @param query The query to plan.
+ *  @return void.
+ */
+void plan_query(const BookIndex *index, Query *query);
+/*  @brief Estimate the number of books from condition's index.
+ *
+ *  Range of tree is counted until limit.
+ *
+ *  @param index The book index.
+ *  @param condition The condition.
+ *  @param limit Counting stops at limit.
+ *  @return size_t Estimated number of books.
+ */
+size_t estimate_query_condition(const BookIndex *index, const QueryCondition *condition, const size_t limit);
+/*  @brief Check book matches condition.
+ *
+ *  @param book The book.
+ *  @param condition The condition.
+ *  @return _Bool true if book matches.
+ */
+_Bool match_query_condition(const Book *book, const QueryCondition *condition);
+/*  @brief Check book matches all conditions of term.
+ *
+ *  @param book The book.
+ *  @param term The term.
+ *  @return _Bool true if book matches.
+ */
+_Bool match_query_term(const Book *book, const QueryTerm *term);
+/*  @brief Run planned book query.
+ *
+ *  Books are given to visit without making list.
+ *  Books of each term are in order of driver's index, a book is given once.
+ *
+ *  @param index The book index.
+ *  @param query Planned query.
+ *  @param visit Function called with each book and context, it can be NULL.
+ *  @param context Argument for visit.
+ *  @return size_t The number of books.
+ */
+size_t run_query(const BookIndex *index, const Query *query, void (*visit)(const Book *book, void *context), void *context);
+/*  @brief Run a term of book query.
+ *
+ *  Books matching previous terms are skipped.
+ *
+ *  @param index The book index.
+ *  @param query Planned query.
+ *  @param term_number Position of term to run.
+ *  @param visit Function called with each book and context, it can be NULL.
+ *  @param context Argument for visit.
+ *  @return size_t The number of books.
  */
-int main(void)
+size_t run_query_term(const BookIndex *index, const Query *query, const size_t term_number, void (*visit)(const Book *book, void *context), void *context);
+/*  @brief Count books of query term by columns.
+ *
+ *  Book columns are read in book number order without reading Book.
+ *  Conditions of the term and previous terms should be hot fields, see is_column_term.
+ *
+ *  @param index The book index.
+ *  @param query Planned query.
+ *  @param term_number Position of term to count.
+ *  @return size_t The number of books.
+ */
+size_t count_book_columns(const BookIndex *index, const Query *query, const size_t term_number);
+/*  @brief Check query term can be checked by columns.
+ *
+ *  @param term The query term.
+ *  @return _Bool true if term has only ISBN and available conditions.
+ */
+_Bool is_column_term(const QueryTerm *term);
+/*  @brief Print plan of book query.
+ *
+ *  @param query Planned query.
+ *  @return void.
+ */
+void print_query_plan(const Query *query);
+/*  @brief Print book of query result.
+ *
+ *  @param book The book.
+ *  @param context Unused.
+ *  @return void.
+ */
+void print_query_book(const Book *book, void *context);
+/*  @brief Count a loan of book.
+ *
+ *  Increase loan count of book and it's title.
+ *
+ *  @param index The book index.
+ *  @param book The borrowed book.
+ *  @return void.
+ */
+void count_book_loan(BookIndex *index, Book *book);
+/*  @brief Set availability of book.
+ *
+ *  Change availability of book and it's column.
+ *
+ *  @param index The book index.
+ *  @param book The book.
+ *  @param availability L'Y' or L'N'.
+ *  @return void.
+ */
+void set_book_availability(BookIndex *index, Book *book, const wchar_t availability);
+/*  @brief Find books by number.
+ *
+ *  Find book by number in book index.
+ *
+ *  @param index The book index to get book.
+ *  @param book_number The book's number.
+ *  @return Book* Fined Book list.
+ */
+Book *find_book_by_number(const BookIndex *index, const uint32_t book_number);
+/*  @brief Check book is in the cursor.
+ *
+ *  Copy of cursor is read, so cursor isn't moved.
+ *
+ *  @param cursor The book cursor.
+ *  @param book The book to find.
+ *  @return _Bool true if cursor has the book.
+ */
+_Bool has_book(const BookCursor *cursor, const Book *book);
+/*  @brief Get book number.
+ *
+ *  Convert book number string to number.
+ *
+ *  @param string Book number string, it has digits only.
+ *  @return uint32_t Book number, 0 if string isn't valid.
+ */
+uint32_t get_book_number(const wchar_t *string);
+/*  @brief Init book index.
+ *
+ *  Init empty book index, the first book number is 1.
+ *
+ *  @param index The book index to init.
+ *  @return void.
+ */
+void init_book_index(BookIndex *index);
+/*  @brief Finish building book index.
+ *
+ *  Sort grams added while loading.
+ *
+ *  @param index The book index.
+ *  @return void.
+ */
+void finish_book_index(BookIndex *index);
+/*  @brief Add book to book index.
+ *
+ *  Add book by number, by ISBN and to postings.
+ *
+ *  @param index The book index.
+ *  @param book The book to add.
+ *  @return void.
+ */
+void insert_book_index(BookIndex *index, Book *book);
+/*  @brief Remove book from book index.
+ *
+ *  @param index The book index.
+ *  @param book The book to remove.
+ *  @return void.
+ */
+void remove_book_index(BookIndex *index, const Book *book);
+/*  @brief Destroy book index.
+ *
+ *  Free pages, books aren't freed.
+ *
+ *  @param index The book index.
+ *  @return void.
+ */
+void destroy_book_index(BookIndex *index);
+/*  @brief Allocate book numbers.
+ *
+ *  Allocate contiguous book numbers for registering many books.
+ *  Numbers aren't used again even if books aren't inserted,
+ *  so the new next number should be written by journal_reserve_book_numbers.
+ *
+ *  @param index The book index.
+ *  @param count The number of book numbers.
+ *  @return uint32_t The first allocated book number, 0 if range is over BOOK_NUMBER_MAX.
+ */
+uint32_t allocate_book_numbers(BookIndex *index, const uint32_t count);
+/*  @brief Get ISBN key.
+ *
+ *  Hyphens are skipped like get_ISBN_range.
+ *
+ *  @param ISBN The ISBN.
+ *  @return uint64_t ISBN as number, ISBN_KEY_OTHER if it isn't 13 digits.
+ */
+uint64_t get_ISBN_key(const wchar_t *ISBN);
+/*  @brief Format ISBN key.
+ *
+ *  @param ISBN The ISBN key.
+ *  @param string The string to save, it's size should be bigger than SIZE_ISBN.
+ */
+void format_ISBN(const uint64_t ISBN, wchar_t *string);
+/*  @brief Get ISBN key range of prefix.
+ *
+ *  Hyphens in prefix are ignored.
+ *
+ *  @param prefix ISBN prefix like 978-89-.
+ *  @param low The first key of range is saved.
+ *  @param high The key after range is saved.
+ *  @return int 0 if prefix has 1 to 12 digits, EOF otherwise.
+ */
+int get_ISBN_range(const wchar_t *prefix, uint64_t *low, uint64_t *high);
+/*  @brief Get book's key in ISBN tree.
+ *
+ *  @param book The book.
+ *  @return TreeKey Key has ISBN and book number for descending order.
+ */
+TreeKey get_book_key(const Book *book);
+
+/*  @brief Compare B+tree keys.
+ *
+ *  @param a Key to compare.
+ *  @param b Key to compare.
+ *  @return int Negative if a < b, 0 if a == b, positive if a > b.
+ */
+int compare_tree_key(const TreeKey *a, const TreeKey *b);
+/*  @brief Search key in B+tree node.
+ *
+ *  Binary search in node's keys.
+ *
+ *  @param node The node to search.
+ *  @param key The key to find.
+ *  @param is_upper If true, find first key greater than key, else first key not less than key.
+ *  @return int Position in node.
+ */
+int search_tree_node(const TreeNode *node, const TreeKey *key, const _Bool is_upper);
+/*  @brief Find leaf for key.
+ *
+ *  @param tree The B+tree.
+ *  @param key The key to find.
+ *  @return TreeNode* Leaf the key should be in, NULL if tree is empty.
+ */
+TreeNode *find_tree_leaf(const Tree *tree, const TreeKey *key);
+/*  @brief Find value by key.
+ *
+ *  @param tree The B+tree.
+ *  @param key The key to find.
+ *  @return void* Value, NULL if tree doesn't have key.
+ */
+void *find_tree(const Tree *tree, const TreeKey *key);
+/*  @brief Find value before key.
+ *
+ *  @param tree The B+tree.
+ *  @param key The key to find.
+ *  @return void* Value of the largest key less than key, NULL if there isn't.
+ */
+void *find_tree_before(const Tree *tree, const TreeKey *key);
+/*  @brief Insert value to B+tree.
+ *
+ *  If tree has key, value is replaced.
+ *
+ *  @param tree The B+tree.
+ *  @param key The key of value.
+ *  @param value The value to insert.
+ *  @return void.
+ */
+void insert_tree(Tree *tree, const TreeKey *key, void *value);
+/*  @brief Insert value to subtree.
+ *
+ *  @param tree The B+tree.
+ *  @param node Root of subtree.
+ *  @param key The key of value.
+ *  @param value The value to insert.
+ *  @param split_key The smallest key of new node if node is split.
+ *  @return TreeNode* New right node if node is split, else NULL.
+ */
+TreeNode *insert_tree_node(Tree *tree, TreeNode *node, const TreeKey *key, void *value, TreeKey *split_key);
+/*  @brief Split full B+tree node.
+ *
+ *  @param node The node to split.
+ *  @param split_key The key to insert in parent.
+ *  @return TreeNode* New right node.
+ */
+TreeNode *split_tree_node(TreeNode *node, TreeKey *split_key);
+/*  @brief Remove key from B+tree.
+ *
+ *  @param tree The B+tree.
+ *  @param key The key to remove.
+ *  @return void* Removed value, NULL if tree doesn't have key.
+ */
+void *remove_tree(Tree *tree, const TreeKey *key);
+/*  @brief Move cursor to key.
+ *
+ *  @param tree The B+tree.
+ *  @param key The key to find.
+ *  @param cursor Cursor to the first key not less than key.
+ *  @return void.
+ */
+void seek_tree(const Tree *tree, const TreeKey *key, TreeCursor *cursor);
+/*  @brief Get next value of cursor.
+ *
+ *  @param cursor The cursor.
+ *  @param key The key of value, it can be NULL.
+ *  @param value The value, it can be NULL.
+ *  @return _Bool false if cursor is at the end.
+ */
+_Bool next_tree(TreeCursor *cursor, TreeKey *key, void **value);
+/*  @brief Get previous value of cursor.
+ *
+ *  Cursor is moved back, so next_tree after it gives same value.
+ *
+ *  @param cursor The cursor.
+ *  @param key The key of value, it can be NULL.
+ *  @param value The value, it can be NULL.
+ *  @return _Bool false if cursor is at the start.
+ */
+_Bool prev_tree(TreeCursor *cursor, TreeKey *key, void **value);
+/*  @brief Get all values of B+tree.
+ *
+ *  @param tree The B+tree.
+ *  @param values Array to save values in key order, it's size should be tree's count.
+ *  @return size_t The number of values.
+ */
+size_t get_tree_values(const Tree *tree, void **values);
+/*  @brief Destroy B+tree.
+ *
+ *  Free all nodes, values aren't freed.
+ *
+ *  @param tree The B+tree.
+ *  @return void.
+ */
+void destroy_tree(Tree *tree);
+/*  @brief Destroy B+tree node and children.
+ *
+ *  @param node The node to free.
+ *  @return void.
+ */
+void destroy_tree_node(TreeNode *node);
+
+/*  @brief Compare books by ISBN.
+ *
+ *  Compare ISBN, and book number if ISBN is same.
+ *  It is the order of search result.
+ *
+ *  @param a Book to compare.
+ *  @param b Book to compare.
+ *  @return int Negative if a is before b, 0 if same, positive if a is after b.
+ */
+int compare_book_order(const Book *a, const Book *b);
+/*  @brief Init posting index.
+ *
+ *  @param index The posting index to init.
+ *  @param field_offset Offset of the string field in Book.
+ *  @return void.
+ */
+void init_posting_index(PostingIndex *index, const size_t field_offset);
+/*  @brief Get book's term of posting index.
+ *
+ *  @param index The posting index.
+ *  @param book The book.
+ *  @return const char* The string field of book.
+ */
+const char *get_posting_term(const PostingIndex *index, const Book *book);
+/*  @brief Get hash of term.
+ *
+ *  @param term The UTF-8 term.
+ *  @return uint64_t FNV-1a hash of term.
+ */
+uint64_t get_term_hash(const char *term);
+/*  @brief Find postings by term.
+ *
+ *  @param index The posting index.
+ *  @param term The UTF-8 term to find.
+ *  @return Postings* Postings of term, NULL if there isn't.
+ */
+Postings *find_postings(const PostingIndex *index, const char *term);
+/*  @brief Add book to posting index.
+ *
+ *  Book is inserted to it's term's postings in ISBN order.
+ *
+ *  @param index The posting index.
+ *  @param book The book to add.
+ *  @return void.
+ */
+void insert_posting(PostingIndex *index, Book *book);
+/*  @brief Remove book from posting index.
+ *
+ *  If postings become empty, it is removed.
+ *
+ *  @param index The posting index.
+ *  @param book The book to remove.
+ *  @return void.
+ */
+void remove_posting(PostingIndex *index, const Book *book);
+/*  @brief Resize posting index.
+ *
+ *  @param index The posting index.
+ *  @param capacity New capacity, it should be power of 2.
+ *  @return void.
+ */
+void resize_posting_index(PostingIndex *index, const size_t capacity);
+/*  @brief Destroy posting index.
+ *
+ *  Free postings, books aren't freed.
+ *
+ *  @param index The posting index.
+ *  @return void.
+ */
+void destroy_posting_index(PostingIndex *index);
+
+/*  @brief Get gram in text.
+ *
+ *  Latin letter is converted to lower case.
+ *
+ *  @param text The text.
+ *  @param length The length of text.
+ *  @param position Start position of gram.
+ *  @return uint64_t Packed gram, 0 if gram is longer than text.
+ */
+uint64_t get_gram(const wchar_t *text, const size_t length, const size_t position);
+/*  @brief Fold case of character.
+ *
+ *  @param character The character.
+ *  @return wchar_t Lower case of latin letter, same character for others.
+ */
+wchar_t fold_character(wchar_t character);
+/*  @brief Find gram postings.
+ *
+ *  @param index The gram index.
+ *  @param gram The gram to find.
+ *  @return GramPostings* Postings of gram, NULL if there isn't.
+ */
+GramPostings *find_gram(const GramIndex *index, const uint64_t gram);
+/*  @brief Add book number to gram postings.
+ *
+ *  @param index The gram index.
+ *  @param gram The gram.
+ *  @param number Book number.
+ *  @return void.
+ */
+void insert_gram(GramIndex *index, const uint64_t gram, const uint32_t number);
+/*  @brief Remove book number from gram postings.
+ *
+ *  @param index The gram index.
+ *  @param gram The gram.
+ *  @param number Book number.
+ *  @return void.
+ */
+void remove_gram(GramIndex *index, const uint64_t gram, const uint32_t number);
+/*  @brief Add or remove grams of text.
+ *
+ *  @param index The gram index.
+ *  @param text Book's name, author or publisher.
+ *  @param number Book number.
+ *  @param is_insert true to add, false to remove.
+ *  @return void.
+ */
+void update_text_grams(GramIndex *index, const char *text, const uint32_t number, const _Bool is_insert);
+/*  @brief Sort and unique all gram postings.
+ *
+ *  @param index The gram index.
+ *  @return void.
+ */
+void finish_gram_index(GramIndex *index);
+/*  @brief Resize gram index.
+ *
+ *  @param index The gram index.
+ *  @param capacity New capacity, it should be power of 2.
+ *  @return void.
+ */
+void resize_gram_index(GramIndex *index, const size_t capacity);
+/*  @brief Destroy gram index.
+ *
+ *  @param index The gram index.
+ *  @return void.
+ */
+void destroy_gram_index(GramIndex *index);
+/*  @brief Check text has keyword.
+ *
+ *  Case of latin letter is ignored.
+ *
+ *  @param text The text.
+ *  @param keyword The keyword.
+ *  @return _Bool true if text has keyword.
+ */
+_Bool has_keyword(const char *text, const wchar_t *keyword);
+/*  @brief Compare book numbers for qsort.
+ *
+ *  @param a Pointer to uint32_t.
+ *  @param b Pointer to uint32_t.
+ *  @return int Compare result.
+ */
+int compare_number(const void *a, const void *b);
+/*  @brief Seek sorted book numbers.
+ *
+ *  Find the first number not smaller than number from position.
+ *  Steps are doubled and then halved, so seeking in order visits the array once.
+ *
+ *  @param numbers Sorted book numbers.
+ *  @param count The number of numbers.
+ *  @param position Position to start.
+ *  @param number The number to seek.
+ *  @return uint32_t Found position, count if all numbers are smaller.
+ */
+uint32_t seek_numbers(const uint32_t *numbers, const uint32_t count, uint32_t position, const uint32_t number);
+/*  @brief Compare books for qsort.
+ *
+ *  @param a Pointer to Book pointer.
+ *  @param b Pointer to Book pointer.
+ *  @return int Compare result of compare_book_order.
+ */
+int compare_book_pointer(const void *a, const void *b);
+/*  @brief Create list of books.
+ *
+ *  Books are sorted by ISBN and same books are added once.
+ *
+ *  @param books Books to add, it is sorted.
+ *  @param count The number of books.
+ *  @return LinkedList* Book list.
+ */
+LinkedList *create_books_list(Book **books, const size_t count);
+/*  @brief Append books to array.
+ *
+ *  @param books The array, it is reallocated.
+ *  @param count The number of books in array.
+ *  @param capacity The capacity of array.
+ *  @param added Books to append.
+ *  @param added_count The number of books to append.
+ *  @return void.
+ */
+void append_books(Book ***books, size_t *count, size_t *capacity, Book *const *added, const size_t added_count);
+
+/*  @brief Init fuzzy search query.
+ *
+ *  @param pattern The pattern to init.
+ *  @param query The query, it should be shorter than SIZE_INPUT_MAX.
+ *  @return void.
+ */
+void init_fuzzy_pattern(FuzzyPattern *pattern, const wchar_t *query);
+/*  @brief Get bit vectors of character.
+ *
+ *  @param pattern The pattern.
+ *  @param character Folded character.
+ *  @return const uint64_t* Bit vectors, NULL if query hasn't the character.
+ */
+const uint64_t *get_fuzzy_masks(const FuzzyPattern *pattern, const wchar_t character);
+/*  @brief Get edit distance to text.
+ *
+ *  Myers' bit-parallel algorithm, query is split by FUZZY_WORD_BITS characters.
+ *  It stops when distance can't be max_distance or less.
+ *
+ *  @param pattern The query.
+ *  @param text The text.
+ *  @param text_length The length of text.
+ *  @param max_distance Allowed edit distance.
+ *  @return size_t Edit distance, more than max_distance if it is too far.
+ */
+size_t get_edit_distance(const FuzzyPattern *pattern, const wchar_t *text, const size_t text_length, const size_t max_distance);
+/*  @brief Get choseong number of character.
+ *
+ *  @param character Hangul syllable or compatibility jamo consonant.
+ *  @return int Choseong number from 1, 0 if character has no choseong.
+ */
+int get_choseong(const wchar_t character);
+/*  @brief Get choseong key of text.
+ *
+ *  Characters except Hangul are skipped.
+ *
+ *  @param text The text.
+ *  @param length The number of choseong in text is saved, it can be NULL.
+ *  @return uint64_t Packed choseong key.
+ */
+uint64_t get_choseong_key(const wchar_t *text, size_t *length);
+/*  @brief Get mask of choseong key prefix.
+ *
+ *  @param length The number of choseong in prefix.
+ *  @return uint64_t Mask of prefix's bits.
+ */
+uint64_t get_choseong_mask(const size_t length);
+/*  @brief Check text starts with choseong of prefix.
+ *
+ *  @param text The text.
+ *  @param prefix The prefix.
+ *  @return _Bool true if all choseong of prefix are same.
+ */
+_Bool has_choseong_prefix(const char *text, const wchar_t *prefix);
+
+/*  @brief Update title in title trie.
+ *
+ *  Add title if it isn't in trie, remove title if book_count is 0.
+ *
+ *  @param trie The title trie.
+ *  @param title The title.
+ *  @param book_delta Change of the number of books.
+ *  @param loan_delta Change of the loan count.
+ *  @return void.
+ */
+void update_title(TitleTrie *trie, const wchar_t *title, const int book_delta, const int64_t loan_delta);
+/*  @brief Compare titles by rank.
+ *
+ *  @param a Title to compare.
+ *  @param b Title to compare.
+ *  @return int Negative if a is more borrowed.
+ */
+int compare_title_entry(const TitleEntry *a, const TitleEntry *b);
+/*  @brief Create title trie node.
+ *
+ *  @param label Label of node, it is copied.
+ *  @param length The length of label.
+ *  @return TitleNode* Created node.
+ */
+TitleNode *create_title_node(const wchar_t *label, const size_t length);
+/*  @brief Find child of title trie node.
+ *
+ *  @param node The parent node.
+ *  @param character First character of child's label.
+ *  @param position Position of child is saved, or position to insert if there isn't.
+ *  @return TitleNode* The child, NULL if there isn't.
+ */
+TitleNode *find_title_child(const TitleNode *node, const wchar_t character, size_t *position);
+/*  @brief Add title to top of node.
+ *
+ *  Title's rank should be only raised.
+ *
+ *  @param node The node.
+ *  @param entry The title.
+ *  @return void.
+ */
+void raise_title_top(TitleNode *node, TitleEntry *entry);
+/*  @brief Build top of node from it's entry and children.
+ *
+ *  @param node The node.
+ *  @return void.
+ */
+void build_title_top(TitleNode *node);
+/*  @brief Destroy title trie.
+ *
+ *  @param trie The title trie.
+ *  @return void.
+ */
+void destroy_title_trie(TitleTrie *trie);
+/*  @brief Destroy title trie node and it's children.
+ *
+ *  @param node The node.
+ *  @return void.
+ */
+void destroy_title_node(TitleNode *node);
+/*  @brief Find borrow list by client.
+ *
+ *   Find borrow list by client.
+ *
+ *  @param index The borrow index to get borrow.
+ *  @param client The client to get borrow, it can be NULL.
+ *  @param cursor Cursor of fined borrows, newest borrow is first.
+ *  @return void.
+ */
+void find_borrows_by_client(const BorrowIndex *index, const Client *client, BorrowCursor *cursor);
+/*  @brief Get next borrow of cursor.
+ *
+ *  @param cursor The cursor.
+ *  @return Borrow* Next borrow, NULL if cursor is at the end.
+ */
+Borrow *next_borrow_cursor(BorrowCursor *cursor);
+/*  @brief Find borrow by client and book.
+ *
+ *  Find borrow by client and book.
+ *
+ *  @param index The borrow index to get borrow.
+ *  @param client The client to get borrow.
+ *  @param book The book to get borrow.
+ *  @return Borrow* Fined Borrow.
+ */
+Borrow *find_borrow(const BorrowIndex *index, Client *client, Book *book);
+/*  @brief Find borrow by book number.
+ *
+ *  @param index The borrow index to get borrow.
+ *  @param book_number The book's number.
+ *  @return Borrow* Active loan of the book, NULL if book isn't borrowed.
+ */
+Borrow *find_borrow_by_book(const BorrowIndex *index, const uint32_t book_number);
+/*  @brief Find borrows overdue at the time.
+ *
+ *  @param index The borrow index to get borrow.
+ *  @param now The time, borrow whose return date is before it is overdue.
+ *  @param cursor Cursor of fined borrows, earliest return date is first.
+ *  @return void.
+ */
+void find_overdue_borrows(const BorrowIndex *index, const time_t now, BorrowCursor *cursor);
+/*  @brief Find borrows due from the time.
+ *
+ *  @param index The borrow index to get borrow.
+ *  @param from The time, borrow whose return date is from it is fined.
+ *  @param cursor Cursor of fined borrows, earliest return date is first.
+ *  @return void.
+ */
+void find_due_borrows(const BorrowIndex *index, const time_t from, BorrowCursor *cursor);
+/*  @brief Print borrows of cursor with student number.
+ *
+ *  @param cursor Cursor to print, it is moved.
+ *  @param limit Maximum count to print.
+ *  @return size_t The count of printed borrows.
+ */
+size_t print_due_borrows(BorrowCursor *cursor, const size_t limit);
+/*  @brief Get borrow key of student tree.
+ *
+ *  Newer loan has smaller key, loan date is used until 2106.
+ *
+ *  @param borrow The borrow.
+ *  @return TreeKey Student number and loan date(descending) with book number.
+ */
+TreeKey get_borrow_student_key(const Borrow *borrow);
+/*  @brief Get borrow key of book tree.
+ *
+ *  @param borrow The borrow.
+ *  @return TreeKey Book number and student number.
+ */
+TreeKey get_borrow_book_key(const Borrow *borrow);
+/*  @brief Get borrow key of due tree.
+ *
+ *  @param borrow The borrow.
+ *  @return TreeKey Return date and student number with book number.
+ */
+TreeKey get_borrow_due_key(const Borrow *borrow);
+/*  @brief Add borrow to borrow index.
+ *
+ *  @param index The borrow index.
+ *  @param borrow The borrow to add.
+ *  @return void.
+ */
+void insert_borrow_index(BorrowIndex *index, Borrow *borrow);
+/*  @brief Remove borrow from borrow index.
+ *
+ *  Keys of other borrows aren't removed.
+ *
+ *  @param index The borrow index.
+ *  @param borrow The borrow to remove.
+ *  @return void.
+ */
+void remove_borrow_index(BorrowIndex *index, const Borrow *borrow);
+/*  @brief Destroy borrow index.
+ *
+ *  @param index The borrow index.
+ *  @return void.
+ */
+void destroy_borrow_index(BorrowIndex *index);
+
+/*  @brief Open loan history.
+ *
+ *  Only if history file doesn't exist, active borrows are added as history.
+ *  If history file exists but isn't valid, history is empty and is_broken is set,
+ *  the file isn't written again from active borrows.
+ *
+ *  @param file_name The history file's name.
+ *  @param history The loan history.
+ *  @param borrows The borrow table.
+ *  @return void.
+ */
+void open_loan_history(const char *file_name, LoanHistory *history, const Table *borrows);
+/*  @brief Map loan history file.
+ *
+ *  Previous mapping is unmapped, pending loans are kept.
+ *  If file doesn't exist, need_rewrite of snapshot is set.
+ *  If file exists but isn't valid, is_broken is set.
+ *
+ *  @param file_name The history file's name.
+ *  @param history The loan history.
+ *  @return int EOF if file isn't mapped.
+ */
+int map_loan_history(const char *file_name, LoanHistory *history);
+/*  @brief Add loan to loan history.
+ *
+ *  Loan which is already in history isn't added again(e.g. journal replay).
+ *
+ *  @param history The loan history.
+ *  @param borrow The borrow.
+ *  @return void.
+ */
+void add_loan_history(LoanHistory *history, const Borrow *borrow);
+/*  @brief Save pending loans to history file.
+ *
+ *  Broken history file is renamed(file_name.time.broken) and new file is made.
+ *
+ *  @param history The loan history.
+ *  @param file_name The history file's name.
+ *  @return void.
+ */
+void save_loan_history(LoanHistory *history, const char *file_name);
+/*  @brief Compare loan records.
+ *
+ *  @param a The loan record.
+ *  @param b The loan record.
+ *  @return int Negative if a is first, positive if b is first, 0 if same.
+ */
+int compare_loan_record(const LoanRecord *a, const LoanRecord *b);
+/*  @brief Make fences of blocks which don't have fence.
+ *
+ *  @param history The loan history.
+ *  @return void.
+ */
+void build_loan_history_fences(LoanHistory *history);
+/*  @brief Search first record of history file from the date.
+ *
+ *  Fence is searched first, then only one block is searched.
+ *
+ *  @param history The loan history.
+ *  @param date The loan date.
+ *  @return size_t Position of first record whose loan date is date or later.
+ */
+size_t search_loan_history(LoanHistory *history, const int64_t date);
+/*  @brief Search first pending loan from the date.
+ *
+ *  @param history The loan history.
+ *  @param date The loan date.
+ *  @return size_t Position of first pending loan whose loan date is date or later.
+ */
+size_t search_pending_loans(const LoanHistory *history, const int64_t date);
+/*  @brief Find loans made in the range.
+ *
+ *  @param history The loan history.
+ *  @param from Start of range.
+ *  @param to End of range, it isn't included.
+ *  @param cursor Cursor of fined loans, oldest loan is first.
+ *  @return void.
+ */
+void find_loans_by_date(LoanHistory *history, const time_t from, const time_t to, LoanHistoryCursor *cursor);
+/*  @brief Get next loan of cursor.
+ *
+ *  @param cursor The cursor.
+ *  @return const LoanRecord* Next loan, NULL if cursor is at the end.
+ */
+const LoanRecord *next_loan_history_cursor(LoanHistoryCursor *cursor);
+/*  @brief Count loans made in the range.
+ *
+ *  Records aren't read, only bounds of range are searched.
+ *
+ *  @param history The loan history.
+ *  @param from Start of range.
+ *  @param to End of range, it isn't included.
+ *  @return size_t The count of loans.
+ */
+size_t count_loans_by_date(LoanHistory *history, const time_t from, const time_t to);
+/*  @brief Destroy loan history.
+ *
+ *  @param history The loan history.
+ *  @return void.
+ */
+void destroy_loan_history(LoanHistory *history);
+
+/*  @brief remove client to client table.
+ *
+ *  Remove client from the table and the index.
+ *  Free client, it's slot is used again.
+ *
+ *  @param clients The client table to remove client.
+ *  @param index Client index.
+ *  @param arena The arena of client.
+ *  @param client The client will be removed.
+ *  @return void.
+ */
+void remove_client(Table *clients, ClientIndex *index, RecordArena *arena, Client *client);
+/*  @brief remove book to book table.
+ *
+ *  Remove book from the table and the index.
+ *  Free book, it's slot is used again.
+ *
+ *  @param books The book table to remove book.
+ *  @param index The book index.
+ *  @param arena The arena of book.
+ *  @param book The book will be removed.
+ *  @return void.
+ */
+void remove_book(Table *books, BookIndex *index, RecordArena *arena, Book *book);
+/*  @brief remove borrow to borrow table.
+ *
+ *  Remove borrow from the table and the index.
+ *  Free borrow, it's slot is used again.
+ *
+ *  @param borrows The borrow table to remove borrow.
+ *  @param index The borrow index.
+ *  @param arena The arena of borrow.
+ *  @param borrow The borrow will be removed.
+ *  @return void.
+ */
+void remove_borrow(Table *borrows, BorrowIndex *index, RecordArena *arena, Borrow *borrow);
+
+/*  @brief Free memory for list.
+ *
+ *  Free momory for list but, It isn't free list's member.
+ *
+ *  @param list Linked list to free memory.
+ *  @return void.
+ */
+void destroy_list(LinkedList *list);
+
+/*  @brief Destroy client table.
+ *
+ *  Save client data to file.
+ *  Free the table and release the arena.
+ *  Data in the file is sorted.
+ *
+ *  @param clients Client table.
+ *  @param index Client index has the order of clients.
+ *  @param file_name Saving file name, NULL not to save.
+ *  @param arena The arena of clients.
+ *  @return void.
+ */
+void destroy_clients(Table *clients, const ClientIndex *index, const char *file_name, RecordArena *arena);
+/*  @brief Destroy book table.
+ *
+ *  Save book data to file.
+ *  Free the table and release the arena.
+ *  Data in the file is sorted.
+ *
+ *  @param books Book table.
+ *  @param index Book index has the order of books.
+ *  @param file_name Saving file name, NULL not to save.
+ *  @param arena The arena of books.
+ *  @return void.
+ */
+void destroy_books(Table *books, const BookIndex *index, const char *file_name, RecordArena *arena);
+/*  @brief Destroy borrow table.
+ *
+ *  Save borrow data to file.
+ *  Free the table and release the arena.
+ *
+ *  @param borrows Borrow table.
+ *  @param file_name Saving file name, NULL not to save.
+ *  @param arena The arena of borrows.
+ *  @return void.
+ */
+void destroy_borrows(Table *borrows, const char *file_name, RecordArena *arena);
+
+/*  @brief Destroy client.
+ *
+ *  Give client back to the arena, strings are freed with the arena.
+ *
+ *  @param arena The arena of client.
+ *  @param client Client to free.
+ *  @return void.
+ */
+void destroy_client(RecordArena *arena, Client *client);
+/*  @brief Destroy book.
+ *
+ *  Give book back to the arena, strings are freed with the arena.
+ *
+ *  @param arena The arena of book.
+ *  @param book Book to free.
+ *  @return void.
+ */
+void destroy_book(RecordArena *arena, Book *book);
+/*  @brief Destroy borrow.
+ *
+ *  Give borrow back to the arena, strings are freed with the arena.
+ *
+ *  @param arena The arena of borrow.
+ *  @param borrow Borrow to free.
+ *  @return void.
+ */
+void destroy_borrow(RecordArena *arena, Borrow *borrow);
+
+/*  @brief Open journal.
+ *
+ *  Open journal file to append entries.
+ *  Read only journal is only replayed, file isn't made, changed or removed.
+ *
+ *  @param journal The journal to open.
+ *  @param file_name Journal file name.
+ *  @param is_read_only Open journal only to replay.
+ *  @return int EOF if file can't be opened.
+ */
+int open_journal(Journal *journal, const char *file_name, const _Bool is_read_only);
+/*  @brief Replay journal.
+ *
+ *  Read all entries in journal and apply them to data.
+ *  Broken entries in end of file are removed.
+ *
+ *  @param data Program's all data, journal should be opened.
+ *  @return void.
+ */
+void replay_journal(Data *data);
+/*  @brief Apply journal entry.
+ *
+ *  Apply one entry to data. Applying same entry again doesn't change data,
+ *  so entries already saved in snapshot can be replayed.
+ *
+ *  @param data Program's all data.
+ *  @param type Entry type.
+ *  @param count The number of fields.
+ *  @param fields Entry's fields.
+ *  @return void.
+ */
+void apply_journal_entry(Data *data, const uint32_t type, const uint32_t count, const wchar_t **fields);
+/*  @brief Write journal entry.
+ *
+ *  Append one entry to journal's group.
+ *  It is written to file when group is committed.
+ *
+ *  @param journal The journal to write.
+ *  @param type Entry type.
+ *  @param count The number of fields.
+ *  @param fields Entry's fields.
+ *  @return void.
+ */
+void write_journal(Journal *journal, const uint32_t type, const uint32_t count, const wchar_t **fields);
+/*  @brief Commit journal.
+ *
+ *  Write all entries in group to file and fsync once.
+ *  If write or fsync fails, partly written group is cut from file and entries are kept in group.
+ *
+ *  @param journal The journal to commit.
+ *  @return int EOF if group isn't written.
+ */
+int commit_journal(Journal *journal);
+/*  @brief Wait journal commit.
+ *
+ *  Wait until commit window ends and commit the group.
+ *  If group is full or window already ended, commit without waiting.
+ *
+ *  @param journal The journal to commit.
+ *  @return int EOF if group isn't written.
+ */
+int wait_journal_commit(Journal *journal);
+/*  @brief Print journal statistics.
+ *
+ *  Print commit count, entries per fsync and commit latency to stderr.
+ *
+ *  @param journal The journal to print.
+ *  @return void.
+ */
+void print_journal_stat(const Journal *journal);
+/*  @brief Get elapsed time.
+ *
+ *  @param begin Begin time(CLOCK_MONOTONIC).
+ *  @return uint64_t Elapsed nanoseconds from begin.
+ */
+uint64_t get_elapsed_ns(const struct timespec *begin);
+/*  @brief Clear journal.
+ *
+ *  Remove all entries in journal file.
+ *
+ *  @param journal The journal to clear.
+ *  @return void.
+ */
+void clear_journal(Journal *journal);
+/*  @brief Close journal.
+ *
+ *  Commit remaining entries and close journal file.
+ *
+ *  @param journal The journal to close.
+ *  @return void.
+ */
+void close_journal(Journal *journal);
+/*  @brief Get journal checksum.
+ *
+ *  Calculate checksum by entry header and fields.
+ *
+ *  @param header Entry header, checksum member isn't used.
+ *  @param fields Entry's fields.
+ *  @return uint32_t Checksum.
+ */
+uint32_t get_journal_checksum(const JournalEntryHeader *header, const void *fields);
+
+/*  @brief Write client insertion to journal.
+ *
+ *  @param journal The journal to write.
+ *  @param client Inserted client.
+ *  @return void.
+ */
+void journal_insert_client(Journal *journal, const Client *client);
+/*  @brief Write client update to journal.
+ *
+ *  Password, address and phone number are written.
+ *
+ *  @param journal The journal to write.
+ *  @param client Updated client.
+ *  @return void.
+ */
+void journal_update_client(Journal *journal, const Client *client);
+/*  @brief Write client removal to journal.
+ *
+ *  It should be called before client is removed.
+ *
+ *  @param journal The journal to write.
+ *  @param client Client will be removed.
+ *  @return void.
+ */
+void journal_remove_client(Journal *journal, const Client *client);
+/*  @brief Write book insertion to journal.
+ *
+ *  @param journal The journal to write.
+ *  @param book Inserted book.
+ *  @return void.
+ */
+void journal_insert_book(Journal *journal, const Book *book);
+/*  @brief Write book removal to journal.
+ *
+ *  It should be called before book is removed.
+ *
+ *  @param journal The journal to write.
+ *  @param book Book will be removed.
+ *  @return void.
+ */
+void journal_remove_book(Journal *journal, const Book *book);
+/*  @brief Write borrowing book to journal.
+ *
+ *  Book's availability is changed to 'N' when it is replayed.
+ *
+ *  @param journal The journal to write.
+ *  @param borrow Inserted borrow.
+ *  @return void.
+ */
+void journal_borrow_book(Journal *journal, const Borrow *borrow);
+/*  @brief Write returning book to journal.
+ *
+ *  Book's availability is changed to 'Y' when it is replayed.
+ *  It should be called before borrow is removed.
+ *
+ *  @param journal The journal to write.
+ *  @param borrow Borrow will be removed.
+ *  @return void.
+ */
+void journal_return_book(Journal *journal, const Borrow *borrow);
+/*  @brief Write reserved book numbers to journal.
+ *
+ *  Call after allocate_book_numbers, next number is raised when it is replayed.
+ *
+ *  @param journal The journal to write.
+ *  @param next_number The next book number after reserved range.
+ *  @return void.
+ */
+void journal_reserve_book_numbers(Journal *journal, const uint32_t next_number);
+
+/*  @brief Save checkpoint.
+ *
+ *  Commit journal, save changed records to snapshots and clear journal.
+ *
+ *  @param data Program's all data.
+ *  @return void.
+ */
+void save_checkpoint(Data *data);
+/*  @brief Commit changes.
+ *
+ *  Call after changes are written to journal, before changes are acknowledged.
+ *  Wait group commit, and if journal is big enough, save checkpoint.
+ *  If commit fails, print STRING_JOURNAL_FAILED instead of acknowledging.
+ *
+ *  @param data Program's all data.
+ *  @return int EOF if changes aren't written.
+ */
+int commit_changes(Data *data);
+
+/*  @brief Init screens.
+ *
+ *  Allocate memory for screens.
+ *  Set screen's type.
+ *  Link screen's function pointer.
+ *  Init type to init screen.
+ *
+ *  @param void.
+ *  @return Screens* Initaled screens.
+ */
+Screens *init_screens(void);
+/*  @brief Change screen.
+ *
+ *  Change screens's type
+ *
+ *  @param screens The screens to change.
+ *  @param type The type to change.
+ *  @return void.
+ */
+void change_screen(Screens *screens, char type);
+/*  @brief Clear screen.
+ *
+ *  Clear screen.
+ *
+ *  @param void.
+ *  @return void.
+ */
+void clear_screen(void);
+/*  @brief Draw screen.
+ *
+ *  Fine current screen by type.
+ *  Call draw function linked current screen.
+ *
+ *  @param screens screen data.
+ *  @param data program's all data.
+ *  @return void.
+ */
+void draw_screen(Screens *screens, Data *data);
+/*  @brief Get input data and call current function.
+ *
+ *  Fine current screen by type.
+ *  Call input function linked current screen.
+ *
+ *  @param screens screen data.
+ *  @param data program's all data.
+ *  @return void.
+ */
+void input_screen(Screens *screens, Data *data);
+/*  @brief Destroy screens.
+ *
+ *  Free memory to screens.
+ *
+ *  @param screens screen data.
+ *  @return void.
+ */
+void destroy_screens(Screens *screens);
+
+/*  @brief Draw init screen.
+ *
+ *  Draw init screen.
+ *
+ *  @param data program's all data.
+ *  @return void.
+ */
+void draw_init_screen(Data *data);
+/*  @brief Process init screen's input data.
+ *
+ *  Process init screen's input data.
+ *
+ *  @param input input string.
+ *  @param data program's all data.
+ *  @return void.
+ */
+void input_init_screen(const wchar_t *input, Data *data);
+
+/*  @brief Draw sign up screen.
+ *
+ *  Draw sign up screen.
+ *
+ *  @param data program's all data.
+ *  @return void.
+ */
+void draw_sign_up_screen(Data *data);
+/*  @brief Process sign up screen's input data.
+ *
+ *  Process sign up screen's input data.
+ *
+ *  @param input Input string.
+ *  @param data Program's all data.
+ *  @return void.
+ */
+void input_sign_up_screen(const wchar_t *input, Data *data);
+
+/*  @brief Draw sign in screen.
+ *
+ *  Draw sign in screen.
+ *
+ *  @param data program's all data.
+ *  @return void.
+ */
+void draw_sign_in_screen(Data *data);
+/*  @brief Process sign in screen's input data.
+ *
+ *  Process sign in screen's input data.
+ *
+ *  @param input Input string.
+ *  @param data Program's all data.
+ *  @return void.
+ */
+void input_sign_in_screen(const wchar_t *input, Data *data);
+
+/*  @brief Draw menu member screen.
+ *
+ *  Draw menu member screen.
+ *
+ *  @param data program's all data.
+ *  @return void.
+ */
+void draw_menu_member_screen(Data *data);
+/*  @brief Process menu member screen's input data.
+ *
+ *  Process menu member screen's input data.
+ *
+ *  @param input Input string.
+ *  @param data Program's all data.
+ *  @return void.
+ */
+void input_menu_member_screen(const wchar_t *input, Data *data);
+
+/*  @brief Draw menu admin screen.
+ *
+ *  Draw menu admin screen.
+ *
+ *  @param data program's all data.
+ *  @return void.
+ */
+void draw_menu_admin_screen(Data *data);
+/*  @brief Process menu admin screen's input data.
+ *
+ *  Process menu admin screen's input data.
+ *
+ *  @param input Input string.
+ *  @param data Program's all data.
+ *  @return void.
+ */
+void input_menu_admin_screen(const wchar_t *input, Data *data);
+
+/*  @brief Draw regist book screen.
+ *
+ *  Draw regist book screen.
+ *
+ *  @param data program's all data.
+ *  @return void.
+ */
+void draw_regist_book_screen(Data *data);
+/*  @brief Process regist book screen's input data.
+ *
+ *  Process regist book screen's input data.
+ *
+ *  @param input Input string.
+ *  @param data Program's all data.
+ *  @return void.
+ */
+void input_regist_book_screen(const wchar_t *input, Data *data);
+
+/*  @brief Draw remove book screen.
+ *
+ *  Draw remove book screen.
+ *
+ *  @param data program's all data.
+ *  @return void.
+ */
+void draw_remove_book_screen(Data *data);
+/*  @brief Process remove book screen's input data.
+ *
+ *  Process remove book screen's input data.
+ *
+ *  @param input Input string.
+ *  @param data Program's all data.
+ *  @return void.
+ */
+void input_remove_book_screen(const wchar_t *input, Data *data);
+
+/*  @brief Draw borrow book screen.
+ *
+ *  Draw borrow book screen.
+ *
+ *  @param data program's all data.
+ *  @return void.
+ */
+void draw_borrow_book_screen(Data *data);
+/*  @brief Process borrow book screen's input data.
+ *
+ *  Process borrow book screen's input data.
+ *
+ *  @param input Input string.
+ *  @param data Program's all data.
+ *  @return void.
+ */
+void input_borrow_book_screen(const wchar_t *input, Data *data);
+
+/*  @brief Draw return book screen.
+ *
+ *  Draw return book screen.
+ *
+ *  @param data program's all data.
+ *  @return void.
+ */
+void draw_return_book_screen(Data *data);
+/*  @brief Process return book screen's input data.
+ *
+ *  Process return book screen's input data.
+ *
+ *  @param input Input string.
+ *  @param data Program's all data.
+ *  @return void.
+ */
+void input_return_book_screen(const wchar_t *input, Data *data);
+
+/*  @brief Draw find book screen.
+ *
+ *  Draw find book screen.
+ *
+ *  @param data program's all data.
+ *  @return void.
+ */
+void draw_find_book_screen(Data *data);
+/*  @brief Process find book screen's input data.
+ *
+ *  Process find book screen's input data.
+ *
+ *  @param input Input string.
+ *  @param data Program's all data.
+ *  @return void.
+ */
+void input_find_book_screen(const wchar_t *input, Data *data);
+
+/*  @brief Draw modify client screen.
+ *
+ *  Draw modify client screen.
+ *
+ *  @param data program's all data.
+ *  @return void.
+ */
+void draw_modify_client_screen(Data *data);
+/*  @brief Process modify client screen's input data.
+ *
+ *  Process modify client screen's input data.
+ *
+ *  @param input Input string.
+ *  @param data Program's all data.
+ *  @return void.
+ */
+void input_modify_client_screen(const wchar_t *input, Data *data);
+
+/*  @brief Draw due borrow screen.
+ *
+ *  Draw due borrow screen.
+ *
+ *  @param data program's all data.
+ *  @return void.
+ */
+void draw_due_borrow_screen(Data *data);
+/*  @brief Process due borrow screen's input data.
+ *
+ *  Process due borrow screen's input data.
+ *
+ *  @param input Input string.
+ *  @param data Program's all data.
+ *  @return void.
+ */
+void input_due_borrow_screen(const wchar_t *input, Data *data);
+
+/*  @brief Read string by token.
+ *
+ *  Read string by token.
+ *
+ *  @param file The file to get string.
+ *  @param token Token to divide string.
+ *  @param string String data.
+ *  @return int.
+ */
+int read_string_by_token(FILE *file, const wchar_t *token, const size_t len, wchar_t *string);
+
+/*  @brief Open field reader.
+ *
+ *  Open file and allocate block buffer for reading fields.
+ *
+ *  @param file_name The file name to read.
+ *  @return FieldReader* Allocated reader, NULL if file isn't exist.
+ */
+FieldReader *open_field_reader(const char *file_name);
+/*  @brief Read fields by token.
+ *
+ *  Find count fields ended by token in the buffer.
+ *  If the buffer doesn't have all fields, read next block from file.
+ *  All fields are pointing to the buffer, so they are valid until next call.
+ *
+ *  @param reader The reader to get fields.
+ *  @param token Token to divide fields.
+ *  @param count The number of fields to read.
+ *  @param fields Field views, it should have count members.
+ *  @return int EOF if file don't have count fields.
+ */
+int read_fields(FieldReader *reader, const char *token, const size_t count, FieldView *fields);
+/*  @brief Close field reader.
+ *
+ *  Close file and free memory to reader.
+ *
+ *  @param reader The reader to close.
+ *  @return void.
+ */
+void close_field_reader(FieldReader *reader);
+/*  @brief Copy field to wide string.
+ *
+ *  Convert multibyte field to wide string.
+ *  Converted string is cut by size.
+ *
+ *  @param field The field to convert.
+ *  @param string The string to save, it's size should be bigger than size.
+ *  @param size The string's size.
+ *  @return size_t The length of converted string.
+ */
+size_t copy_field(const FieldView *field, wchar_t *string, const size_t size);
+/*  @brief Reject fields of text file.
+ *
+ *  The row which can't be parsed isn't loaded, so the next save would drop it.
+ *  It's appended as it was read to the file name with STRING_REJECTED_EXTENSION.
+ *  The rejected file is opened at the first rejected row.
+ *
+ *  @param file_name The text file name.
+ *  @param rejected The rejected file, NULL until the first row.
+ *  @param fields Fields of the row.
+ *  @param count The number of fields.
+ *  @param is_read_only 1 only to count the row.
+ *  @return int EOF if the row can't be written.
+ */
+int reject_fields(const char *file_name, FILE **rejected, const FieldView *fields, const size_t count, const _Bool is_read_only);
+/*  @brief Close rejected file.
+ *
+ *  Close rejected file and print how many rows are rejected.
+ *
+ *  @param file_name The text file name.
+ *  @param rejected The rejected file, it can be NULL.
+ *  @param rejected_count The number of rejected rows.
+ *  @param result EOF if some rows can't be written.
+ *  @return int EOF if rows can't be kept.
+ */
+int close_rejected_fields(const char *file_name, FILE *rejected, const size_t rejected_count, int result);
+
+/*  @brief Get next character of UTF-8 string.
+ *
+ *  Invalid byte is converted to U+FFFD.
+ *
+ *  @param text Position in UTF-8 string, it is moved to next character.
+ *  @return wchar_t The character, L'\0' at the end of string.
+ */
+wchar_t next_text_character(const char **text);
+/*  @brief Put character as UTF-8.
+ *
+ *  @param character The character.
+ *  @param text Buffer of 4 bytes to save.
+ *  @return size_t The number of bytes saved.
+ */
+size_t put_text_character(const wchar_t character, char *text);
+/*  @brief Encode wide string to UTF-8 string.
+ *
+ *  Encoded string is cut by size at character boundary.
+ *
+ *  @param string The wide string.
+ *  @param text The UTF-8 string to save.
+ *  @param size The text's size(bytes).
+ *  @return size_t The size of encoded string without NUL.
+ */
+size_t encode_text(const wchar_t *string, char *text, const size_t size);
+/*  @brief Decode UTF-8 string to wide string.
+ *
+ *  Decoded string is cut by size.
+ *
+ *  @param text The UTF-8 string.
+ *  @param string The wide string to save.
+ *  @param size The string's size.
+ *  @return size_t The length of decoded string.
+ */
+size_t decode_text(const char *text, wchar_t *string, const size_t size);
+/*  @brief Get size of wide string in UTF-8.
+ *
+ *  @param string The wide string.
+ *  @return size_t The size(bytes) without NUL.
+ */
+size_t get_text_size(const wchar_t *string);
+/*  @brief Compare UTF-8 string with wide string.
+ *
+ *  @param text The UTF-8 string.
+ *  @param string The wide string.
+ *  @return int Same as wcscmp of decoded text and string.
+ */
+int compare_text(const char *text, const wchar_t *string);
+/*  @brief Set UTF-8 character type.
+ *
+ *  Strings are UTF-8 in memory and text files are read without converting,
+ *  but wprintf and copy_field convert by LC_CTYPE.
+ *  If the user's locale isn't UTF-8, LC_CTYPE is changed to one of UTF-8 locales,
+ *  so data files and terminal are always UTF-8. Other categories are kept.
+ *
+ *  @return int EOF if there isn't UTF-8 locale.
+ */
+int set_utf8_locale(void);
+
+/*  @brief Run batch command without screen.
+ *
+ *  overdue [YYYY-MM-DD] : print borrows overdue at the date(default is now).
+ *  due [N] : print N borrows due first(default is SIZE_DUE_LIST).
+ *  loans FROM TO : print loans made from FROM to TO(YYYY-MM-DD, TO is included).
+ *  loan-count FROM TO : print count of loans made in each day from FROM to TO.
+ *
+ *  @param data Program's all data.
+ *  @param argc The count of arguments.
+ *  @param argv Command and it's arguments.
+ *  @return int 0 if command is run, EOF if command is wrong.
+ */
+int run_command(Data *data, const int argc, char *argv[]);
+/*  @brief Get local time of 0 o'clock of the date.
+ *
+ *  @param string Date string(YYYY-MM-DD).
+ *  @return time_t The time, EOF if string isn't date.
+ */
+time_t get_date(const char *string);
+/*  @brief Get 0 o'clock of next day.
+ *
+ *  @param date The time of 0 o'clock.
+ *  @return time_t The time of next day.
+ */
+time_t get_next_date(const time_t date);
+
+/*   @prog Library manager
+ *
+ *   Library manager program for programming team project
+ *  1. Init datas.
+ *  2. Clear screen.
+ *  3. Draw screen.
+ *  4. Get input string and processing.
+ *  5. If program is running, go to step 2.
+ *  6. Save all data and free the memory.
+ *  7. End the program.
+ *  If command is given(e.g. overdue, due), run it instead of step 2 to 5,
+ *  and nothing is saved in step 6, files can be used by other running program.
+ *
+ *   @author Park Si-Yual.
+ *  @recent 2018-11-03.
+ */
+int main(int argc, char *argv[])
+{
+    Data data;
+    int result = 0;
+    const _Bool is_command = argc > 1;
+
+    // 다른 로케일로 읽고 쓰면 저장할 때 글자가 깨지므로 시작하지 않음
+    if (set_utf8_locale() == EOF)
+    {
+        fprintf(stderr, "UTF-8 locale is required.\n");
+        return 1;
+    }
+
+    init_record_arena(&data.arenas[SNAPSHOT_CLIENT], sizeof(Client));
+    init_record_arena(&data.arenas[SNAPSHOT_BOOK], sizeof(Book));
+    init_record_arena(&data.arenas[SNAPSHOT_BORROW], sizeof(Borrow));
+
+    init_clients_by_snapshot(STRING_CLIENT_SNAPSHOT_FILE, &data.snapshots[SNAPSHOT_CLIENT], &data.clients, &data.client_index, &data.arenas[SNAPSHOT_CLIENT]);
+    if (data.snapshots[SNAPSHOT_CLIENT].address == NULL)
+        result |= init_clients(STRING_CLIENT_FILE, &data.clients, &data.client_index, &data.arenas[SNAPSHOT_CLIENT], is_command);
+    init_books_by_snapshot(STRING_BOOK_SNAPSHOT_FILE, &data.snapshots[SNAPSHOT_BOOK], &data.books, &data.book_index, &data.arenas[SNAPSHOT_BOOK]);
+    if (data.snapshots[SNAPSHOT_BOOK].address == NULL)
+        result |= init_books(STRING_BOOK_FILE, &data.books, &data.book_index, &data.arenas[SNAPSHOT_BOOK], is_command);
+    init_borrows_by_snapshot(STRING_BORROW_SNAPSHOT_FILE, &data.snapshots[SNAPSHOT_BORROW], &data.borrows, &data.borrow_index, &data.arenas[SNAPSHOT_BORROW]);
+    if (data.snapshots[SNAPSHOT_BORROW].address == NULL)
+        result |= init_borrows(STRING_BORROW_FILE, &data.borrows, &data.borrow_index, &data.arenas[SNAPSHOT_BORROW], is_command);
+    // 읽지 못한 행을 보관할 수 없으면 저장하면 잃어버리므로 시작하지 않음
+    if (result != 0)
+        return 1;
+    open_loan_history(STRING_HISTORY_FILE, &data.history, &data.borrows);
+
+    // 명령은 읽기만 하므로 저널을 비우거나 체크포인트하지 않음
+    open_journal(&data.journal, STRING_JOURNAL_FILE, is_command);
+    replay_journal(&data);
+    if (!is_command)
+        commit_changes(&data);
+
+    data.screens = init_screens();
+
+    data.is_running = 1;
+    data.is_admin = 0;
+
+    if (is_command)
+    {
+        result = run_command(&data, argc - 1, argv + 1) == EOF;
+        data.is_running = 0;
+    }
+
+    while (data.is_running)
+    {
+        clear_screen();
+        draw_screen(data.screens, &data);
+        input_screen(data.screens, &data);
+    }
+
+    if (!is_command)
+        save_checkpoint(&data);
+    close_journal(&data.journal);
+    print_journal_stat(&data.journal);
+
+    destroy_clients(&data.clients, &data.client_index, is_command ? NULL : STRING_CLIENT_FILE, &data.arenas[SNAPSHOT_CLIENT]);
+    destroy_client_index(&data.client_index);
+    destroy_books(&data.books, &data.book_index, is_command ? NULL : STRING_BOOK_FILE, &data.arenas[SNAPSHOT_BOOK]);
+    destroy_book_index(&data.book_index);
+    destroy_borrows(&data.borrows, is_command ? NULL : STRING_BORROW_FILE, &data.arenas[SNAPSHOT_BORROW]);
+    destroy_borrow_index(&data.borrow_index);
+    destroy_loan_history(&data.history);
+
+    for (int i = 0; i < SNAPSHOT_MAX; i++)
+        unmap_snapshot(&data.snapshots[i]);
+
+    destroy_screens(data.screens);
+
+    return result;
+}
+
+int init_clients(const char *file_name, Table *clients, ClientIndex *index, RecordArena *arena, const _Bool is_read_only)
+{
+    init_table(clients);
+    build_client_index(index, clients);
+    FieldReader *reader = open_field_reader(file_name);
+    if (reader == NULL)
+        return 0;
+
+    Client *client = NULL;
+    FieldView fields[5];
+    wchar_t student_number[SIZE_INPUT_MAX];
+    wchar_t phone_number[SIZE_INPUT_MAX];
+    uint32_t number;
+    uint64_t phone;
+    FILE *rejected = NULL;
+    size_t rejected_count = 0;
+    int result = 0;
+
+    while (read_fields(reader, " | ", 5, fields) != EOF)
+    {
+        // 잘린 필드나 읽을 수 없는 값, 중복된 학번은 바꿔 저장하지 않도록 불러오지 않음
+        number = copy_field(&fields[0], student_number, SIZE_INPUT_MAX) == fields[0].size ? get_student_number(student_number) : STUDENT_NUMBER_NONE;
+        phone = copy_field(&fields[4], phone_number, SIZE_INPUT_MAX) == fields[4].size ? get_phone_number(phone_number) : PHONE_NUMBER_NONE;
+        if (phone == PHONE_NUMBER_NONE && fields[4].size == 0)
+            phone = 0;
+        if (number == STUDENT_NUMBER_NONE || phone == PHONE_NUMBER_NONE || find_client_by_student_number(index, number) != NULL)
+        {
+            result |= reject_fields(file_name, &rejected, fields, 5, is_read_only);
+            rejected_count++;
+            continue;
+        }
+
+        client = allocate_record(arena);
+
+        client->student_number = number;
+        client->password = create_arena_string_by_field(arena, &fields[1]);
+        client->name = create_arena_string_by_field(arena, &fields[2]);
+        client->address = create_arena_string_by_field(arena, &fields[3]);
+        client->phone_number = phone;
+        client->dirty = 0;
+        client->snapshot_offset = 0;
+
+        insert_client(clients, index, client);
+    }
+
+    close_field_reader(reader);
+    return close_rejected_fields(file_name, rejected, rejected_count, result);
+}
+int init_books(const char *file_name, Table *books, BookIndex *index, RecordArena *arena, const _Bool is_read_only)
+{
+    init_table(books);
+    FieldReader *reader = open_field_reader(file_name);
+    if (reader == NULL)
+    {
+        finish_book_index(index);
+        return 0;
+    }
+
+    Book *book = NULL;
+    FieldView fields[7];
+    wchar_t number[SIZE_INPUT_MAX];
+    wchar_t ISBN[SIZE_INPUT_MAX];
+    uint32_t book_number;
+    uint64_t ISBN_key;
+    FILE *rejected = NULL;
+    size_t rejected_count = 0;
+    int result = 0;
+
+    while (read_fields(reader, " | ", 7, fields) != EOF)
+    {
+        // ISBN이 비어 있는 책은 ISBN_KEY_OTHER로 불러옴
+        book_number = copy_field(&fields[0], number, SIZE_INPUT_MAX) == fields[0].size ? get_book_number(number) : 0;
+        ISBN_key = copy_field(&fields[4], ISBN, SIZE_INPUT_MAX) == fields[4].size ? get_ISBN_key(ISBN) : ISBN_KEY_OTHER;
+        if (book_number == 0 || (ISBN_key == ISBN_KEY_OTHER && fields[4].size != 0) || fields[6].size != 1
+            || (unsigned char)fields[6].text[0] >= 0x80 || find_book_by_number(index, book_number) != NULL)
+        {
+            result |= reject_fields(file_name, &rejected, fields, 7, is_read_only);
+            rejected_count++;
+            continue;
+        }
+
+        book = allocate_record(arena);
+
+        book->number = book_number;
+        book->name = create_arena_string_by_field(arena, &fields[1]);
+        book->publisher = intern_arena_string_by_field(arena, &fields[2]);
+        book->author = intern_arena_string_by_field(arena, &fields[3]);
+        book->ISBN = ISBN_key;
+        book->location = intern_arena_string_by_field(arena, &fields[5]);
+        book->availability = (wchar_t)fields[6].text[0];
+        book->loan_count = 0;
+        book->dirty = 0;
+        book->snapshot_offset = 0;
+
+        insert_book(books, index, book);
+    }
+
+    close_field_reader(reader);
+    finish_book_index(index);
+    return close_rejected_fields(file_name, rejected, rejected_count, result);
+}
+int init_borrows(const char *file_name, Table *borrows, BorrowIndex *index, RecordArena *arena, const _Bool is_read_only)
+{
+    init_table(borrows);
+    memset(index, 0, sizeof(BorrowIndex));
+    FieldReader *reader = open_field_reader(file_name);
+    if (reader == NULL)
+        return 0;
+
+    Borrow *borrow = NULL;
+    FieldView fields[5];
+    wchar_t student_number[SIZE_INPUT_MAX];
+    wchar_t number[SIZE_INPUT_MAX];
+    char date[2][SIZE_INPUT_MAX] = {0};
+    char *date_end[2];
+    uint32_t client_number;
+    uint32_t book_number;
+    FILE *rejected = NULL;
+    size_t rejected_count = 0;
+    int result = 0;
+
+    while (read_fields(reader, " | ", 5, fields) != EOF)
+    {
+        client_number = copy_field(&fields[0], student_number, SIZE_INPUT_MAX) == fields[0].size ? get_student_number(student_number) : STUDENT_NUMBER_NONE;
+        book_number = copy_field(&fields[2], number, SIZE_INPUT_MAX) == fields[2].size ? get_book_number(number) : 0;
+        for (int i = 0; i < 2; i++)
+        {
+            const size_t size = fields[3 + i].size < SIZE_INPUT_MAX ? fields[3 + i].size : 0;
+            memcpy(date[i], fields[3 + i].text, size);
+            date[i][size] = '\0';
+            strtoll(date[i], &date_end[i], 10);
+        }
+        // 한 권은 한 번만 대여되므로 같은 책의 대여가 또 있으면 불러오지 않음
+        if (client_number == STUDENT_NUMBER_NONE || book_number == 0 || date_end[0] == date[0] || *date_end[0] != '\0'
+            || date_end[1] == date[1] || *date_end[1] != '\0' || find_borrow_by_book(index, book_number) != NULL)
+        {
+            result |= reject_fields(file_name, &rejected, fields, 5, is_read_only);
+            rejected_count++;
+            continue;
+        }
+
+        borrow = allocate_record(arena);
+
+        borrow->student_number = client_number;
+        borrow->book_name = create_arena_string_by_field(arena, &fields[1]);
+        borrow->book_number = book_number;
+
+        borrow->loan_date = (time_t)strtoll(date[0], NULL, 10);
+        borrow->return_date = (time_t)strtoll(date[1], NULL, 10);
+        borrow->dirty = 0;
+        borrow->snapshot_offset = 0;
+
+        insert_borrow(borrows, index, borrow);
+    }
+
+    close_field_reader(reader);
+    return close_rejected_fields(file_name, rejected, rejected_count, result);
+}
+
+void init_clients_by_snapshot(const char *file_name, Snapshot *snapshot, Table *clients, ClientIndex *index, RecordArena *arena)
+{
+    init_table(clients);
+    memset(index, 0, sizeof(ClientIndex));
+    const SnapshotHeader *header = map_snapshot(file_name, SNAPSHOT_CLIENT, sizeof(ClientRecord), snapshot);
+    if (header == NULL)
+        return;
+
+    Client *client = NULL;
+    Client *old_client = NULL;
+    SnapshotSegment segment;
+    uint64_t offset = sizeof(SnapshotHeader);
+    _Bool is_broken = 0;
+
+    for (uint64_t now_segment = 0; now_segment < header->segment_count && !is_broken; now_segment++)
+    {
+        if (get_snapshot_segment(header, &offset, &segment) == EOF)
+        {
+            is_broken = 1;
+            break;
+        }
+        if (now_segment == 1)
+            build_client_index(index, clients);
+
+        const ClientRecord *records = segment.records;
+        for (uint64_t i = 0; i < segment.record_count && !is_broken; i++)
+        {
+            if (records[i].is_removed)
+                continue;
+            client = allocate_record(arena);
+
+            client->student_number = records[i].student_number;
+            client->phone_number = records[i].phone_number;
+            client->password = get_snapshot_string(&segment, records[i].password);
+            client->name = get_snapshot_string(&segment, records[i].name);
+            client->address = get_snapshot_string(&segment, records[i].address);
+            client->dirty = 0;
+            client->snapshot_offset = (const char *)&records[i] - (const char *)header;
+            if (client->password == NULL || client->name == NULL || client->address == NULL)
+            {
+                destroy_client(arena, client);
+                is_broken = 1;
+                break;
+            }
+
+            // 첫 세그먼트는 인덱스 없이 넣고, 다음 세그먼트는 같은 학번의 회원을 대신함
+            if (now_segment > 0)
+            {
+                old_client = find_client_by_student_number(index, client->student_number);
+                if (old_client != NULL)
+                    remove_client(clients, index, arena, old_client);
+                insert_client(clients, index, client);
+                continue;
+            }
+
+            client->handle = insert_table(clients, client);
+        }
+    }
+
+    // 깨진 스냅샷의 일부만 쓰지 않고 텍스트 파일을 읽게 함
+    if (is_broken)
+    {
+        destroy_table(clients);
+        destroy_client_index(index);
+        release_record_arena(arena);
+        unmap_snapshot(snapshot);
+        snapshot->need_rewrite = 1;
+        return;
+    }
+    if (index->slots == NULL)
+        build_client_index(index, clients);
+}
+void init_books_by_snapshot(const char *file_name, Snapshot *snapshot, Table *books, BookIndex *index, RecordArena *arena)
+{
+    init_table(books);
+    init_book_index(index);
+    const SnapshotHeader *header = map_snapshot(file_name, SNAPSHOT_BOOK, sizeof(BookRecord), snapshot);
+    if (header == NULL)
+        return;
+    // 지워진 도서의 번호를 다시 쓰지 않도록 저장된 다음 번호부터 시작함
+    if (header->next_key > index->next_number && header->next_key <= UINT32_MAX)
+        index->next_number = (uint32_t)header->next_key;
+
+    Book *book = NULL;
+    Book *old_book = NULL;
+    SnapshotSegment segment;
+    uint64_t offset = sizeof(SnapshotHeader);
+    _Bool is_broken = 0;
+
+    for (uint64_t now_segment = 0; now_segment < header->segment_count && !is_broken; now_segment++)
+    {
+        if (get_snapshot_segment(header, &offset, &segment) == EOF)
+        {
+            is_broken = 1;
+            break;
+        }
+
+        if (now_segment == 1)
+            finish_book_index(index);
+
+        const BookRecord *records = segment.records;
+        for (uint64_t i = 0; i < segment.record_count && !is_broken; i++)
+        {
+            if (records[i].is_removed)
+                continue;
+            book = allocate_record(arena);
+
+            book->number = records[i].number;
+            book->ISBN = records[i].ISBN;
+            book->availability = records[i].availability;
+            book->loan_count = records[i].loan_count;
+            book->name = get_snapshot_string(&segment, records[i].name);
+            book->publisher = intern_arena_text(arena, get_snapshot_string(&segment, records[i].publisher), 0);
+            book->author = intern_arena_text(arena, get_snapshot_string(&segment, records[i].author), 0);
+            book->location = intern_arena_text(arena, get_snapshot_string(&segment, records[i].location), 0);
+            book->dirty = 0;
+            book->snapshot_offset = (const char *)&records[i] - (const char *)header;
+            if (book->name == NULL || book->publisher == NULL || book->author == NULL || book->location == NULL)
+            {
+                destroy_book(arena, book);
+                is_broken = 1;
+                break;
+            }
+
+            // 다음 세그먼트는 같은 번호의 도서를 대신함
+            if (now_segment > 0)
+            {
+                old_book = find_book_by_number(index, book->number);
+                if (old_book != NULL)
+                    remove_book(books, index, arena, old_book);
+            }
+            insert_book(books, index, book);
+        }
+    }
+
+    // 깨진 스냅샷의 일부만 쓰지 않고 텍스트 파일을 읽게 함, 다음 번호는 텍스트 파일에 없으므로 남김
+    if (is_broken)
+    {
+        const uint32_t next_number = index->next_number;
+        destroy_table(books);
+        destroy_book_index(index);
+        init_book_index(index);
+        index->next_number = next_number;
+        release_record_arena(arena);
+        unmap_snapshot(snapshot);
+        snapshot->need_rewrite = 1;
+        return;
+    }
+    finish_book_index(index);
+}
+void init_borrows_by_snapshot(const char *file_name, Snapshot *snapshot, Table *borrows, BorrowIndex *index, RecordArena *arena)
+{
+    init_table(borrows);
+    memset(index, 0, sizeof(BorrowIndex));
+    const SnapshotHeader *header = map_snapshot(file_name, SNAPSHOT_BORROW, sizeof(BorrowRecord), snapshot);
+    if (header == NULL)
+        return;
+
+    Borrow *borrow = NULL;
+    Borrow *old_borrow = NULL;
+    SnapshotSegment segment;
+    uint64_t offset = sizeof(SnapshotHeader);
+    _Bool is_broken = 0;
+
+    for (uint64_t now_segment = 0; now_segment < header->segment_count && !is_broken; now_segment++)
+    {
+        if (get_snapshot_segment(header, &offset, &segment) == EOF)
+        {
+            is_broken = 1;
+            break;
+        }
+
+        const BorrowRecord *records = segment.records;
+        for (uint64_t i = 0; i < segment.record_count && !is_broken; i++)
+        {
+            if (records[i].is_removed)
+                continue;
+            borrow = allocate_record(arena);
+
+            borrow->student_number = records[i].student_number;
+            borrow->book_number = records[i].book_number;
+            borrow->book_name = get_snapshot_string(&segment, records[i].book_name);
+            borrow->loan_date = (time_t)records[i].loan_date;
+            borrow->return_date = (time_t)records[i].return_date;
+            borrow->dirty = 0;
+            borrow->snapshot_offset = (const char *)&records[i] - (const char *)header;
+            if (borrow->book_name == NULL)
+            {
+                destroy_borrow(arena, borrow);
+                is_broken = 1;
+                break;
+            }
+
+            // 다음 세그먼트는 같은 회원과 도서의 대여를 대신함
+            if (now_segment > 0)
+            {
+                const TreeKey key = get_borrow_book_key(borrow);
+                old_borrow = find_tree(&index->book_tree, &key);
+                if (old_borrow != NULL)
+                    remove_borrow(borrows, index, arena, old_borrow);
+            }
+            insert_borrow(borrows, index, borrow);
+        }
+    }
+
+    // 깨진 스냅샷의 일부만 쓰지 않고 텍스트 파일을 읽게 함
+    if (is_broken)
+    {
+        destroy_table(borrows);
+        destroy_borrow_index(index);
+        release_record_arena(arena);
+        unmap_snapshot(snapshot);
+        snapshot->need_rewrite = 1;
+    }
+}
+
+Book *create_book(RecordArena *arena, const BookIndex *index, const wchar_t *name, const wchar_t *publisher, const wchar_t *author, const uint64_t ISBN, const wchar_t *location)
+{
+    if (index->next_number > BOOK_NUMBER_MAX)
+        return NULL;
+
+    Book *book_p = allocate_record(arena);
+
+    book_p->name = create_arena_string(arena, name);
+    book_p->publisher = intern_arena_string(arena, publisher);
+    book_p->author = intern_arena_string(arena, author);
+    book_p->location = intern_arena_string(arena, location);
+    book_p->ISBN = ISBN;
+    book_p->availability = L'Y';
+    book_p->loan_count = 0;
+    book_p->dirty = 0;
+    book_p->snapshot_offset = 0;
+
+    book_p->number = index->next_number;
+
+    return book_p;
+}
+Borrow *create_borrow(RecordArena *arena, Client *client, Book *book)
+{
+    Borrow *borrow_p = allocate_record(arena);
+    borrow_p->loan_date = time(NULL);
+    struct tm *t;
+    t = localtime(&borrow_p->loan_date);
+
+    borrow_p->student_number = client->student_number;
+    borrow_p->book_number = book->number;
+
+    if ((t->tm_wday + 30) / 7 == 0) //(t->tm_wday+30)/7==30일 뒤의 요일
+        borrow_p->return_date = borrow_p->loan_date + 31 * 24 * 60 * 60;
+    else
+        borrow_p->return_date = borrow_p->loan_date + 30 * 24 * 60 * 60;
+    borrow_p->book_name = create_arena_text(arena, book->name);
+    borrow_p->dirty = 0;
+    borrow_p->snapshot_offset = 0;
+
+    return borrow_p;
+}
+
+Client *create_client(RecordArena *arena, const uint32_t student_number, const wchar_t *password, const wchar_t *name, const wchar_t *address, const uint64_t phone_number)
+{
+    Client *client_p = allocate_record(arena);
+
+    client_p->student_number = student_number;
+    client_p->phone_number = phone_number;
+    client_p->password = create_arena_string(arena, password);
+    client_p->name = create_arena_string(arena, name);
+    client_p->address = create_arena_string(arena, address);
+    client_p->dirty = 0;
+    client_p->snapshot_offset = 0;
+
+    return client_p;
+}
+void init_table(Table *table)
+{
+    memset(table, 0, sizeof(Table));
+}
+uint32_t insert_table(Table *table, void *record)
+{
+    uint32_t handle = 0;
+
+    // 지운 자리를 먼저 씀
+    if (table->free_count > 0)
+        handle = table->free_handles[--table->free_count];
+    else
+    {
+        handle = table->size++;
+        if ((handle >> TABLE_CHUNK_BITS) >= table->chunk_count)
+        {
+            table->chunks = realloc(table->chunks, sizeof(void **) * (table->chunk_count + 1));
+            table->chunks[table->chunk_count++] = malloc(sizeof(void *) * SIZE_TABLE_CHUNK);
+        }
+    }
+    table->chunks[handle >> TABLE_CHUNK_BITS][handle & (SIZE_TABLE_CHUNK - 1)] = record;
+    table->count++;
+
+    return handle;
+}
+void *get_table(const Table *table, const uint32_t handle)
+{
+    if (handle >= table->size)
+        return NULL;
+    return table->chunks[handle >> TABLE_CHUNK_BITS][handle & (SIZE_TABLE_CHUNK - 1)];
+}
+void remove_table(Table *table, const uint32_t handle)
+{
+    if (get_table(table, handle) == NULL)
+        return;
+
+    table->chunks[handle >> TABLE_CHUNK_BITS][handle & (SIZE_TABLE_CHUNK - 1)] = NULL;
+    table->count--;
+    if (table->free_count == table->free_capacity)
+    {
+        table->free_capacity = table->free_capacity == 0 ? 16 : table->free_capacity * 2;
+        table->free_handles = realloc(table->free_handles, sizeof(uint32_t) * table->free_capacity);
+    }
+    table->free_handles[table->free_count++] = handle;
+}
+void *next_table(const Table *table, size_t *position)
+{
+    void *const *chunk = NULL;
+    size_t end = 0;
+
+    // 청크 안에서는 빈 자리를 이어서 건너뜀
+    while (*position < table->size)
+    {
+        chunk = table->chunks[*position >> TABLE_CHUNK_BITS];
+        end = (*position | (SIZE_TABLE_CHUNK - 1)) + 1;
+        if (end > table->size)
+            end = table->size;
+        for (; *position < end; (*position)++)
+            if (chunk[*position & (SIZE_TABLE_CHUNK - 1)] != NULL)
+                return chunk[(*position)++ & (SIZE_TABLE_CHUNK - 1)];
+    }
+    return NULL;
+}
+void destroy_table(Table *table)
+{
+    for (size_t i = 0; i < table->chunk_count; i++)
+        free(table->chunks[i]);
+    free(table->chunks);
+    free(table->free_handles);
+    init_table(table);
+}
+void init_record_arena(RecordArena *arena, const size_t record_size)
+{
+    memset(arena, 0, sizeof(RecordArena));
+    // 지운 레코드에 다음 포인터를 넣으므로 포인터보다 작으면 안 됨
+    arena->record_size = record_size < sizeof(void *) ? sizeof(void *) : record_size;
+    arena->record_size = (arena->record_size + SIZE_ARENA_ALIGN - 1) & ~(size_t)(SIZE_ARENA_ALIGN - 1);
+}
+void *allocate_arena(RecordArena *arena, ArenaChunk **chunks, size_t size)
+{
+    ArenaChunk *chunk = *chunks;
+
+    if (size > SIZE_ARENA_CHUNK / 4)
+    {
+        // 큰 메모리는 따로 청크를 만들고, 지금 청크는 계속 씀
+        chunk = malloc(sizeof(ArenaChunk) + size);
+        chunk->size = size;
+        chunk->used = size;
+        if (*chunks != NULL)
+        {
+            chunk->next = (*chunks)->next;
+            (*chunks)->next = chunk;
+        }
+        else
+        {
+            chunk->next = NULL;
+            *chunks = chunk;
+        }
+        arena->chunk_bytes += size;
+        return chunk + 1;
+    }
+    if (chunk == NULL || chunk->used + size > chunk->size)
+    {
+        chunk = malloc(sizeof(ArenaChunk) + SIZE_ARENA_CHUNK);
+        chunk->size = SIZE_ARENA_CHUNK;
+        chunk->used = 0;
+        chunk->next = *chunks;
+        *chunks = chunk;
+        arena->chunk_bytes += SIZE_ARENA_CHUNK;
+    }
+
+    void *memory = (char *)(chunk + 1) + chunk->used;
+    chunk->used += size;
+    return memory;
+}
+void *allocate_record(RecordArena *arena)
+{
+    void *record = arena->free_records;
+
+    if (record != NULL)
+        arena->free_records = *(void **)record;
+    else
+        record = allocate_arena(arena, &arena->record_chunks, arena->record_size);
+    arena->record_count++;
+    return record;
+}
+void free_record(RecordArena *arena, void *record)
+{
+    if (record == NULL)
+        return;
+
+    *(void **)record = arena->free_records;
+    arena->free_records = record;
+    arena->record_count--;
+}
+char *create_arena_string(RecordArena *arena, const wchar_t *string)
+{
+    const size_t size = get_text_size(string) + 1;
+    char *text = allocate_arena(arena, &arena->string_chunks, size);
+    encode_text(string, text, size);
+
+    return text;
+}
+char *create_arena_text(RecordArena *arena, const char *text)
+{
+    const size_t size = strlen(text) + 1;
+    char *text_p = allocate_arena(arena, &arena->string_chunks, size);
+    memcpy(text_p, text, size);
+
+    return text_p;
+}
+char *create_arena_string_by_field(RecordArena *arena, const FieldView *field)
+{
+    // 파일도 UTF-8이므로 변환 없이 복사함, set_utf8_locale 참고
+    char *text = allocate_arena(arena, &arena->string_chunks, field->size + 1);
+    memcpy(text, field->text, field->size);
+    text[field->size] = '\0';
+
+    return text;
+}
+void free_arena_string(RecordArena *arena, char *text)
+{
+    const size_t size = strlen(text) + 1;
+    ArenaChunk *chunk = arena->string_chunks;
+
+    // 지금 청크의 마지막 할당일 때만 돌려줌
+    if (chunk != NULL && text + size == (char *)(chunk + 1) + chunk->used)
+        chunk->used -= size;
+}
+void release_record_arena(RecordArena *arena)
+{
+    ArenaChunk *chunk = NULL;
+    ArenaChunk *chunk_lists[2] = {arena->record_chunks, arena->string_chunks};
+
+    for (int i = 0; i < 2; i++)
+        while (chunk_lists[i] != NULL)
+        {
+            chunk = chunk_lists[i];
+            chunk_lists[i] = chunk->next;
+            free(chunk);
+        }
+    destroy_symbol_table(&arena->symbols);
+    init_record_arena(arena, arena->record_size);
+}
+char *intern_arena_text(RecordArena *arena, const char *text, const _Bool is_copied)
+{
+    if (text == NULL)
+        return NULL;
+
+    const uint64_t hash = get_term_hash(text);
+    const Symbol *symbol = find_symbol(&arena->symbols, text, hash);
+    if (symbol == NULL)
+        symbol = insert_symbol(&arena->symbols, is_copied ? create_arena_text(arena, text) : text, hash);
+    return (char *)symbol->string;
+}
+char *intern_arena_string(RecordArena *arena, const wchar_t *string)
+{
+    char *text = create_arena_string(arena, string);
+    char *interned = intern_arena_text(arena, text, 0);
+
+    // 이미 있는 문자열이면 방금 만든 문자열을 돌려줌
+    if (interned != text)
+        free_arena_string(arena, text);
+    return interned;
+}
+char *intern_arena_string_by_field(RecordArena *arena, const FieldView *field)
+{
+    char *text = create_arena_string_by_field(arena, field);
+    char *interned = intern_arena_text(arena, text, 0);
+
+    if (interned != text)
+        free_arena_string(arena, text);
+    return interned;
+}
+Symbol *find_symbol(const SymbolTable *table, const char *string, const uint64_t hash)
+{
+    if (table->count == 0)
+        return NULL;
+
+    const size_t mask = table->capacity - 1;
+    for (size_t position = hash & mask; table->slots[position].string != NULL; position = (position + 1) & mask)
+        if (table->slots[position].hash == hash && strcmp(table->slots[position].string, string) == 0)
+            return &table->slots[position];
+    return NULL;
+}
+Symbol *insert_symbol(SymbolTable *table, const char *string, const uint64_t hash)
+{
+    // 절반 이상 차면 늘림
+    if ((table->count + 1) * 2 > table->capacity)
+        resize_symbol_table(table, table->capacity == 0 ? SIZE_SYMBOL_TABLE_MIN : table->capacity * 2);
+
+    const size_t mask = table->capacity - 1;
+    size_t position = hash & mask;
+    while (table->slots[position].string != NULL)
+        position = (position + 1) & mask;
+
+    table->slots[position].hash = hash;
+    table->slots[position].string = string;
+    table->slots[position].id = table->count++;
+    return &table->slots[position];
+}
+void resize_symbol_table(SymbolTable *table, const size_t capacity)
+{
+    Symbol *old_slots = table->slots;
+    const size_t old_capacity = table->capacity;
+    const size_t mask = capacity - 1;
+    size_t position = 0;
+
+    table->slots = calloc(capacity, sizeof(Symbol));
+    table->capacity = capacity;
+    for (size_t i = 0; i < old_capacity; i++)
+    {
+        if (old_slots[i].string == NULL)
+            continue;
+        for (position = old_slots[i].hash & mask; table->slots[position].string != NULL; position = (position + 1) & mask)
+            ;
+        table->slots[position] = old_slots[i];
+    }
+    free(old_slots);
+}
+void destroy_symbol_table(SymbolTable *table)
+{
+    free(table->slots);
+    memset(table, 0, sizeof(SymbolTable));
+}
+
+void print_client(const Client *client)
+{
+    // admin이였을 때는 출력 하지 않음.
+    if (client->student_number == STUDENT_NUMBER_ADMIN)
+        return;
+    wchar_t phone_number[SIZE_PHONE_NUMBER + 1];
+    format_phone_number(client->phone_number, phone_number);
+    wprintf(
+        L"학번 : %08u \n"
+        L"이름 : %s \n"
+        L"전화번호 : %ls \n"
+        L"주소 : %s \n",
+        client->student_number, client->name, phone_number, client->address);
+}
+void print_book(const Book *book)
+{
+    wchar_t ISBN[SIZE_ISBN + 1];
+    format_ISBN(book->ISBN, ISBN);
+    wprintf(
+        L"도서명 : %s \n"
+        L"출판사 : %s \n"
+        L"저자명 : %s \n"
+        L"ISBN : %ls \n"
+        L"소장처 : %s \n"
+        L"대여가능 여부 : %lc \n",
+        book->name, book->publisher, book->author, ISBN, book->location, book->availability);
+}
+void print_borrow(const Borrow *borrow)
+{
+    struct tm *t;
+
+    t = localtime(&(borrow->loan_date));
+
+    wprintf(
+        L"도서번호 : %07u \n"
+        L"도서명 : %s \n"
+        L"대여일자 : %d년 %d월 %d일 ",
+        borrow->book_number, borrow->book_name, t->tm_year + 1900, t->tm_mon + 1, t->tm_mday);
+
+    switch (t->tm_wday)
+    {
+    case 0:
+        wprintf(L"일요일\n");
+        break;
+    case 1:
+        wprintf(L"월요일\n");
+        break;
+    case 2:
+        wprintf(L"화요일\n");
+        break;
+    case 3:
+        wprintf(L"수요일\n");
+        break;
+    case 4:
+        wprintf(L"목요일\n");
+        break;
+    case 5:
+        wprintf(L"금요일\n");
+        break;
+    case 6:
+        wprintf(L"토요일\n");
+        break;
+    default:
+        break;
+    }
+    t = localtime(&(borrow->return_date));
+    wprintf(L"반납일자 : %d년 %d월 %d일 ", t->tm_year + 1900, t->tm_mon + 1, t->tm_mday);
+    switch (t->tm_wday)
+    {
+    case 0:
+        wprintf(L"일요일\n");
+        break;
+    case 1:
+        wprintf(L"월요일\n");
+        break;
+    case 2:
+        wprintf(L"화요일\n");
+        break;
+    case 3:
+        wprintf(L"수요일\n");
+        break;
+    case 4:
+        wprintf(L"목요일\n");
+        break;
+    case 5:
+        wprintf(L"금요일\n");
+        break;
+    case 6:
+        wprintf(L"토요일\n");
+        break;
+    default:
+        break;
+    }
+}
+void print_clients(const ClientIndex *index)
+{
+    TreeCursor cursor;
+    const TreeKey key = {0, 0};
+    void *client = NULL;
+
+    for (seek_tree(&index->number_tree, &key, &cursor); next_tree(&cursor, NULL, &client);)
+    {
+        wprintf(L"\n");
+        print_client(client);
+    }
+    return;
+}
+void print_books(BookCursor *cursor)
+{
+    const Book *book = NULL;
+    while ((book = next_book_cursor(cursor)) != NULL)
+    {
+        wprintf(L"\n");
+        print_book(book);
+    }
+    return;
+}
+void print_borrows(BorrowCursor *cursor)
+{
+    const Borrow *borrow = NULL;
+    while ((borrow = next_borrow_cursor(cursor)) != NULL)
+    {
+        wprintf(L"\n");
+        print_borrow(borrow);
+    }
+    return;
+}
+
+void save_clients(const ClientIndex *index, const char *file_name)
+{
+    FILE *file = NULL;
+    file = fopen(file_name, "w");
+    if (file == NULL)
+        return;
+
+    TreeCursor cursor;
+    const TreeKey key = {0, 0};
+    void *value = NULL;
+    Client *client = NULL;
+    wchar_t student_number[SIZE_STUDENT_NUMBER + 1];
+    wchar_t phone_number[SIZE_PHONE_NUMBER + 1];
+
+    for (seek_tree(&index->number_tree, &key, &cursor); next_tree(&cursor, NULL, &value);)
+    {
+        client = value;
+        format_student_number(client->student_number, student_number);
+        format_phone_number(client->phone_number, phone_number);
+        fwprintf(file,
+            L"%ls | %s | %s | %s | %ls | ",
+            student_number, client->password, client->name, client->address, phone_number);
+    }
+    fclose(file);
+}
+void save_books(const BookIndex *index, const char *file_name)
+{
+    FILE *file = NULL;
+    file = fopen(file_name, "w");
+    if (file == NULL)
+        return;
+
+    TreeCursor cursor;
+    const TreeKey key = {0, 0};
+    void *value = NULL;
+    Book *book = NULL;
+    wchar_t ISBN[SIZE_ISBN + 1];
+
+    for (seek_tree(&index->ISBN_tree, &key, &cursor); next_tree(&cursor, NULL, &value);)
+    {
+        book = value;
+        format_ISBN(book->ISBN, ISBN);
+        fwprintf(file,
+            L"%07u | %s | %s | %s | %ls | %s | %lc | ",
+            book->number, book->name, book->publisher, book->author, ISBN, book->location, book->availability);
+    }
+    fclose(file);
+}
+void save_borrows(const Table *borrows, const char *file_name)
+{
+    FILE *file = NULL;
+    file = fopen(file_name, "w");
+    if (file == NULL)
+        return;
+
+    Borrow *borrow = NULL;
+    wchar_t student_number[SIZE_STUDENT_NUMBER + 1];
+
+    for (size_t position = 0; (borrow = next_table(borrows, &position)) != NULL;)
+    {
+        format_student_number(borrow->student_number, student_number);
+        fwprintf(file,
+            L"%ls | %s | %07u | %lld | %lld | ",
+            student_number, borrow->book_name, borrow->book_number, (long long)(borrow->loan_date), (long long)(borrow->return_date));
+    }
+    fclose(file);
+}
+
+void save_clients_snapshot(const ClientIndex *index, const char *file_name)
+{
+    SnapshotHeader header;
+    FILE *file = open_snapshot_file(file_name, &header, SNAPSHOT_CLIENT, sizeof(ClientRecord));
+    if (file == NULL)
+        return;
+
+    Client **clients = malloc(sizeof(Client *) * (index->number_tree.count + 1));
+    header.record_count = get_tree_values(&index->number_tree, (void **)clients);
+    header.file_size = write_clients_segment(file, clients, header.record_count, sizeof(SnapshotHeader));
+    header.segment_count = 1;
+    free(clients);
+
+    close_snapshot_file(file, file_name, &header);
+}
+void save_books_snapshot(const BookIndex *index, const char *file_name)
+{
+    SnapshotHeader header;
+    FILE *file = open_snapshot_file(file_name, &header, SNAPSHOT_BOOK, sizeof(BookRecord));
+    if (file == NULL)
+        return;
+    header.next_key = index->next_number;
+
+    Book **books = malloc(sizeof(Book *) * (index->ISBN_tree.count + 1));
+    header.record_count = get_tree_values(&index->ISBN_tree, (void **)books);
+    header.file_size = write_books_segment(file, books, header.record_count, sizeof(SnapshotHeader));
+    header.segment_count = 1;
+    free(books);
+
+    close_snapshot_file(file, file_name, &header);
+}
+void save_borrows_snapshot(const Table *borrows, const char *file_name)
+{
+    SnapshotHeader header;
+    FILE *file = open_snapshot_file(file_name, &header, SNAPSHOT_BORROW, sizeof(BorrowRecord));
+    if (file == NULL)
+        return;
+
+    Borrow **records = malloc(sizeof(Borrow *) * (borrows->count + 1));
+    Borrow *borrow = NULL;
+    for (size_t position = 0; (borrow = next_table(borrows, &position)) != NULL;)
+        records[header.record_count++] = borrow;
+    header.file_size = write_borrows_segment(file, records, header.record_count, sizeof(SnapshotHeader));
+    header.segment_count = 1;
+    free(records);
+
+    close_snapshot_file(file, file_name, &header);
+}
+
+int append_clients_snapshot(Snapshot *snapshot, const char *file_name)
+{
+    SnapshotHeader header;
+    FILE *file = open_snapshot_to_append(file_name, &header, SNAPSHOT_CLIENT, sizeof(ClientRecord));
+    if (file == NULL)
+        return EOF;
+
+    uint64_t append_count = 0;
+    Client *client = NULL;
+    ClientRecord record;
+
+    for (const LinkedList *current = snapshot->dirty_list; current != NULL; current = current->next)
+    {
+        client = current->contents;
+        if (!(client->dirty & (DIRTY_INSERTED | DIRTY_STRINGS)))
+            continue;
+        // 문자열이 바뀐 회원은 새 세그먼트에 다시 쓰고, 이전 레코드는 지움
+        if (client->snapshot_offset != 0)
+            mark_removed(snapshot, NULL, client->snapshot_offset, 0);
+        append_count++;
+    }
+    if (!can_append_snapshot(&header, snapshot, append_count))
+    {
+        fclose(file);
+        return EOF;
+    }
+
+    // 바뀐 순서대로 쓰도록 뒤에서부터 채움
+    Client **clients = malloc(sizeof(Client *) * (append_count + 1));
+    size_t position = append_count;
+    for (const LinkedList *current = snapshot->dirty_list; current != NULL; current = current->next)
+        if (((Client *)current->contents)->dirty & (DIRTY_INSERTED | DIRTY_STRINGS))
+            clients[--position] = current->contents;
+
+    int result = 0;
+    if (append_count > 0)
+    {
+        header.file_size = write_clients_segment(file, clients, append_count, header.file_size);
+        header.segment_count++;
+        header.record_count += append_count;
+        result = sync_snapshot_file(file, &header);
+    }
+    free(clients);
+
+    for (const LinkedList *current = snapshot->dirty_list; current != NULL && result != EOF; current = current->next)
+    {
+        client = current->contents;
+        if (client->dirty & DIRTY_PHONE_NUMBER)
+        {
+            memset(&record, 0, sizeof(record));
+            record.phone_number = client->phone_number;
+            write_snapshot_field(file, client->snapshot_offset + offsetof(ClientRecord, phone_number), &record.phone_number, sizeof(record.phone_number));
+        }
+        client->dirty = 0;
+    }
+    if (result != EOF)
+        result = write_snapshot_removed(file, snapshot, &header, offsetof(ClientRecord, is_removed));
+
+    if (fclose(file) != 0)
+        result = EOF;
+    return result;
+}
+int append_books_snapshot(Snapshot *snapshot, const uint32_t next_number, const char *file_name)
+{
+    SnapshotHeader header;
+    FILE *file = open_snapshot_to_append(file_name, &header, SNAPSHOT_BOOK, sizeof(BookRecord));
+    if (file == NULL)
+        return EOF;
+    header.next_key = next_number;
+
+    uint64_t append_count = 0;
+    Book *book = NULL;
+
+    for (const LinkedList *current = snapshot->dirty_list; current != NULL; current = current->next)
+    {
+        book = current->contents;
+        if (!(book->dirty & (DIRTY_INSERTED | DIRTY_STRINGS)))
+            continue;
+        if (book->snapshot_offset != 0)
+            mark_removed(snapshot, NULL, book->snapshot_offset, 0);
+        append_count++;
+    }
+    if (!can_append_snapshot(&header, snapshot, append_count))
+    {
+        fclose(file);
+        return EOF;
+    }
+
+    Book **books = malloc(sizeof(Book *) * (append_count + 1));
+    size_t position = append_count;
+    for (const LinkedList *current = snapshot->dirty_list; current != NULL; current = current->next)
+        if (((Book *)current->contents)->dirty & (DIRTY_INSERTED | DIRTY_STRINGS))
+            books[--position] = current->contents;
+
+    int result = 0;
+    if (append_count > 0)
+    {
+        header.file_size = write_books_segment(file, books, append_count, header.file_size);
+        header.segment_count++;
+        header.record_count += append_count;
+        result = sync_snapshot_file(file, &header);
+    }
+    free(books);
+
+    for (const LinkedList *current = snapshot->dirty_list; current != NULL && result != EOF; current = current->next)
+    {
+        book = current->contents;
+        if (book->dirty & DIRTY_AVAILABILITY)
+            write_snapshot_field(file, book->snapshot_offset + offsetof(BookRecord, availability), &book->availability, sizeof(book->availability));
+        if (book->dirty & DIRTY_LOAN_COUNT)
+            write_snapshot_field(file, book->snapshot_offset + offsetof(BookRecord, loan_count), &book->loan_count, sizeof(book->loan_count));
+        book->dirty = 0;
+    }
+    if (result != EOF)
+        result = write_snapshot_removed(file, snapshot, &header, offsetof(BookRecord, is_removed));
+
+    if (fclose(file) != 0)
+        result = EOF;
+    return result;
+}
+int append_borrows_snapshot(Snapshot *snapshot, const char *file_name)
+{
+    SnapshotHeader header;
+    FILE *file = open_snapshot_to_append(file_name, &header, SNAPSHOT_BORROW, sizeof(BorrowRecord));
+    if (file == NULL)
+        return EOF;
+
+    uint64_t append_count = 0;
+    Borrow *borrow = NULL;
+
+    for (const LinkedList *current = snapshot->dirty_list; current != NULL; current = current->next)
+    {
+        borrow = current->contents;
+        if (!(borrow->dirty & (DIRTY_INSERTED | DIRTY_STRINGS)))
+            continue;
+        if (borrow->snapshot_offset != 0)
+            mark_removed(snapshot, NULL, borrow->snapshot_offset, 0);
+        append_count++;
+    }
+    if (!can_append_snapshot(&header, snapshot, append_count))
+    {
+        fclose(file);
+        return EOF;
+    }
+
+    Borrow **borrows = malloc(sizeof(Borrow *) * (append_count + 1));
+    size_t position = append_count;
+    for (const LinkedList *current = snapshot->dirty_list; current != NULL; current = current->next)
+        if (((Borrow *)current->contents)->dirty & (DIRTY_INSERTED | DIRTY_STRINGS))
+            borrows[--position] = current->contents;
+
+    int result = 0;
+    if (append_count > 0)
+    {
+        header.file_size = write_borrows_segment(file, borrows, append_count, header.file_size);
+        header.segment_count++;
+        header.record_count += append_count;
+        result = sync_snapshot_file(file, &header);
+    }
+    free(borrows);
+
+    for (const LinkedList *current = snapshot->dirty_list; current != NULL; current = current->next)
+        ((Borrow *)current->contents)->dirty = 0;
+    if (result != EOF)
+        result = write_snapshot_removed(file, snapshot, &header, offsetof(BorrowRecord, is_removed));
+
+    if (fclose(file) != 0)
+        result = EOF;
+    return result;
+}
+
+uint64_t write_clients_segment(FILE *file, Client *const *clients, const size_t count, const uint64_t offset)
+{
+    SnapshotSegmentHeader segment;
+    Client *client = NULL;
+    ClientRecord record;
+    uint64_t string_offset = 0;
+    uint64_t record_offset = offset + sizeof(SnapshotSegmentHeader);
+
+    memset(&segment, 0, sizeof(segment));
+    for (size_t i = 0; i < count; i++)
+    {
+        client = clients[i];
+        segment.record_count++;
+        segment.string_size += get_snapshot_string_size(client->password) + get_snapshot_string_size(client->name) + get_snapshot_string_size(client->address);
+    }
+    fseek(file, offset, SEEK_SET);
+    fwrite(&segment, sizeof(segment), 1, file);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        client = clients[i];
+        memset(&record, 0, sizeof(record));
+        record.student_number = client->student_number;
+        record.phone_number = client->phone_number;
+        record.password = string_offset;
+        string_offset += get_snapshot_string_size(client->password);
+        record.name = string_offset;
+        string_offset += get_snapshot_string_size(client->name);
+        record.address = string_offset;
+        string_offset += get_snapshot_string_size(client->address);
+
+        fwrite(&record, sizeof(record), 1, file);
+        client->snapshot_offset = record_offset;
+        client->dirty = 0;
+        record_offset += sizeof(record);
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+        client = clients[i];
+        write_snapshot_string(file, client->password);
+        write_snapshot_string(file, client->name);
+        write_snapshot_string(file, client->address);
+    }
+
+    // 다음 세그먼트가 8바이트 단위로 정렬되도록 채움
+    const uint64_t end = record_offset + segment.string_size;
+    const uint64_t padding = (8 - end % 8) % 8;
+    fwrite("\0\0\0\0\0\0\0", 1, padding, file);
+
+    return end + padding;
+}
+uint64_t write_books_segment(FILE *file, Book *const *books, const size_t count, const uint64_t offset)
+{
+    SnapshotSegmentHeader segment;
+    SymbolTable symbols;
+    Book *book = NULL;
+    BookRecord record;
+    uint64_t string_offset = 0;
+    uint64_t record_offset = offset + sizeof(SnapshotSegmentHeader);
+
+    memset(&segment, 0, sizeof(segment));
+    memset(&symbols, 0, sizeof(symbols));
+    // 출판사, 저자, 위치는 처음 나올 때만 문자열 표에 넣음
+    for (size_t i = 0; i < count; i++)
+    {
+        book = books[i];
+        segment.record_count++;
+        string_offset += get_snapshot_string_size(book->name);
+        put_snapshot_symbol(&symbols, book->publisher, &string_offset);
+        put_snapshot_symbol(&symbols, book->author, &string_offset);
+        put_snapshot_symbol(&symbols, book->location, &string_offset);
+    }
+    segment.string_size = string_offset;
+    string_offset = 0;
+    fseek(file, offset, SEEK_SET);
+    fwrite(&segment, sizeof(segment), 1, file);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        book = books[i];
+        memset(&record, 0, sizeof(record));
+        record.number = book->number;
+        record.ISBN = book->ISBN;
+        record.availability = book->availability;
+        record.loan_count = book->loan_count;
+        record.name = string_offset;
+        string_offset += get_snapshot_string_size(book->name);
+        record.publisher = put_snapshot_symbol(&symbols, book->publisher, &string_offset);
+        record.author = put_snapshot_symbol(&symbols, book->author, &string_offset);
+        record.location = put_snapshot_symbol(&symbols, book->location, &string_offset);
+
+        fwrite(&record, sizeof(record), 1, file);
+        book->snapshot_offset = record_offset;
+        book->dirty = 0;
+        record_offset += sizeof(record);
+    }
+    string_offset = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        book = books[i];
+        write_snapshot_string(file, book->name);
+        string_offset += get_snapshot_string_size(book->name);
+        const char *strings[3] = {book->publisher, book->author, book->location};
+        for (int i = 0; i < 3; i++)
+        {
+            // 이 자리에서 처음 나온 문자열만 씀(같은 책에 같은 문자열이 또 나와도 한 번만)
+            const uint64_t symbol_offset = string_offset;
+            if (put_snapshot_symbol(&symbols, strings[i], &string_offset) == symbol_offset)
+                write_snapshot_string(file, strings[i]);
+        }
+    }
+    destroy_symbol_table(&symbols);
+
+    const uint64_t end = record_offset + segment.string_size;
+    const uint64_t padding = (8 - end % 8) % 8;
+    fwrite("\0\0\0\0\0\0\0", 1, padding, file);
+
+    return end + padding;
+}
+uint64_t write_borrows_segment(FILE *file, Borrow *const *borrows, const size_t count, const uint64_t offset)
+{
+    SnapshotSegmentHeader segment;
+    Borrow *borrow = NULL;
+    BorrowRecord record;
+    uint64_t string_offset = 0;
+    uint64_t record_offset = offset + sizeof(SnapshotSegmentHeader);
+
+    memset(&segment, 0, sizeof(segment));
+    for (size_t i = 0; i < count; i++)
+    {
+        borrow = borrows[i];
+        segment.record_count++;
+        segment.string_size += get_snapshot_string_size(borrow->book_name);
+    }
+    fseek(file, offset, SEEK_SET);
+    fwrite(&segment, sizeof(segment), 1, file);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        borrow = borrows[i];
+        memset(&record, 0, sizeof(record));
+        record.student_number = borrow->student_number;
+        record.book_number = borrow->book_number;
+        record.book_name = string_offset;
+        string_offset += get_snapshot_string_size(borrow->book_name);
+        record.loan_date = (int64_t)borrow->loan_date;
+        record.return_date = (int64_t)borrow->return_date;
+
+        fwrite(&record, sizeof(record), 1, file);
+        borrow->snapshot_offset = record_offset;
+        borrow->dirty = 0;
+        record_offset += sizeof(record);
+    }
+    for (size_t i = 0; i < count; i++)
+        write_snapshot_string(file, borrows[i]->book_name);
+
+    const uint64_t end = record_offset + segment.string_size;
+    const uint64_t padding = (8 - end % 8) % 8;
+    fwrite("\0\0\0\0\0\0\0", 1, padding, file);
+
+    return end + padding;
+}
+
+const SnapshotHeader *map_snapshot(const char *file_name, const uint32_t type, const size_t record_size, Snapshot *snapshot)
+{
+    memset(snapshot, 0, sizeof(Snapshot));
+    snapshot->need_rewrite = 1;
+
+    int file = open(file_name, O_RDONLY);
+    if (file < 0)
+        return NULL;
+
+    struct stat file_stat;
+    if (fstat(file, &file_stat) != 0 || (size_t)file_stat.st_size < sizeof(SnapshotHeader))
+    {
+        close(file);
+        return NULL;
+    }
+
+    void *address = mmap(NULL, file_stat.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if (address == MAP_FAILED)
+        return NULL;
+
+    const SnapshotHeader *header = address;
+    if (memcmp(header->magic, STRING_SNAPSHOT_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != get_snapshot_version(type) ||
+        header->type != type ||
+        header->wchar_size != sizeof(wchar_t) ||
+        header->record_size != record_size ||
+        header->file_size > (uint64_t)file_stat.st_size)
+    {
+        munmap(address, file_stat.st_size);
+        return NULL;
+    }
+
+    snapshot->address = address;
+    snapshot->size = file_stat.st_size;
+    snapshot->need_rewrite = 0;
+
+    return header;
+}
+int get_snapshot_segment(const SnapshotHeader *header, uint64_t *offset, SnapshotSegment *segment)
+{
+    const SnapshotSegmentHeader *segment_header = NULL;
+    uint64_t position = *offset;
+
+    if (position % 8 != 0 || position > header->file_size || header->file_size - position < sizeof(SnapshotSegmentHeader))
+        return EOF;
+    segment_header = (const SnapshotSegmentHeader *)((const char *)header + position);
+    position += sizeof(SnapshotSegmentHeader);
+
+    if (segment_header->record_count > (header->file_size - position) / header->record_size)
+        return EOF;
+    segment->records = (const char *)header + position;
+    segment->record_count = segment_header->record_count;
+    position += segment_header->record_count * header->record_size;
+
+    // 문자열 테이블은 항상 NUL로 끝나야 함
+    if (segment_header->string_size > header->file_size - position)
+        return EOF;
+    segment->strings = (const char *)header + position;
+    segment->string_size = segment_header->string_size;
+    if (segment->string_size > 0 && segment->strings[segment->string_size - 1] != '\0')
+        return EOF;
+    position += segment_header->string_size;
+
+    *offset = position + (8 - position % 8) % 8;
+    return 0;
+}
+uint64_t put_snapshot_symbol(SymbolTable *symbols, const char *string, uint64_t *string_offset)
+{
+    if (string == NULL)
+        string = "";
+
+    const uint64_t hash = get_term_hash(string);
+    Symbol *symbol = find_symbol(symbols, string, hash);
+    if (symbol == NULL)
+    {
+        symbol = insert_symbol(symbols, string, hash);
+        symbol->id = *string_offset;
+    }
+    // 뒤에 나온 같은 문자열은 앞의 오프셋보다 항상 작음
+    if (symbol->id == *string_offset)
+        *string_offset += get_snapshot_string_size(string);
+    return symbol->id;
+}
+char *get_snapshot_string(const SnapshotSegment *segment, const uint64_t offset)
+{
+    if (offset >= segment->string_size)
+        return NULL;
+
+    return (char *)segment->strings + offset;
+}
+uint32_t get_snapshot_version(const uint32_t type)
+{
+    return type == SNAPSHOT_HISTORY ? HISTORY_VERSION : SNAPSHOT_VERSION;
+}
+void unmap_snapshot(Snapshot *snapshot)
+{
+    if (snapshot->address != NULL)
+        munmap(snapshot->address, snapshot->size);
+    snapshot->address = NULL;
+    snapshot->size = 0;
+    clear_snapshot_changes(snapshot);
+    free(snapshot->removed_offsets);
+    snapshot->removed_offsets = NULL;
+    snapshot->removed_capacity = 0;
+}
+FILE *open_snapshot_file(const char *file_name, SnapshotHeader *header, const uint32_t type, const size_t record_size)
+{
+    char temp_name[FILENAME_MAX];
+    snprintf(temp_name, sizeof(temp_name), "%s%s", file_name, STRING_TEMP_EXTENSION);
+
+    FILE *file = fopen(temp_name, "wb");
+    if (file == NULL)
+        return NULL;
+
+    memset(header, 0, sizeof(SnapshotHeader));
+    memcpy(header->magic, STRING_SNAPSHOT_MAGIC, sizeof(header->magic));
+    header->version = get_snapshot_version(type);
+    header->type = type;
+    header->wchar_size = sizeof(wchar_t);
+    header->record_size = record_size;
+    header->file_size = sizeof(SnapshotHeader);
+
+    // 헤더는 마지막에 씀
+    fwrite(header, sizeof(SnapshotHeader), 1, file);
+
+    return file;
+}
+FILE *open_snapshot_to_append(const char *file_name, SnapshotHeader *header, const uint32_t type, const size_t record_size)
+{
+    FILE *file = fopen(file_name, "r+b");
+    if (file == NULL)
+        return NULL;
+
+    if (fread(header, sizeof(SnapshotHeader), 1, file) != 1 ||
+        memcmp(header->magic, STRING_SNAPSHOT_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != get_snapshot_version(type) ||
+        header->type != type ||
+        header->wchar_size != sizeof(wchar_t) ||
+        header->record_size != record_size ||
+        header->file_size % 8 != 0)
+    {
+        fclose(file);
+        return NULL;
+    }
+
+    return file;
+}
+_Bool can_append_snapshot(const SnapshotHeader *header, const Snapshot *snapshot, const uint64_t append_count)
+{
+    if (append_count > 0 && header->segment_count >= SNAPSHOT_SEGMENT_MAX)
+        return 0;
+    // 지워진 레코드가 절반을 넘으면 다시 씀
+    if ((header->removed_count + snapshot->removed_count) * 2 > header->record_count + append_count)
+        return 0;
+
+    return 1;
+}
+void write_snapshot_field(FILE *file, const uint64_t offset, const void *field, const size_t size)
+{
+    fseek(file, offset, SEEK_SET);
+    fwrite(field, 1, size, file);
+}
+int write_snapshot_removed(FILE *file, const Snapshot *snapshot, SnapshotHeader *header, const size_t field_offset)
+{
+    const uint32_t is_removed = 1;
+
+    for (size_t i = 0; i < snapshot->removed_count; i++)
+        write_snapshot_field(file, snapshot->removed_offsets[i] + field_offset, &is_removed, sizeof(is_removed));
+    header->removed_count += snapshot->removed_count;
+
+    return sync_snapshot_file(file, header);
+}
+int sync_snapshot_file(FILE *file, const SnapshotHeader *header)
+{
+    if (fflush(file) != 0 || fsync(fileno(file)) != 0)
+        return EOF;
+    fseek(file, 0, SEEK_SET);
+    fwrite(header, sizeof(SnapshotHeader), 1, file);
+    if (fflush(file) != 0 || fsync(fileno(file)) != 0)
+        return EOF;
+
+    return 0;
+}
+void write_snapshot_string(FILE *file, const char *string)
+{
+    if (string == NULL)
+        fwrite("", 1, 1, file);
+    else
+        fwrite(string, 1, get_snapshot_string_size(string), file);
+}
+void close_snapshot_file(FILE *file, const char *file_name, SnapshotHeader *header)
+{
+    char temp_name[FILENAME_MAX];
+    snprintf(temp_name, sizeof(temp_name), "%s%s", file_name, STRING_TEMP_EXTENSION);
+
+    fseek(file, 0, SEEK_SET);
+    fwrite(header, sizeof(SnapshotHeader), 1, file);
+    // 이름을 바꾸기 전에 내용이 디스크에 있어야 함
+    if (fflush(file) != 0 || fsync(fileno(file)) != 0)
+    {
+        fclose(file);
+        remove(temp_name);
+        return;
+    }
+    if (fclose(file) != 0)
+    {
+        remove(temp_name);
+        return;
+    }
+    if (rename(temp_name, file_name) != 0)
+        return;
+
+    int directory = open(".", O_RDONLY);
+    if (directory >= 0)
+    {
+        fsync(directory);
+        close(directory);
+    }
+}
+uint64_t get_snapshot_string_size(const char *string)
+{
+    if (string == NULL)
+        return 1;
+    return strlen(string) + 1;
+}
+
+void mark_dirty(Snapshot *snapshot, void *record, unsigned char *dirty, const unsigned char flags)
+{
+    if (*dirty == 0)
+    {
+        LinkedList *node = malloc(sizeof(LinkedList));
+        node->contents = record;
+        node->next = snapshot->dirty_list;
+        snapshot->dirty_list = node;
+    }
+    *dirty |= flags;
+}
+void mark_removed(Snapshot *snapshot, void *record, const uint64_t snapshot_offset, const unsigned char dirty)
+{
+    if (dirty != 0)
+    {
+        LinkedList *pre_node = NULL;
+        for (LinkedList *current = snapshot->dirty_list; current != NULL; current = current->next)
+        {
+            if (current->contents != record)
+            {
+                pre_node = current;
+                continue;
+            }
+            if (pre_node != NULL)
+                pre_node->next = current->next;
+            else
+                snapshot->dirty_list = current->next;
+            free(current);
+            break;
+        }
+    }
+    if (snapshot_offset == 0)
+        return;
+
+    if (snapshot->removed_count == snapshot->removed_capacity)
+    {
+        snapshot->removed_capacity = snapshot->removed_capacity == 0 ? 16 : snapshot->removed_capacity * 2;
+        snapshot->removed_offsets = realloc(snapshot->removed_offsets, sizeof(uint64_t) * snapshot->removed_capacity);
+    }
+    snapshot->removed_offsets[snapshot->removed_count++] = snapshot_offset;
+}
+void clear_snapshot_changes(Snapshot *snapshot)
+{
+    destroy_list(snapshot->dirty_list);
+    snapshot->dirty_list = NULL;
+    snapshot->removed_count = 0;
+    snapshot->need_rewrite = 0;
+}
+
+void insert_client(Table *clients, ClientIndex *index, Client *client)
+{
+    if (client == NULL)
+        return;
+    client->handle = insert_table(clients, client);
+    insert_client_index(index, client);
+    TreeKey key = get_client_name_key(client);
+    if (key.major != 0)
+        insert_tree(&index->name_tree, &key, client);
+    key.major = client->student_number;
+    key.minor = 0;
+    insert_tree(&index->number_tree, &key, client);
+}
+void insert_book(Table *books, BookIndex *index, Book *book)
+{
+    if (book == NULL)
+        return;
+    book->handle = insert_table(books, book);
+    insert_book_index(index, book);
+}
+void insert_borrow(Table *borrows, BorrowIndex *index, Borrow *borrow)
+{
+    if (borrow == NULL)
+        return;
+    borrow->handle = insert_table(borrows, borrow);
+    insert_borrow_index(index, borrow);
+}
+
+Client *find_client_by_student_number(const ClientIndex *index, const uint32_t student_number)
+{
+    if (index->count == 0 || student_number == STUDENT_NUMBER_NONE)
+        return NULL;
+
+    const size_t mask = index->capacity - 1;
+    size_t position = get_client_slot(index, student_number);
+    const ClientIndexSlot *slot = NULL;
+
+    for (slot = &index->slots[position]; slot->client != NULL; slot = &index->slots[position])
+    {
+        if (slot->key == student_number)
+            return slot->client;
+        position = (position + 1) & mask;
+    }
+    return NULL;
+}
+uint32_t get_student_number(const wchar_t *string)
+{
+    uint32_t number = 0;
+    int i;
+
+    if (wcscmp(L"admin", string) == 0)
+        return STUDENT_NUMBER_ADMIN;
+    for (i = 0; i < SIZE_STUDENT_NUMBER && string[i] >= L'0' && string[i] <= L'9'; i++)
+        number = number * 10 + (string[i] - L'0');
+    if (i != SIZE_STUDENT_NUMBER || string[i] != L'\0')
+        return STUDENT_NUMBER_NONE;
+
+    return number;
+}
+void format_student_number(const uint32_t student_number, wchar_t *string)
+{
+    if (student_number == STUDENT_NUMBER_ADMIN)
+        wcscpy(string, L"admin");
+    else
+        swprintf(string, SIZE_STUDENT_NUMBER + 1, L"%08u", student_number);
+}
+uint64_t get_phone_number(const wchar_t *string)
+{
+    uint64_t number = 0;
+    int digit_count = 0;
+
+    for (int i = 0; string[i] != L'\0'; i++)
+    {
+        if (string[i] == L'-')
+            continue;
+        if (string[i] < L'0' || string[i] > L'9' || digit_count == SIZE_PHONE_NUMBER)
+            return PHONE_NUMBER_NONE;
+        number = number * 10 + (string[i] - L'0');
+        digit_count++;
+    }
+    if (digit_count == 0)
+        return PHONE_NUMBER_NONE;
+
+    return number << PHONE_NUMBER_COUNT_BITS | digit_count;
+}
+void format_phone_number(const uint64_t phone_number, wchar_t *string)
+{
+    // 자리수만큼 앞을 0으로 채움
+    const int digit_count = (int)(phone_number & ((1 << PHONE_NUMBER_COUNT_BITS) - 1));
+
+    if (digit_count == 0)
+        string[0] = L'\0';
+    else
+        swprintf(string, SIZE_PHONE_NUMBER + 1, L"%0*llu", digit_count, (unsigned long long)(phone_number >> PHONE_NUMBER_COUNT_BITS));
+}
+size_t get_client_slot(const ClientIndex *index, const uint32_t key)
+{
+    // 연속된 학번이 고르게 퍼지도록 섞음
+    uint32_t hash = key * 2654435769u;
+    hash ^= hash >> 16;
+    return hash & (index->capacity - 1);
+}
+void build_client_index(ClientIndex *index, const Table *clients)
+{
+    size_t capacity = SIZE_CLIENT_INDEX_MIN;
+
+    while (capacity < (size_t)clients->count * 2)
+        capacity *= 2;
+
+    TreeKey key;
+    Client *client = NULL;
+
+    memset(index, 0, sizeof(ClientIndex));
+    resize_client_index(index, capacity);
+    for (size_t position = 0; (client = next_table(clients, &position)) != NULL;)
+    {
+        insert_client_index(index, client);
+        key = get_client_name_key(client);
+        if (key.major != 0)
+            insert_tree(&index->name_tree, &key, client);
+        key.major = client->student_number;
+        key.minor = 0;
+        insert_tree(&index->number_tree, &key, client);
+    }
+}
+void insert_client_index(ClientIndex *index, Client *client)
+{
+    // 절반 이상 차면 늘림
+    if ((index->count + 1) * 2 > index->capacity)
+        resize_client_index(index, index->capacity == 0 ? SIZE_CLIENT_INDEX_MIN : index->capacity * 2);
+
+    const uint32_t key = client->student_number;
+    const size_t mask = index->capacity - 1;
+    size_t position = get_client_slot(index, key);
+    ClientIndexSlot *slot = NULL;
+
+    for (slot = &index->slots[position]; slot->client != NULL; slot = &index->slots[position])
+    {
+        if (slot->key == key)
+        {
+            slot->client = client;
+            return;
+        }
+        position = (position + 1) & mask;
+    }
+    slot->key = key;
+    slot->client = client;
+    index->count++;
+}
+void remove_client_index(ClientIndex *index, const Client *client)
+{
+    if (index->count == 0)
+        return;
+
+    const size_t mask = index->capacity - 1;
+    size_t position = get_client_slot(index, client->student_number);
+
+    while (index->slots[position].client != client)
+    {
+        if (index->slots[position].client == NULL)
+            return;
+        position = (position + 1) & mask;
+    }
+
+    // 빈 자리 뒤의 슬롯 중 원래 자리로 갈 수 있는 것을 당겨옴
+    size_t empty = position;
+    size_t home = 0;
+    for (position = (position + 1) & mask; index->slots[position].client != NULL; position = (position + 1) & mask)
+    {
+        home = get_client_slot(index, index->slots[position].key);
+        if (((position - home) & mask) >= ((position - empty) & mask))
+        {
+            index->slots[empty] = index->slots[position];
+            empty = position;
+        }
+    }
+    index->slots[empty].client = NULL;
+    index->count--;
+}
+void resize_client_index(ClientIndex *index, const size_t capacity)
+{
+    ClientIndexSlot *old_slots = index->slots;
+    const size_t old_capacity = index->capacity;
+
+    index->slots = calloc(capacity, sizeof(ClientIndexSlot));
+    index->capacity = capacity;
+    index->count = 0;
+    for (size_t i = 0; i < old_capacity; i++)
+        if (old_slots[i].client != NULL)
+            insert_client_index(index, old_slots[i].client);
+    free(old_slots);
+}
+void destroy_client_index(ClientIndex *index)
+{
+    free(index->slots);
+    destroy_tree(&index->name_tree);
+    destroy_tree(&index->number_tree);
+    memset(index, 0, sizeof(ClientIndex));
+}
+Client *find_client_by_name(const Table *clients, const wchar_t * name)
+{
+	if (clients == NULL || name == NULL)
+		return 0;
+
+	Client *client = NULL;
+	Client *found = NULL;
+	for (size_t position = 0; (client = next_table(clients, &position)) != NULL;)
+		if (compare_text(client->name, name) == 0 && (found == NULL || client->student_number < found->student_number))
+			found = client;
+	return found;
+}
+LinkedList *find_clients_by_choseong(const ClientIndex *index, const wchar_t *prefix)
+{
+    if (index == NULL || prefix == NULL)
+        return NULL;
+
+    size_t length = 0;
+    const uint64_t prefix_key = get_choseong_key(prefix, &length);
+    if (length == 0)
+        return NULL;
+
+    const uint64_t mask = get_choseong_mask(length);
+    TreeCursor cursor;
+    TreeKey key = {prefix_key, 0};
+    void *value = NULL;
+    LinkedList *first_node = NULL;
+    LinkedList *pre_node = NULL;
+    LinkedList *node = NULL;
+
+    for (seek_tree(&index->name_tree, &key, &cursor); next_tree(&cursor, &key, &value) && (key.major & mask) == prefix_key;)
+    {
+        if (length > CHOSEONG_KEY_SIZE && !has_choseong_prefix(((Client *)value)->name, prefix))
+            continue;
+
+        node = malloc(sizeof(LinkedList));
+        node->contents = value;
+        node->next = NULL;
+        if (first_node == NULL)
+            first_node = node;
+        if (pre_node != NULL)
+            pre_node->next = node;
+        pre_node = node;
+    }
+    return first_node;
+}
+TreeKey get_client_name_key(const Client *client)
+{
+    wchar_t name[SIZE_TEXT_MAX];
+    decode_text(client->name, name, SIZE_TEXT_MAX);
+    const TreeKey key = {get_choseong_key(name, NULL), client->student_number};
+
+    return key;
+}
+void find_books_by_name(const BookIndex *index, const wchar_t *book_name, BookCursor *cursor)
+{
+    init_book_cursor(index, book_name != NULL ? QUERY_NAME : -1, book_name, 0, 0, cursor);
+}
+LinkedList *find_books_by_similar_name(const BookIndex *index, const wchar_t *book_name, const size_t max_distance)
+{
+    if (index == NULL || book_name == NULL || wcslen(book_name) >= SIZE_INPUT_MAX || max_distance > FUZZY_DISTANCE_MAX)
+        return NULL;
+
+    FuzzyPattern *pattern = malloc(sizeof(FuzzyPattern));
+    init_fuzzy_pattern(pattern, book_name);
+
+    uint64_t grams[SIZE_INPUT_MAX];
+    size_t gram_count = 0;
+    uint64_t gram = 0;
+    size_t i = 0, j = 0;
+    for (i = 0; i < pattern->length; i++)
+    {
+        gram = get_gram(book_name, pattern->length, i);
+        for (j = 0; j < gram_count && grams[j] != gram; j++)
+            ;
+        if (gram != 0 && j == gram_count)
+            grams[gram_count++] = gram;
+    }
+
+    size_t distance = 0;
+    // 거리별로 모은 뒤 가까운 것부터 이어 붙임
+    Book **books[FUZZY_DISTANCE_MAX + 1] = {0};
+    size_t counts[FUZZY_DISTANCE_MAX + 1] = {0};
+    size_t capacities[FUZZY_DISTANCE_MAX + 1] = {0};
+
+    if (gram_count > max_distance * GRAM_OTHER_SIZE && !index->keyword_grams.is_building)
+    {
+        // 그램이 threshold개 이상 같은 도서만 거리를 계산함
+        const size_t threshold = gram_count - max_distance * GRAM_OTHER_SIZE;
+        const size_t short_count = gram_count - threshold + 1;
+        const GramPostings *postings[SIZE_INPUT_MAX];
+        uint32_t positions[SIZE_INPUT_MAX] = {0};
+        const GramPostings *swap = NULL;
+        Book *book = NULL;
+        wchar_t name[SIZE_TEXT_MAX];
+        size_t length = 0;
+        size_t hits = 0;
+        uint32_t number = 0;
+
+        // 없는 그램은 빈 목록으로 보고, 짧은 목록이 앞에 오도록 정렬함
+        for (i = 0; i < gram_count; i++)
+        {
+            postings[i] = find_gram(&index->keyword_grams, grams[i]);
+            for (j = i; j > 0 && (postings[j - 1] != NULL ? postings[j - 1]->count : 0) > (postings[j] != NULL ? postings[j]->count : 0); j--)
+            {
+                swap = postings[j - 1];
+                postings[j - 1] = postings[j];
+                postings[j] = swap;
+            }
+        }
+
+        // threshold개 이상 같은 도서는 짧은 목록 short_count개 중 하나에는 꼭 있음
+        while (1)
+        {
+            number = UINT32_MAX;
+            for (i = 0; i < short_count; i++)
+                if (postings[i] != NULL && positions[i] < postings[i]->count && postings[i]->numbers[positions[i]] < number)
+                    number = postings[i]->numbers[positions[i]];
+            if (number == UINT32_MAX)
+                break;
+
+            hits = 0;
+            for (i = 0; i < short_count; i++)
+                if (postings[i] != NULL && positions[i] < postings[i]->count && postings[i]->numbers[positions[i]] == number)
+                {
+                    positions[i]++;
+                    hits++;
+                }
+            for (i = short_count; i < gram_count && hits < threshold && hits + (gram_count - i) >= threshold; i++)
+            {
+                positions[i] = seek_numbers(postings[i]->numbers, postings[i]->count, positions[i], number);
+                if (positions[i] < postings[i]->count && postings[i]->numbers[positions[i]] == number)
+                    hits++;
+            }
+            if (hits < threshold || (book = find_book_by_number(index, number)) == NULL)
+                continue;
+            // 허용 거리보다 긴 부분은 변환하지 않음
+            length = decode_text(book->name, name, pattern->length + max_distance + 2);
+            if (length + max_distance < pattern->length || length > pattern->length + max_distance)
+                continue;
+            distance = get_edit_distance(pattern, name, length, max_distance);
+            if (distance <= max_distance)
+                append_books(&books[distance], &counts[distance], &capacities[distance], &book, 1);
+        }
+    }
+    else
+    {
+        const PostingIndex *names = &index->name_postings;
+        const Postings *postings = NULL;
+        wchar_t name[SIZE_TEXT_MAX];
+        size_t length = 0;
+
+        for (i = 0; i < names->capacity; i++)
+        {
+            postings = &names->slots[i];
+            if (postings->books == NULL)
+                continue;
+
+            // 길이 차이가 허용 거리보다 크면 볼 필요 없음
+            length = decode_text(get_posting_term(names, postings->books[0]), name, pattern->length + max_distance + 2);
+            if (length + max_distance < pattern->length || length > pattern->length + max_distance)
+                continue;
+
+            distance = get_edit_distance(pattern, name, length, max_distance);
+            if (distance <= max_distance)
+                append_books(&books[distance], &counts[distance], &capacities[distance], postings->books, postings->count);
+        }
+    }
+    free(pattern);
+
+    LinkedList *result = NULL;
+    LinkedList *last_node = NULL;
+    LinkedList *list = NULL;
+    for (distance = 0; distance <= max_distance; distance++)
+    {
+        list = create_books_list(books[distance], counts[distance]);
+        free(books[distance]);
+        if (list == NULL)
+            continue;
+
+        if (result == NULL)
+            result = list;
+        else
+            last_node->next = list;
+        for (last_node = list; last_node->next != NULL; last_node = last_node->next)
+            ;
+    }
+
+    return result;
+}
+size_t get_fuzzy_distance(const wchar_t *book_name)
+{
+    const size_t distance = wcslen(book_name) / FUZZY_LENGTH_PER_DISTANCE;
+
+    return distance < FUZZY_DISTANCE_MAX ? distance : FUZZY_DISTANCE_MAX;
+}
+void find_books_by_ISBN(const BookIndex *index, const wchar_t *book_ISBN, BookCursor *cursor)
+{
+    const uint64_t key = book_ISBN != NULL ? get_ISBN_key(book_ISBN) : ISBN_KEY_OTHER;
+
+    // ISBN이 없는 도서는 찾지 않음
+    init_book_cursor(index, key != ISBN_KEY_OTHER ? QUERY_ISBN : -1, book_ISBN, key, key + 1, cursor);
+}
+void find_books_by_ISBN_prefix(const BookIndex *index, const wchar_t *prefix, BookCursor *cursor)
+{
+    uint64_t low = 0;
+    uint64_t high = 0;
+
+    if (prefix == NULL || get_ISBN_range(prefix, &low, &high) == EOF)
+    {
+        find_books_by_ISBN(index, prefix, cursor);
+        return;
+    }
+    init_book_cursor(index, QUERY_ISBN, prefix, low, high, cursor);
+}
+void find_books_by_keyword(const BookIndex *index, const wchar_t *keyword, BookCursor *cursor)
+{
+    init_book_cursor(index, keyword != NULL && keyword[0] != L'\0' ? QUERY_KEYWORD : -1, keyword, 0, 0, cursor);
+}
+void find_books_by_choseong(const BookIndex *index, const wchar_t *prefix, BookCursor *cursor)
+{
+    size_t length = 0;
+    const uint64_t prefix_key = prefix != NULL ? get_choseong_key(prefix, &length) : 0;
+
+    init_book_cursor(index, length > 0 ? QUERY_CHOSEONG : -1, prefix, prefix_key, get_choseong_mask(length), cursor);
+}
+void init_book_cursor(const BookIndex *index, const int field, const wchar_t *value, const uint64_t low, const uint64_t high, BookCursor *cursor)
+{
+    const Postings *postings = NULL;
+    const GramPostings *grams = NULL;
+    const GramPostings *shortest = NULL;
+    TreeKey key = {low, 0};
+    size_t length = 0;
+    uint64_t gram = 0;
+    char term[SIZE_TEXT_MAX];
+
+    memset(cursor, 0, sizeof(BookCursor));
+    cursor->index = index;
+    cursor->field = field;
+    cursor->value = value;
+    cursor->low = low;
+    cursor->high = high;
+    if (index == NULL || field < 0)
+        return;
+
+    switch (field)
+    {
+    case QUERY_NAME:
+    case QUERY_AUTHOR:
+    case QUERY_PUBLISHER:
+        encode_text(value, term, SIZE_TEXT_MAX);
+        postings = find_postings(field == QUERY_NAME ? &index->name_postings : field == QUERY_AUTHOR ? &index->author_postings : &index->publisher_postings, term);
+        if (postings == NULL)
+            return;
+        cursor->type = BOOK_CURSOR_POSTINGS;
+        cursor->books = postings->books;
+        cursor->count = postings->count;
+        return;
+    case QUERY_ISBN:
+        cursor->type = BOOK_CURSOR_ISBN;
+        seek_tree(&index->ISBN_tree, &key, &cursor->tree);
+        return;
+    case QUERY_KEYWORD:
+        // 가장 짧은 그램 목록의 도서만 확인함
+        length = wcslen(value);
+        for (size_t i = 0; i < length; i++)
+        {
+            gram = get_gram(value, length, i);
+            if (gram == 0)
+                continue;
+            grams = find_gram(&index->keyword_grams, gram);
+            if (grams == NULL || grams->count == 0)
+                return;
+            if (shortest == NULL || grams->count < shortest->count)
+                shortest = grams;
+        }
+        if (shortest == NULL)
+            break;
+        cursor->type = BOOK_CURSOR_GRAMS;
+        cursor->numbers = shortest->numbers;
+        cursor->count = shortest->count;
+        return;
+    case QUERY_CHOSEONG:
+        cursor->type = BOOK_CURSOR_CHOSEONG;
+        seek_tree(&index->choseong_tree, &key, &cursor->tree);
+        return;
+    default:
+        break;
+    }
+
+    // 인덱스를 쓸 수 없으면 전체 도서를 봄
+    cursor->type = BOOK_CURSOR_ALL;
+    key.major = 0;
+    seek_tree(&index->ISBN_tree, &key, &cursor->tree);
+}
+void init_book_list_cursor(const LinkedList *book_list, BookCursor *cursor)
+{
+    memset(cursor, 0, sizeof(BookCursor));
+    cursor->type = BOOK_CURSOR_LIST;
+    cursor->field = QUERY_FIELD_MAX;
+    cursor->list = book_list;
+}
+void init_query_cursor(const BookIndex *index, const Query *query, const size_t term_number, BookCursor *cursor)
+{
+    const QueryTerm *term = &query->terms[term_number];
+    const QueryCondition *driver = &term->conditions[term->driver];
+
+    init_book_cursor(index, driver->estimate > 0 ? driver->field : -1, driver->value, driver->low, driver->high, cursor);
+    cursor->query = query;
+    cursor->term_number = term_number;
+}
+Book *next_book_cursor(BookCursor *cursor)
+{
+    Book *book = NULL;
+    TreeKey key;
+    void *value = NULL;
+    uint64_t major = 0;
+    uint32_t number = 0;
+    int matched = 0;
+
+    while (1)
+    {
+        book = NULL;
+        switch (cursor->type)
+        {
+        case BOOK_CURSOR_POSTINGS:
+            if (cursor->position >= cursor->count)
+                return NULL;
+            book = cursor->books[cursor->position++];
+            break;
+        case BOOK_CURSOR_ISBN:
+            if (cursor->run_count == 0)
+            {
+                if (!next_tree(&cursor->tree, &key, NULL) || key.major >= cursor->high)
+                {
+                    cursor->type = BOOK_CURSOR_EMPTY;
+                    return NULL;
+                }
+                // 같은 ISBN은 도서번호 내림차순이므로 끝까지 세고 거꾸로 읽음
+                major = key.major;
+                cursor->run_count = 1;
+                for (cursor->run = cursor->tree; next_tree(&cursor->run, &key, NULL) && key.major == major; cursor->tree = cursor->run)
+                    cursor->run_count++;
+                cursor->run = cursor->tree;
+            }
+            if (!prev_tree(&cursor->run, &key, NULL))
+            {
+                cursor->type = BOOK_CURSOR_EMPTY;
+                return NULL;
+            }
+            cursor->run_count--;
+            number = UINT32_MAX - (uint32_t)key.minor;
+            break;
+        case BOOK_CURSOR_GRAMS:
+            if (cursor->position >= cursor->count)
+                return NULL;
+            number = cursor->numbers[cursor->position++];
+            break;
+        case BOOK_CURSOR_CHOSEONG:
+            if (!next_tree(&cursor->tree, &key, &value) || (key.major & cursor->high) != cursor->low)
+            {
+                cursor->type = BOOK_CURSOR_EMPTY;
+                return NULL;
+            }
+            book = value;
+            // 키에 들어가지 않은 뒷부분은 문자열로 확인함
+            if (!has_choseong_prefix((key.minor & 3) == 0 ? book->name : (key.minor & 3) == 1 ? book->author : book->publisher, cursor->value))
+                continue;
+            // 여러 필드가 맞으면 처음 맞는 필드에서만 봄
+            if ((key.minor & 3) > 0 && has_choseong_prefix(book->name, cursor->value))
+                continue;
+            if ((key.minor & 3) > 1 && has_choseong_prefix(book->author, cursor->value))
+                continue;
+            break;
+        case BOOK_CURSOR_ALL:
+            if (!next_tree(&cursor->tree, &key, NULL))
+                return NULL;
+            number = UINT32_MAX - (uint32_t)key.minor;
+            break;
+        case BOOK_CURSOR_LIST:
+            if (cursor->list == NULL)
+                return NULL;
+            book = cursor->list->contents;
+            cursor->list = cursor->list->next;
+            break;
+        default:
+            return NULL;
+        }
+
+        // 번호로 찾은 후보는 열에서 먼저 걸러서 조건에 맞는 도서만 읽음
+        if (book == NULL)
+        {
+            matched = match_book_columns(cursor, number);
+            if (matched == 0)
+                continue;
+            book = find_book_by_number(cursor->index, number);
+            if (matched == 1)
+                return book;
+        }
+        if (match_book_cursor(cursor, book))
+            return book;
+    }
+}
+_Bool match_book_cursor(const BookCursor *cursor, const Book *book)
+{
+    if (cursor->query != NULL)
+    {
+        if (!match_query_term(book, &cursor->query->terms[cursor->term_number]))
+            return 0;
+        // 앞의 항에서 이미 나온 도서
+        for (size_t i = 0; i < cursor->term_number; i++)
+            if (match_query_term(book, &cursor->query->terms[i]))
+                return 0;
+        return 1;
+    }
+
+    switch (cursor->field)
+    {
+    case QUERY_KEYWORD:
+        // 그램이 모두 있어도 이어져 있지 않을 수 있으므로 확인함
+        return has_keyword(book->name, cursor->value) || has_keyword(book->author, cursor->value) || has_keyword(book->publisher, cursor->value);
+    default:
+        return 1;
+    }
+}
+int match_book_columns(const BookCursor *cursor, const uint32_t number)
+{
+    const size_t page_number = number >> BOOK_INDEX_PAGE_BITS;
+    if (page_number >= cursor->index->page_count || cursor->index->pages[page_number] == NULL)
+        return 0;
+
+    const BookPage *page = cursor->index->pages[page_number];
+    const size_t slot = number & (SIZE_BOOK_INDEX_PAGE - 1);
+    int result = EOF;
+
+    if (page->books[slot] == NULL)
+        return 0;
+    if (cursor->query == NULL)
+        return EOF;
+
+    result = match_term_columns(page, slot, &cursor->query->terms[cursor->term_number]);
+    if (result == 0)
+        return 0;
+    // 앞의 항에서 이미 나온 도서
+    for (size_t i = 0; i < cursor->term_number; i++)
+    {
+        switch (match_term_columns(page, slot, &cursor->query->terms[i]))
+        {
+        case 1:
+            return 0;
+        case EOF:
+            result = EOF;
+            break;
+        default:
+            break;
+        }
+    }
+    return result;
+}
+int match_term_columns(const BookPage *page, const size_t slot, const QueryTerm *term)
+{
+    const QueryCondition *condition = NULL;
+    int result = 1;
+
+    for (size_t i = 0; i < term->count; i++)
+    {
+        condition = &term->conditions[i];
+        switch (condition->field)
+        {
+        case QUERY_ISBN:
+            if (page->ISBNs[slot] < condition->low || page->ISBNs[slot] >= condition->high)
+                return 0;
+            break;
+        case QUERY_AVAILABLE:
+            if (page->availability[slot] != 'Y')
+                return 0;
+            break;
+        default:
+            result = EOF;
+            break;
+        }
+    }
+    return result;
+}
+size_t find_title_suggestions(const BookIndex *index, const wchar_t *prefix, const TitleEntry **suggestions)
+{
+    if (index == NULL || prefix == NULL || index->title_trie.root == NULL)
+        return 0;
+
+    const TitleNode *node = index->title_trie.root;
+    const TitleNode *child = NULL;
+    size_t position = 0;
+    size_t i = 0;
+
+    while (*prefix != L'\0')
+    {
+        child = find_title_child(node, *prefix, &position);
+        if (child == NULL)
+            return 0;
+        for (i = 0; i < child->label_length && prefix[i] != L'\0' && prefix[i] == child->label[i]; i++)
+            ;
+        // 입력이 레이블 중간에서 끝나도 그 아래 제목이 모두 후보임
+        if (prefix[i] != L'\0' && i < child->label_length)
+            return 0;
+        prefix += i;
+        node = child;
+    }
+
+    for (i = 0; i < node->top_count; i++)
+        suggestions[i] = node->top[i];
+    return node->top_count;
+}
+void count_book_loan(BookIndex *index, Book *book)
+{
+    wchar_t name[SIZE_TEXT_MAX];
+    decode_text(book->name, name, SIZE_TEXT_MAX);
+    book->loan_count++;
+    update_title(&index->title_trie, name, 0, 1);
+}
+void set_book_availability(BookIndex *index, Book *book, const wchar_t availability)
+{
+    const size_t page = book->number >> BOOK_INDEX_PAGE_BITS;
+    const size_t slot = book->number & (SIZE_BOOK_INDEX_PAGE - 1);
+
+    book->availability = availability;
+    if (page < index->page_count && index->pages[page] != NULL && index->pages[page]->books[slot] == book)
+        index->pages[page]->availability[slot] = (unsigned char)availability;
+}
+int parse_query(const wchar_t *text, Query *query)
+{
+    memset(query, 0, sizeof(Query));
+    if (wcsncmp(text, STRING_QUERY_EXPLAIN, wcslen(STRING_QUERY_EXPLAIN)) == 0)
+    {
+        query->is_explain = 1;
+        text += wcslen(STRING_QUERY_EXPLAIN);
+    }
+
+    const wchar_t *term_end = NULL;
+    const wchar_t *condition_end = NULL;
+    QueryTerm *term = NULL;
+
+    while (1)
+    {
+        if (query->count == SIZE_QUERY_TERM_MAX)
+            return EOF;
+        term = &query->terms[query->count++];
+        term_end = wcsstr(text, STRING_QUERY_OR);
+        if (term_end == NULL)
+            term_end = text + wcslen(text);
+
+        while (1)
+        {
+            if (term->count == SIZE_QUERY_CONDITION_MAX)
+                return EOF;
+            condition_end = wcsstr(text, STRING_QUERY_AND);
+            if (condition_end == NULL || condition_end > term_end)
+                condition_end = term_end;
+            if (parse_query_condition(text, condition_end - text, &term->conditions[term->count++]) == EOF)
+                return EOF;
+            if (condition_end == term_end)
+                break;
+            text = condition_end + wcslen(STRING_QUERY_AND);
+        }
+
+        if (*term_end == L'\0')
+            break;
+        text = term_end + wcslen(STRING_QUERY_OR);
+    }
+    return 0;
+}
+int parse_query_condition(const wchar_t *text, size_t length, QueryCondition *condition)
+{
+    static const wchar_t *fields[QUERY_FIELD_MAX] = {L"name", L"author", L"publisher", L"isbn", L"keyword", L"choseong", L"available"};
+
+    // 앞뒤 공백을 지움
+    while (length > 0 && *text == L' ')
+    {
+        text++;
+        length--;
+    }
+    while (length > 0 && text[length - 1] == L' ')
+        length--;
+
+    memset(condition, 0, sizeof(QueryCondition));
+    if (length == wcslen(fields[QUERY_AVAILABLE]) && wcsncmp(text, fields[QUERY_AVAILABLE], length) == 0)
+    {
+        condition->field = QUERY_AVAILABLE;
+        return 0;
+    }
+
+    const wchar_t *equal = wmemchr(text, L'=', length);
+    if (equal == NULL)
+        return EOF;
+
+    size_t field_length = equal - text;
+    while (field_length > 0 && text[field_length - 1] == L' ')
+        field_length--;
+    for (condition->field = 0; condition->field < QUERY_AVAILABLE; condition->field++)
+        if (field_length == wcslen(fields[condition->field]) && wcsncmp(text, fields[condition->field], field_length) == 0)
+            break;
+    if (condition->field == QUERY_AVAILABLE)
+        return EOF;
+
+    length -= equal + 1 - text;
+    text = equal + 1;
+    while (length > 0 && *text == L' ')
+    {
+        text++;
+        length--;
+    }
+    if (length == 0 || length >= SIZE_INPUT_MAX)
+        return EOF;
+    wmemcpy(condition->value, text, length);
+    condition->value[length] = L'\0';
+
+    size_t choseong_length = 0;
+    switch (condition->field)
+    {
+    case QUERY_ISBN:
+        // 접두사가 아니면 같은 ISBN만 찾음
+        if (get_ISBN_range(condition->value, &condition->low, &condition->high) == EOF)
+        {
+            condition->low = get_ISBN_key(condition->value);
+            condition->high = condition->low != ISBN_KEY_OTHER ? condition->low + 1 : condition->low;
+        }
+        break;
+    case QUERY_CHOSEONG:
+        condition->low = get_choseong_key(condition->value, &choseong_length);
+        condition->high = get_choseong_mask(choseong_length);
+        if (choseong_length == 0)
+            return EOF;
+        break;
+    default:
+        break;
+    }
+    return 0;
+}
+void plan_query(const BookIndex *index, Query *query)
+{
+    QueryTerm *term = NULL;
+    QueryCondition *condition = NULL;
+    const PostingIndex *postings_index = NULL;
+    const Postings *postings = NULL;
+    char text[SIZE_TEXT_MAX];
+    size_t best = 0;
+
+    for (size_t i = 0; i < query->count; i++)
+    {
+        term = &query->terms[i];
+        term->driver = 0;
+        best = SIZE_MAX;
+        // 바로 셀 수 있는 조건을 먼저 보고, 트리 범위는 그보다 많아지면 그만 셈
+        for (int pass = 0; pass < 2; pass++)
+        {
+            for (size_t j = 0; j < term->count; j++)
+            {
+                condition = &term->conditions[j];
+                if ((condition->field == QUERY_ISBN || condition->field == QUERY_CHOSEONG) != (pass == 1))
+                    continue;
+                condition->estimate = estimate_query_condition(index, condition, best);
+                // 저자와 출판사는 공유된 문자열의 주소로 비교함
+                condition->symbol = NULL;
+                if (condition->estimate > 0 && (condition->field == QUERY_AUTHOR || condition->field == QUERY_PUBLISHER))
+                {
+                    postings_index = condition->field == QUERY_AUTHOR ? &index->author_postings : &index->publisher_postings;
+                    encode_text(condition->value, text, SIZE_TEXT_MAX);
+                    postings = find_postings(postings_index, text);
+                    condition->symbol = get_posting_term(postings_index, postings->books[0]);
+                }
+                if (condition->estimate < best)
+                {
+                    best = condition->estimate;
+                    term->driver = j;
+                }
+            }
+        }
+    }
+}
+size_t estimate_query_condition(const BookIndex *index, const QueryCondition *condition, const size_t limit)
+{
+    const Postings *postings = NULL;
+    const GramPostings *grams = NULL;
+    TreeCursor cursor;
+    TreeKey key = {condition->low, 0};
+    size_t count = 0;
+    size_t length = 0;
+    uint64_t gram = 0;
+    char term[SIZE_TEXT_MAX];
+
+    switch (condition->field)
+    {
+    case QUERY_NAME:
+    case QUERY_AUTHOR:
+    case QUERY_PUBLISHER:
+        encode_text(condition->value, term, SIZE_TEXT_MAX);
+        postings = find_postings(condition->field == QUERY_NAME ? &index->name_postings : condition->field == QUERY_AUTHOR ? &index->author_postings : &index->publisher_postings, term);
+        return postings != NULL ? postings->count : 0;
+    case QUERY_ISBN:
+        for (seek_tree(&index->ISBN_tree, &key, &cursor); count < limit && next_tree(&cursor, &key, NULL) && key.major < condition->high;)
+            count++;
+        return count;
+    case QUERY_KEYWORD:
+        // 가장 짧은 그램 목록의 길이
+        count = index->count;
+        length = wcslen(condition->value);
+        for (size_t i = 0; i < length; i++)
+        {
+            gram = get_gram(condition->value, length, i);
+            if (gram == 0)
+                continue;
+            grams = find_gram(&index->keyword_grams, gram);
+            if (grams == NULL)
+                return 0;
+            if (grams->count < count)
+                count = grams->count;
+        }
+        return count;
+    case QUERY_CHOSEONG:
+        for (seek_tree(&index->choseong_tree, &key, &cursor); count < limit && next_tree(&cursor, &key, NULL) && (key.major & condition->high) == condition->low;)
+            count++;
+        return count;
+    default:
+        return index->count;
+    }
+}
+_Bool match_query_condition(const Book *book, const QueryCondition *condition)
+{
+    switch (condition->field)
+    {
+    case QUERY_NAME:
+        return compare_text(book->name, condition->value) == 0;
+    case QUERY_AUTHOR:
+        if (condition->symbol != NULL)
+            return book->author == condition->symbol;
+        return compare_text(book->author, condition->value) == 0;
+    case QUERY_PUBLISHER:
+        if (condition->symbol != NULL)
+            return book->publisher == condition->symbol;
+        return compare_text(book->publisher, condition->value) == 0;
+    case QUERY_ISBN:
+        return book->ISBN >= condition->low && book->ISBN < condition->high;
+    case QUERY_KEYWORD:
+        return has_keyword(book->name, condition->value) || has_keyword(book->author, condition->value) || has_keyword(book->publisher, condition->value);
+    case QUERY_CHOSEONG:
+        return has_choseong_prefix(book->name, condition->value) || has_choseong_prefix(book->author, condition->value) || has_choseong_prefix(book->publisher, condition->value);
+    case QUERY_AVAILABLE:
+        return book->availability == L'Y';
+    default:
+        return 0;
+    }
+}
+_Bool match_query_term(const Book *book, const QueryTerm *term)
+{
+    for (size_t i = 0; i < term->count; i++)
+        if (!match_query_condition(book, &term->conditions[i]))
+            return 0;
+    return 1;
+}
+size_t run_query(const BookIndex *index, const Query *query, void (*visit)(const Book *book, void *context), void *context)
+{
+    size_t count = 0;
+
+    for (size_t i = 0; i < query->count; i++)
+        count += run_query_term(index, query, i, visit, context);
+    return count;
+}
+size_t run_query_term(const BookIndex *index, const Query *query, const size_t term_number, void (*visit)(const Book *book, void *context), void *context)
+{
+    BookCursor cursor;
+    const Book *book = NULL;
+    const QueryTerm *term = &query->terms[term_number];
+    size_t count = 0;
+    _Bool is_column = visit == NULL && term->conditions[term->driver].field == QUERY_AVAILABLE;
+
+    // 세기만 하는 전체 검색은 순서가 필요 없으므로 열을 번호 순서로 셈
+    for (size_t i = 0; i <= term_number && is_column; i++)
+        is_column = is_column_term(&query->terms[i]);
+    if (is_column)
+        return count_book_columns(index, query, term_number);
+
+    init_query_cursor(index, query, term_number, &cursor);
+    while ((book = next_book_cursor(&cursor)) != NULL)
+    {
+        if (visit != NULL)
+            visit(book, context);
+        count++;
+    }
+    return count;
+}
+size_t count_book_columns(const BookIndex *index, const Query *query, const size_t term_number)
+{
+    const BookPage *page = NULL;
+    size_t count = 0;
+    size_t i = 0;
+
+    for (size_t page_number = 0; page_number < index->page_count; page_number++)
+    {
+        page = index->pages[page_number];
+        if (page == NULL)
+            continue;
+        for (size_t slot = 0; slot < SIZE_BOOK_INDEX_PAGE; slot++)
+        {
+            if (page->books[slot] == NULL || match_term_columns(page, slot, &query->terms[term_number]) != 1)
+                continue;
+            for (i = 0; i < term_number && match_term_columns(page, slot, &query->terms[i]) != 1; i++)
+                ;
+            if (i == term_number)
+                count++;
+        }
+    }
+    return count;
+}
+_Bool is_column_term(const QueryTerm *term)
+{
+    for (size_t i = 0; i < term->count; i++)
+        if (term->conditions[i].field != QUERY_ISBN && term->conditions[i].field != QUERY_AVAILABLE)
+            return 0;
+    return 1;
+}
+void print_query_plan(const Query *query)
+{
+    static const wchar_t *fields[QUERY_FIELD_MAX] = {L"name", L"author", L"publisher", L"isbn", L"keyword", L"choseong", L"available"};
+    static const wchar_t *indexes[QUERY_FIELD_MAX] = {L"name_postings", L"author_postings", L"publisher_postings", L"ISBN_tree", L"keyword_grams", L"choseong_tree", L"전체 검색"};
+    const QueryTerm *term = NULL;
+    const QueryCondition *condition = NULL;
+
+    wprintf(L">> 실행 계획 <<\n");
+    for (size_t i = 0; i < query->count; i++)
+    {
+        term = &query->terms[i];
+        condition = &term->conditions[term->driver];
+        wprintf(L"%zu. 인덱스: %ls (예상 %zu권)\n", i + 1, indexes[condition->field], condition->estimate);
+        for (size_t j = 0; j < term->count; j++)
+        {
+            condition = &term->conditions[j];
+            if (condition->field == QUERY_AVAILABLE)
+                wprintf(L"   %ls %ls\n", j == term->driver ? L"탐색" : L"필터", fields[condition->field]);
+            else
+                wprintf(L"   %ls %ls = %ls (예상 %zu권)\n", j == term->driver ? L"탐색" : L"필터", fields[condition->field], condition->value, condition->estimate);
+        }
+    }
+}
+void print_query_book(const Book *book, void *context)
+{
+    (void)context;
+    wprintf(L"\n");
+    print_book(book);
+}
+TreeKey get_book_choseong_key(const Book *book, const int field)
+{
+    wchar_t text[SIZE_TEXT_MAX];
+    decode_text(field == 0 ? book->name : field == 1 ? book->author : book->publisher, text, SIZE_TEXT_MAX);
+    const TreeKey key = {get_choseong_key(text, NULL), (uint64_t)book->number << 2 | field};
+
+    return key;
+}
+void find_books_by_author(const BookIndex *index, const wchar_t *book_author, BookCursor *cursor)
 {
-    Data data;
+    init_book_cursor(index, book_author != NULL ? QUERY_AUTHOR : -1, book_author, 0, 0, cursor);
+}
+void find_books_by_publisher(const BookIndex *index, const wchar_t *book_publisher, BookCursor *cursor)
+{
+    init_book_cursor(index, book_publisher != NULL ? QUERY_PUBLISHER : -1, book_publisher, 0, 0, cursor);
+}
+Book *find_book_by_number(const BookIndex *index, const uint32_t book_number)
+{
+    const size_t page = book_number >> BOOK_INDEX_PAGE_BITS;
+    if (page >= index->page_count || index->pages[page] == NULL)
+        return NULL;
 
-    setlocale(LC_ALL, "");
+    return index->pages[page]->books[book_number & (SIZE_BOOK_INDEX_PAGE - 1)];
+}
+_Bool has_book(const BookCursor *cursor, const Book *book)
+{
+    BookCursor current = *cursor;
+    const Book *found = NULL;
 
-    data.clients = init_clients(STRING_CLIENT_FILE);
-    data.books = init_books(STRING_BOOK_FILE);
-    data.borrows = init_borrows(STRING_BORROW_FILE);
+    while ((found = next_book_cursor(&current)) != NULL)
+        if (found == book)
+            return 1;
+    return 0;
+}
+uint32_t get_book_number(const wchar_t *string)
+{
+    uint32_t number = 0;
+    int i;
 
-    data.screens = init_screens();
+    for (i = 0; i < SIZE_BOOK_NUMBER && string[i] >= L'0' && string[i] <= L'9'; i++)
+        number = number * 10 + (string[i] - L'0');
+    if (i == 0 || string[i] != L'\0')
+        return 0;
 
-    data.is_running = 1;
-    data.is_admin = 0;
+    return number;
+}
+void init_book_index(BookIndex *index)
+{
+    memset(index, 0, sizeof(BookIndex));
+    index->next_number = 1;
+    init_posting_index(&index->name_postings, offsetof(Book, name));
+    init_posting_index(&index->author_postings, offsetof(Book, author));
+    init_posting_index(&index->publisher_postings, offsetof(Book, publisher));
+    index->keyword_grams.is_building = 1;
+}
+void finish_book_index(BookIndex *index)
+{
+    finish_gram_index(&index->keyword_grams);
+}
+void insert_book_index(BookIndex *index, Book *book)
+{
+    const size_t page = book->number >> BOOK_INDEX_PAGE_BITS;
 
-    while (data.is_running)
+    if (page >= index->page_count)
     {
-        clear_screen();
-        draw_screen(data.screens, &data);
-        input_screen(data.screens, &data);
+        size_t page_count = index->page_count == 0 ? 1 : index->page_count;
+        while (page_count <= page)
+            page_count *= 2;
+        index->pages = realloc(index->pages, sizeof(BookPage *) * page_count);
+        memset(index->pages + index->page_count, 0, sizeof(BookPage *) * (page_count - index->page_count));
+        index->page_count = page_count;
     }
+    if (index->pages[page] == NULL)
+        index->pages[page] = calloc(1, sizeof(BookPage));
 
-    destroy_clients(data.clients, STRING_CLIENT_FILE);
-    destroy_books(data.books, STRING_BOOK_FILE);
-    destroy_borrows(data.borrows, STRING_BORROW_FILE);
+    BookPage *columns = index->pages[page];
+    const size_t slot = book->number & (SIZE_BOOK_INDEX_PAGE - 1);
+    if (columns->books[slot] == NULL)
+        index->count++;
+    columns->books[slot] = book;
+    columns->ISBNs[slot] = book->ISBN;
+    columns->availability[slot] = (unsigned char)book->availability;
 
-    destroy_screens(data.screens);
+    if (book->number >= index->next_number)
+        index->next_number = book->number + 1;
+
+    const TreeKey key = get_book_key(book);
+    insert_tree(&index->ISBN_tree, &key, book);
+
+    insert_posting(&index->name_postings, book);
+    insert_posting(&index->author_postings, book);
+    insert_posting(&index->publisher_postings, book);
+
+    update_text_grams(&index->keyword_grams, book->name, book->number, 1);
+    update_text_grams(&index->keyword_grams, book->author, book->number, 1);
+    update_text_grams(&index->keyword_grams, book->publisher, book->number, 1);
+
+    // 한글이 없는 필드는 초성으로 찾을 수 없으므로 넣지 않음
+    for (int field = 0; field < 3; field++)
+    {
+        const TreeKey choseong_key = get_book_choseong_key(book, field);
+        if (choseong_key.major != 0)
+            insert_tree(&index->choseong_tree, &choseong_key, book);
+    }
+
+    wchar_t name[SIZE_TEXT_MAX];
+    decode_text(book->name, name, SIZE_TEXT_MAX);
+    update_title(&index->title_trie, name, 1, book->loan_count);
+}
+void remove_book_index(BookIndex *index, const Book *book)
+{
+    const size_t page = book->number >> BOOK_INDEX_PAGE_BITS;
+    if (page >= index->page_count || index->pages[page] == NULL)
+        return;
+
+    // 같은 번호의 다른 도서가 들어가 있으면 지우지 않음
+    BookPage *columns = index->pages[page];
+    const size_t slot = book->number & (SIZE_BOOK_INDEX_PAGE - 1);
+    if (columns->books[slot] != book)
+        return;
+    columns->books[slot] = NULL;
+    columns->availability[slot] = 0;
+    index->count--;
+
+    const TreeKey key = get_book_key(book);
+    if (find_tree(&index->ISBN_tree, &key) == book)
+        remove_tree(&index->ISBN_tree, &key);
+
+    remove_posting(&index->name_postings, book);
+    remove_posting(&index->author_postings, book);
+    remove_posting(&index->publisher_postings, book);
+
+    update_text_grams(&index->keyword_grams, book->name, book->number, 0);
+    update_text_grams(&index->keyword_grams, book->author, book->number, 0);
+    update_text_grams(&index->keyword_grams, book->publisher, book->number, 0);
+
+    for (int field = 0; field < 3; field++)
+    {
+        const TreeKey choseong_key = get_book_choseong_key(book, field);
+        remove_tree(&index->choseong_tree, &choseong_key);
+    }
+
+    wchar_t name[SIZE_TEXT_MAX];
+    decode_text(book->name, name, SIZE_TEXT_MAX);
+    update_title(&index->title_trie, name, -1, -(int64_t)book->loan_count);
+}
+void destroy_book_index(BookIndex *index)
+{
+    for (size_t i = 0; i < index->page_count; i++)
+        free(index->pages[i]);
+    free(index->pages);
+    destroy_tree(&index->ISBN_tree);
+    destroy_posting_index(&index->name_postings);
+    destroy_posting_index(&index->author_postings);
+    destroy_posting_index(&index->publisher_postings);
+    destroy_gram_index(&index->keyword_grams);
+    destroy_tree(&index->choseong_tree);
+    destroy_title_trie(&index->title_trie);
+    memset(index, 0, sizeof(BookIndex));
+}
+uint32_t allocate_book_numbers(BookIndex *index, const uint32_t count)
+{
+    const uint32_t number = index->next_number;
+    if (count == 0 || (uint64_t)number + count - 1 > BOOK_NUMBER_MAX)
+        return 0;
+    index->next_number += count;
+
+    return number;
+}
+uint64_t get_ISBN_key(const wchar_t *ISBN)
+{
+    uint64_t key = 0;
+    int digit_count = 0;
+
+    for (int i = 0; ISBN[i] != L'\0'; i++)
+    {
+        if (ISBN[i] == L'-')
+            continue;
+        if (ISBN[i] < L'0' || ISBN[i] > L'9' || digit_count == SIZE_ISBN)
+            return ISBN_KEY_OTHER;
+        key = key * 10 + (ISBN[i] - L'0');
+        digit_count++;
+    }
+    if (digit_count != SIZE_ISBN)
+        return ISBN_KEY_OTHER;
+
+    return key;
+}
+void format_ISBN(const uint64_t ISBN, wchar_t *string)
+{
+    if (ISBN == ISBN_KEY_OTHER)
+        string[0] = L'\0';
+    else
+        swprintf(string, SIZE_ISBN + 1, L"%013llu", (unsigned long long)ISBN);
+}
+int get_ISBN_range(const wchar_t *prefix, uint64_t *low, uint64_t *high)
+{
+    int digit_count = 0;
+
+    *low = 0;
+    for (int i = 0; prefix[i] != L'\0'; i++)
+    {
+        if (prefix[i] == L'-')
+            continue;
+        if (prefix[i] < L'0' || prefix[i] > L'9' || digit_count == SIZE_ISBN)
+            return EOF;
+        *low = *low * 10 + (prefix[i] - L'0');
+        digit_count++;
+    }
+    if (digit_count == 0 || digit_count == SIZE_ISBN)
+        return EOF;
 
+    // 접두사 뒤의 자리를 0으로 채운 범위를 찾음
+    *high = *low + 1;
+    for (; digit_count < SIZE_ISBN; digit_count++)
+    {
+        *low *= 10;
+        *high *= 10;
+    }
     return 0;
 }
+TreeKey get_book_key(const Book *book)
+{
+    // 같은 ISBN은 나중에 등록된(번호가 큰) 도서가 앞에 옴
+    const TreeKey key = {book->ISBN, UINT32_MAX - book->number};
+    return key;
+}
 
-LinkedList *init_clients(const char *file_name)
+int compare_tree_key(const TreeKey *a, const TreeKey *b)
 {
-    FILE *file_pointer;
-    file_pointer = fopen(file_name, "r+");
-    if (file_pointer == NULL)
+    if (a->major != b->major)
+        return a->major < b->major ? -1 : 1;
+    if (a->minor != b->minor)
+        return a->minor < b->minor ? -1 : 1;
+    return 0;
+}
+int search_tree_node(const TreeNode *node, const TreeKey *key, const _Bool is_upper)
+{
+    int low = 0;
+    int high = node->count;
+    int middle = 0;
+    int compare = 0;
+
+    while (low < high)
+    {
+        middle = (low + high) / 2;
+        compare = compare_tree_key(&node->keys[middle], key);
+        if (compare < 0 || (is_upper && compare == 0))
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return low;
+}
+TreeNode *find_tree_leaf(const Tree *tree, const TreeKey *key)
+{
+    TreeNode *node = tree->root;
+    if (node == NULL)
         return NULL;
 
-    LinkedList *node = NULL;
-    LinkedList *first_node = NULL;
-    LinkedList *pre_node = NULL;
-    Client *client = NULL;
-    wchar_t input[5][SIZE_INPUT_MAX] = {0};
+    while (!node->is_leaf)
+        node = node->pointers[search_tree_node(node, key, 1)];
+    return node;
+}
+void *find_tree(const Tree *tree, const TreeKey *key)
+{
+    const TreeNode *leaf = find_tree_leaf(tree, key);
+    if (leaf == NULL)
+        return NULL;
+
+    const int position = search_tree_node(leaf, key, 0);
+    if (position < leaf->count && compare_tree_key(&leaf->keys[position], key) == 0)
+        return leaf->pointers[position];
+    return NULL;
+}
+void *find_tree_before(const Tree *tree, const TreeKey *key)
+{
+    const TreeNode *leaf = find_tree_leaf(tree, key);
+    if (leaf == NULL)
+        return NULL;
 
-    while (ftell(file_pointer) != EOF)
+    // 앞 리프가 비어 있을 수 있으므로 키가 있는 리프까지 돌아감
+    int position = search_tree_node(leaf, key, 0);
+    while (position == 0)
     {
-        if (read_string_by_token(file_pointer, L" | ", 3, input[0]) == EOF ||
-            read_string_by_token(file_pointer, L" | ", 3, input[1]) == EOF ||
-            read_string_by_token(file_pointer, L" | ", 3, input[2]) == EOF ||
-            read_string_by_token(file_pointer, L" | ", 3, input[3]) == EOF ||
-            read_string_by_token(file_pointer, L" | ", 3, input[4]) == EOF)
-            break;
+        leaf = leaf->prev;
+        if (leaf == NULL)
+            return NULL;
+        position = leaf->count;
+    }
+    return leaf->pointers[position - 1];
+}
+void insert_tree(Tree *tree, const TreeKey *key, void *value)
+{
+    if (tree->root == NULL)
+    {
+        tree->root = calloc(1, sizeof(TreeNode));
+        tree->root->is_leaf = 1;
+    }
 
-        node = malloc(sizeof(LinkedList));
-        node->next = NULL;
-        if (first_node == NULL)
-            first_node = node;
-        client = malloc(sizeof(Client));
+    TreeKey split_key;
+    TreeNode *right = insert_tree_node(tree, tree->root, key, value, &split_key);
+    if (right == NULL)
+        return;
 
-        wcscpy(client->student_number, input[0]);
+    // 루트가 나뉘면 새 루트를 만듦
+    TreeNode *root = calloc(1, sizeof(TreeNode));
+    root->is_leaf = 0;
+    root->count = 1;
+    root->keys[0] = split_key;
+    root->pointers[0] = tree->root;
+    root->pointers[1] = right;
+    tree->root = root;
+}
+TreeNode *insert_tree_node(Tree *tree, TreeNode *node, const TreeKey *key, void *value, TreeKey *split_key)
+{
+    int position = 0;
 
-        client->password = malloc(sizeof(wchar_t) * (wcslen(input[1]) + 1));
-        wcscpy(client->password, input[1]);
+    if (node->is_leaf)
+    {
+        position = search_tree_node(node, key, 0);
+        if (position < node->count && compare_tree_key(&node->keys[position], key) == 0)
+        {
+            node->pointers[position] = value;
+            return NULL;
+        }
+        memmove(&node->keys[position + 1], &node->keys[position], sizeof(TreeKey) * (node->count - position));
+        memmove(&node->pointers[position + 1], &node->pointers[position], sizeof(void *) * (node->count - position));
+        node->keys[position] = *key;
+        node->pointers[position] = value;
+        node->count++;
+        tree->count++;
+    }
+    else
+    {
+        TreeKey child_key;
+        position = search_tree_node(node, key, 1);
+        TreeNode *child = insert_tree_node(tree, node->pointers[position], key, value, &child_key);
+        if (child == NULL)
+            return NULL;
+
+        memmove(&node->keys[position + 1], &node->keys[position], sizeof(TreeKey) * (node->count - position));
+        memmove(&node->pointers[position + 2], &node->pointers[position + 1], sizeof(void *) * (node->count - position));
+        node->keys[position] = child_key;
+        node->pointers[position + 1] = child;
+        node->count++;
+    }
 
-        client->name = malloc(sizeof(wchar_t) * (wcslen(input[2]) + 1));
-        wcscpy(client->name, input[2]);
+    if (node->count < SIZE_TREE_NODE)
+        return NULL;
+    return split_tree_node(node, split_key);
+}
+TreeNode *split_tree_node(TreeNode *node, TreeKey *split_key)
+{
+    TreeNode *right = calloc(1, sizeof(TreeNode));
+    const int half = node->count / 2;
 
-        client->address = malloc(sizeof(wchar_t) * (wcslen(input[3]) + 1));
-        wcscpy(client->address, input[3]);
+    right->is_leaf = node->is_leaf;
+    if (node->is_leaf)
+    {
+        right->count = node->count - half;
+        memcpy(right->keys, &node->keys[half], sizeof(TreeKey) * right->count);
+        memcpy(right->pointers, &node->pointers[half], sizeof(void *) * right->count);
+        *split_key = right->keys[0];
+
+        right->prev = node;
+        right->next = node->next;
+        if (node->next != NULL)
+            node->next->prev = right;
+        node->next = right;
+    }
+    else
+    {
+        // 가운데 키는 부모로 올라감
+        right->count = node->count - half - 1;
+        memcpy(right->keys, &node->keys[half + 1], sizeof(TreeKey) * right->count);
+        memcpy(right->pointers, &node->pointers[half + 1], sizeof(void *) * (right->count + 1));
+        *split_key = node->keys[half];
+    }
+    node->count = half;
 
-        wcscpy(client->phone_number, input[4]);
+    return right;
+}
+void *remove_tree(Tree *tree, const TreeKey *key)
+{
+    TreeNode *leaf = find_tree_leaf(tree, key);
+    if (leaf == NULL)
+        return NULL;
 
-        node->contents = (void *)client;
-        if (pre_node != NULL)
-            pre_node->next = node;
-        pre_node = node;
+    const int position = search_tree_node(leaf, key, 0);
+    if (position >= leaf->count || compare_tree_key(&leaf->keys[position], key) != 0)
+        return NULL;
+
+    void *value = leaf->pointers[position];
+    memmove(&leaf->keys[position], &leaf->keys[position + 1], sizeof(TreeKey) * (leaf->count - position - 1));
+    memmove(&leaf->pointers[position], &leaf->pointers[position + 1], sizeof(void *) * (leaf->count - position - 1));
+    leaf->count--;
+    tree->count--;
+
+    return value;
+}
+void seek_tree(const Tree *tree, const TreeKey *key, TreeCursor *cursor)
+{
+    cursor->node = find_tree_leaf(tree, key);
+    cursor->position = cursor->node != NULL ? search_tree_node(cursor->node, key, 0) : 0;
+}
+_Bool next_tree(TreeCursor *cursor, TreeKey *key, void **value)
+{
+    while (cursor->node != NULL && cursor->position >= cursor->node->count)
+    {
+        cursor->node = cursor->node->next;
+        cursor->position = 0;
     }
+    if (cursor->node == NULL)
+        return 0;
 
-    fclose(file_pointer);
-    return first_node;
+    if (key != NULL)
+        *key = cursor->node->keys[cursor->position];
+    if (value != NULL)
+        *value = cursor->node->pointers[cursor->position];
+    cursor->position++;
+    return 1;
 }
-LinkedList *init_books(const char *file_name)
+_Bool prev_tree(TreeCursor *cursor, TreeKey *key, void **value)
 {
-    FILE *file_pointer;
-    file_pointer = fopen(file_name, "r+");
-    if (file_pointer == NULL)
+    while (cursor->node != NULL && cursor->position <= 0)
+    {
+        cursor->node = cursor->node->prev;
+        cursor->position = cursor->node != NULL ? cursor->node->count : 0;
+    }
+    if (cursor->node == NULL)
+        return 0;
+
+    cursor->position--;
+    if (key != NULL)
+        *key = cursor->node->keys[cursor->position];
+    if (value != NULL)
+        *value = cursor->node->pointers[cursor->position];
+    return 1;
+}
+size_t get_tree_values(const Tree *tree, void **values)
+{
+    TreeCursor cursor;
+    const TreeKey key = {0, 0};
+    size_t count = 0;
+
+    for (seek_tree(tree, &key, &cursor); next_tree(&cursor, NULL, &values[count]);)
+        count++;
+    return count;
+}
+void destroy_tree(Tree *tree)
+{
+    destroy_tree_node(tree->root);
+    tree->root = NULL;
+    tree->count = 0;
+}
+void destroy_tree_node(TreeNode *node)
+{
+    if (node == NULL)
+        return;
+    if (!node->is_leaf)
+        for (int i = 0; i <= node->count; i++)
+            destroy_tree_node(node->pointers[i]);
+    free(node);
+}
+
+int compare_book_order(const Book *a, const Book *b)
+{
+    if (a->ISBN != b->ISBN)
+        return a->ISBN < b->ISBN ? -1 : 1;
+    if (a->number != b->number)
+        return a->number < b->number ? -1 : 1;
+    return 0;
+}
+void init_posting_index(PostingIndex *index, const size_t field_offset)
+{
+    memset(index, 0, sizeof(PostingIndex));
+    index->field_offset = field_offset;
+}
+const char *get_posting_term(const PostingIndex *index, const Book *book)
+{
+    return *(char *const *)((const char *)book + index->field_offset);
+}
+uint64_t get_term_hash(const char *term)
+{
+    uint64_t hash = 14695981039346656037ULL;
+
+    for (; *term != '\0'; term++)
+    {
+        hash ^= (uint64_t)(unsigned char)*term;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+Postings *find_postings(const PostingIndex *index, const char *term)
+{
+    if (index->count == 0)
         return NULL;
 
-    LinkedList *node = NULL;
-    LinkedList *first_node = NULL;
-    LinkedList *pre_node = NULL;
-    Book *book = NULL;
-    wchar_t input[6][SIZE_INPUT_MAX] = {0};
-    wchar_t availability[2];
-
-    while (ftell(file_pointer) != EOF)
-    {
-        if (read_string_by_token(file_pointer, L" | ", 3, input[0]) == EOF ||
-            read_string_by_token(file_pointer, L" | ", 3, input[1]) == EOF ||
-            read_string_by_token(file_pointer, L" | ", 3, input[2]) == EOF ||
-            read_string_by_token(file_pointer, L" | ", 3, input[3]) == EOF ||
-            read_string_by_token(file_pointer, L" | ", 3, input[4]) == EOF ||
-            read_string_by_token(file_pointer, L" | ", 3, input[5]) == EOF ||
-            read_string_by_token(file_pointer, L" | ", 3, availability) == EOF)
-            break;
+    const uint64_t hash = get_term_hash(term);
+    const size_t mask = index->capacity - 1;
 
-        node = malloc(sizeof(LinkedList));
-        node->next = NULL;
-        if (first_node == NULL)
-            first_node = node;
-        book = malloc(sizeof(Book));
+    for (size_t position = hash & mask; index->slots[position].books != NULL; position = (position + 1) & mask)
+        if (index->slots[position].hash == hash && (get_posting_term(index, index->slots[position].books[0]) == term || strcmp(get_posting_term(index, index->slots[position].books[0]), term) == 0))
+            return &index->slots[position];
+    return NULL;
+}
+void insert_posting(PostingIndex *index, Book *book)
+{
+    const char *term = get_posting_term(index, book);
+    if (term == NULL)
+        return;
+
+    Postings *postings = find_postings(index, term);
+    if (postings == NULL)
+    {
+        // 절반 이상 차면 늘림
+        if ((index->count + 1) * 2 > index->capacity)
+            resize_posting_index(index, index->capacity == 0 ? SIZE_POSTING_INDEX_MIN : index->capacity * 2);
+
+        const uint64_t hash = get_term_hash(term);
+        const size_t mask = index->capacity - 1;
+        size_t position = hash & mask;
+        while (index->slots[position].books != NULL)
+            position = (position + 1) & mask;
+
+        postings = &index->slots[position];
+        postings->hash = hash;
+        postings->count = 0;
+        postings->capacity = 1;
+        postings->books = malloc(sizeof(Book *));
+        index->count++;
+    }
+    if (postings->count == postings->capacity)
+    {
+        postings->capacity *= 2;
+        postings->books = realloc(postings->books, sizeof(Book *) * postings->capacity);
+    }
+
+    // 보통 뒤쪽에 들어가므로 뒤에서부터 자리를 찾음
+    size_t position = postings->count;
+    while (position > 0 && compare_book_order(postings->books[position - 1], book) > 0)
+        position--;
+    memmove(&postings->books[position + 1], &postings->books[position], sizeof(Book *) * (postings->count - position));
+    postings->books[position] = book;
+    postings->count++;
+}
+void remove_posting(PostingIndex *index, const Book *book)
+{
+    const char *term = get_posting_term(index, book);
+    if (term == NULL)
+        return;
+
+    Postings *postings = find_postings(index, term);
+    if (postings == NULL)
+        return;
 
-        wcscpy(book->number, input[0]);
+    size_t position = 0;
+    while (position < postings->count && postings->books[position] != book)
+        position++;
+    if (position == postings->count)
+        return;
+    memmove(&postings->books[position], &postings->books[position + 1], sizeof(Book *) * (postings->count - position - 1));
+    postings->count--;
+    if (postings->count > 0)
+        return;
+
+    // 빈 슬롯 뒤의 슬롯 중 원래 자리로 갈 수 있는 것을 당겨옴
+    const size_t mask = index->capacity - 1;
+    size_t empty = postings - index->slots;
+    size_t home = 0;
+    free(postings->books);
+    for (position = (empty + 1) & mask; index->slots[position].books != NULL; position = (position + 1) & mask)
+    {
+        home = index->slots[position].hash & mask;
+        if (((position - home) & mask) >= ((position - empty) & mask))
+        {
+            index->slots[empty] = index->slots[position];
+            empty = position;
+        }
+    }
+    index->slots[empty].books = NULL;
+    index->count--;
+}
+void resize_posting_index(PostingIndex *index, const size_t capacity)
+{
+    Postings *old_slots = index->slots;
+    const size_t old_capacity = index->capacity;
+    const size_t mask = capacity - 1;
+    size_t position = 0;
+
+    index->slots = calloc(capacity, sizeof(Postings));
+    index->capacity = capacity;
+    for (size_t i = 0; i < old_capacity; i++)
+    {
+        if (old_slots[i].books == NULL)
+            continue;
+        for (position = old_slots[i].hash & mask; index->slots[position].books != NULL; position = (position + 1) & mask)
+            ;
+        index->slots[position] = old_slots[i];
+    }
+    free(old_slots);
+}
+void destroy_posting_index(PostingIndex *index)
+{
+    for (size_t i = 0; i < index->capacity; i++)
+        free(index->slots[i].books);
+    free(index->slots);
+    init_posting_index(index, index->field_offset);
+}
+uint64_t get_gram(const wchar_t *text, const size_t length, const size_t position)
+{
+    const size_t size = text[position] >= GRAM_HANGUL_FIRST && text[position] <= GRAM_HANGUL_LAST ? GRAM_HANGUL_SIZE : GRAM_OTHER_SIZE;
+    if (position + size > length)
+        return 0;
+
+    // 글자를 21비트씩 넣고, 바이그램은 마지막 자리를 비워 둠
+    uint64_t gram = 0;
+    wchar_t character = 0;
+    for (size_t i = 0; i < GRAM_OTHER_SIZE; i++)
+    {
+        gram <<= GRAM_CHAR_BITS;
+        if (i >= size)
+            continue;
+        character = fold_character(text[position + i]);
+        gram |= (uint64_t)character & ((1u << GRAM_CHAR_BITS) - 1);
+    }
+    return gram;
+}
+wchar_t fold_character(wchar_t character)
+{
+    if (character >= L'A' && character <= L'Z')
+        return character + (L'a' - L'A');
+    if (character >= 0x80 && (character < GRAM_HANGUL_FIRST || character > GRAM_HANGUL_LAST))
+        return towlower(character);
+    return character;
+}
+GramPostings *find_gram(const GramIndex *index, const uint64_t gram)
+{
+    if (index->count == 0)
+        return NULL;
+
+    const size_t mask = index->capacity - 1;
+    size_t position = (gram * 11400714819323198485ULL) >> 32 & mask;
+
+    for (; index->slots[position].numbers != NULL; position = (position + 1) & mask)
+        if (index->slots[position].gram == gram)
+            return &index->slots[position];
+    return NULL;
+}
+void insert_gram(GramIndex *index, const uint64_t gram, const uint32_t number)
+{
+    GramPostings *postings = find_gram(index, gram);
+    if (postings == NULL)
+    {
+        if ((index->count + 1) * 2 > index->capacity)
+            resize_gram_index(index, index->capacity == 0 ? SIZE_GRAM_INDEX_MIN : index->capacity * 2);
+
+        const size_t mask = index->capacity - 1;
+        size_t position = (gram * 11400714819323198485ULL) >> 32 & mask;
+        while (index->slots[position].numbers != NULL)
+            position = (position + 1) & mask;
+
+        postings = &index->slots[position];
+        postings->gram = gram;
+        postings->count = 0;
+        postings->capacity = 4;
+        postings->numbers = malloc(sizeof(uint32_t) * postings->capacity);
+        index->count++;
+    }
+
+    // 같은 도서의 같은 그램은 연속으로 들어옴
+    if (postings->count > 0 && postings->numbers[postings->count - 1] == number)
+        return;
+    if (postings->count == postings->capacity)
+    {
+        postings->capacity *= 2;
+        postings->numbers = realloc(postings->numbers, sizeof(uint32_t) * postings->capacity);
+    }
+
+    // 새 도서 번호는 가장 크므로 보통 뒤에 붙음
+    uint32_t position = postings->count;
+    if (!index->is_building)
+    {
+        while (position > 0 && postings->numbers[position - 1] > number)
+            position--;
+        if (position > 0 && postings->numbers[position - 1] == number)
+            return;
+        memmove(&postings->numbers[position + 1], &postings->numbers[position], sizeof(uint32_t) * (postings->count - position));
+    }
+    postings->numbers[position] = number;
+    postings->count++;
+}
+void remove_gram(GramIndex *index, const uint64_t gram, const uint32_t number)
+{
+    GramPostings *postings = find_gram(index, gram);
+    if (postings == NULL)
+        return;
 
-        book->name = malloc(sizeof(wchar_t) * (wcslen(input[1]) + 1));
-        wcscpy(book->name, input[1]);
+    uint32_t *found = NULL;
+    if (index->is_building)
+    {
+        for (uint32_t i = 0; i < postings->count && found == NULL; i++)
+            if (postings->numbers[i] == number)
+                found = &postings->numbers[i];
+    }
+    else
+        found = bsearch(&number, postings->numbers, postings->count, sizeof(uint32_t), compare_number);
+    if (found == NULL)
+        return;
+
+    memmove(found, found + 1, sizeof(uint32_t) * (postings->count - (found - postings->numbers) - 1));
+    postings->count--;
+}
+void update_text_grams(GramIndex *index, const char *text, const uint32_t number, const _Bool is_insert)
+{
+    if (text == NULL)
+        return;
 
-        book->publisher = malloc(sizeof(wchar_t) * (wcslen(input[2]) + 1));
-        wcscpy(book->publisher, input[2]);
+    wchar_t string[SIZE_TEXT_MAX];
+    const size_t length = decode_text(text, string, SIZE_TEXT_MAX);
+    uint64_t gram = 0;
+    for (size_t i = 0; i < length; i++)
+    {
+        gram = get_gram(string, length, i);
+        if (gram == 0)
+            continue;
+        if (is_insert)
+            insert_gram(index, gram, number);
+        else
+            remove_gram(index, gram, number);
+    }
+}
+void finish_gram_index(GramIndex *index)
+{
+    if (!index->is_building)
+        return;
 
-        book->author = malloc(sizeof(wchar_t) * (wcslen(input[3]) + 1));
-        wcscpy(book->author, input[3]);
+    GramPostings *postings = NULL;
+    uint32_t count = 0;
+    for (size_t i = 0; i < index->capacity; i++)
+    {
+        postings = &index->slots[i];
+        if (postings->numbers == NULL)
+            continue;
+
+        // 파일이 번호 순이면 이미 정렬되어 있음
+        for (count = 1; count < postings->count && postings->numbers[count - 1] < postings->numbers[count]; count++)
+            ;
+        if (count >= postings->count)
+            continue;
+
+        qsort(postings->numbers, postings->count, sizeof(uint32_t), compare_number);
+        count = 0;
+        for (uint32_t j = 0; j < postings->count; j++)
+            if (count == 0 || postings->numbers[count - 1] != postings->numbers[j])
+                postings->numbers[count++] = postings->numbers[j];
+        postings->count = count;
+    }
+    index->is_building = 0;
+}
+void resize_gram_index(GramIndex *index, const size_t capacity)
+{
+    GramPostings *old_slots = index->slots;
+    const size_t old_capacity = index->capacity;
+    const size_t mask = capacity - 1;
+    size_t position = 0;
+
+    index->slots = calloc(capacity, sizeof(GramPostings));
+    index->capacity = capacity;
+    for (size_t i = 0; i < old_capacity; i++)
+    {
+        if (old_slots[i].numbers == NULL)
+            continue;
+        for (position = (old_slots[i].gram * 11400714819323198485ULL) >> 32 & mask; index->slots[position].numbers != NULL; position = (position + 1) & mask)
+            ;
+        index->slots[position] = old_slots[i];
+    }
+    free(old_slots);
+}
+void destroy_gram_index(GramIndex *index)
+{
+    for (size_t i = 0; i < index->capacity; i++)
+        free(index->slots[i].numbers);
+    free(index->slots);
+    memset(index, 0, sizeof(GramIndex));
+}
+_Bool has_keyword(const char *text, const wchar_t *keyword)
+{
+    if (text == NULL)
+        return 0;
 
-        wcscpy(book->ISBN, input[4]);
+    wchar_t string[SIZE_TEXT_MAX];
+    decode_text(text, string, SIZE_TEXT_MAX);
 
-        book->location = malloc(sizeof(wchar_t) * (wcslen(input[5]) + 1));
-        wcscpy(book->location, input[5]);
+    size_t i = 0;
+    for (const wchar_t *now = string; *now != L'\0'; now++)
+    {
+        for (i = 0; keyword[i] != L'\0' && towlower(now[i]) == towlower(keyword[i]); i++)
+            ;
+        if (keyword[i] == L'\0')
+            return 1;
+    }
+    return 0;
+}
+int compare_number(const void *a, const void *b)
+{
+    const uint32_t a_number = *(const uint32_t *)a;
+    const uint32_t b_number = *(const uint32_t *)b;
 
-        book->availability = availability[0];
+    return a_number < b_number ? -1 : a_number > b_number;
+}
+uint32_t seek_numbers(const uint32_t *numbers, const uint32_t count, uint32_t position, const uint32_t number)
+{
+    uint32_t step = 1;
 
-        node->contents = (void *)book;
-        if (pre_node != NULL)
-            pre_node->next = node;
-        pre_node = node;
+    while (position + step < count && numbers[position + step] < number)
+    {
+        position += step;
+        step *= 2;
     }
-
-    fclose(file_pointer);
-    return first_node;
+    for (; step > 0; step /= 2)
+        if (position + step <= count && numbers[position + step - 1] < number)
+            position += step;
+    // position 앞까지는 모두 number보다 작음
+    return position < count && numbers[position] < number ? position + 1 : position;
 }
-LinkedList *init_borrows(const char *file_name)
+int compare_book_pointer(const void *a, const void *b)
 {
-    FILE *file_pointer;
-    file_pointer = fopen(file_name, "r+");
-    if (file_pointer == NULL)
+    return compare_book_order(*(Book *const *)a, *(Book *const *)b);
+}
+void append_books(Book ***books, size_t *count, size_t *capacity, Book *const *added, const size_t added_count)
+{
+    if (*count + added_count > *capacity)
+    {
+        while (*count + added_count > *capacity)
+            *capacity = *capacity == 0 ? 16 : *capacity * 2;
+        *books = realloc(*books, sizeof(Book *) * *capacity);
+    }
+    memcpy(*books + *count, added, sizeof(Book *) * added_count);
+    *count += added_count;
+}
+LinkedList *create_books_list(Book **books, const size_t count)
+{
+    if (count == 0)
         return NULL;
+    qsort(books, count, sizeof(Book *), compare_book_pointer);
 
+    LinkedList *result = NULL;
     LinkedList *node = NULL;
-    LinkedList *first_node = NULL;
-    LinkedList *pre_node = NULL;
-    Borrow *borrow = NULL;
-    wchar_t input[5][SIZE_INPUT_MAX] = {0};
-    long long date[2] = {0};
-
-    while (ftell(file_pointer) != EOF)
+    for (size_t i = count; i > 0; i--)
     {
-
-        if (read_string_by_token(file_pointer, L" | ", 3, input[0]) == EOF ||
-            read_string_by_token(file_pointer, L" | ", 3, input[1]) == EOF ||
-            read_string_by_token(file_pointer, L" | ", 3, input[2]) == EOF ||
-            read_string_by_token(file_pointer, L" | ", 3, input[3]) == EOF ||
-            read_string_by_token(file_pointer, L" | ", 3, input[4]) == EOF
-           )
-            break;
-        if (swscanf(input[3], L"%lld", &date[0]) == EOF ||
-            swscanf(input[4], L"%lld", &date[1]) == EOF
-           )
-            break;
-        
+        // 여러 필드가 맞은 도서는 한 번만 넣음
+        if (result != NULL && result->contents == books[i - 1])
+            continue;
         node = malloc(sizeof(LinkedList));
-        node->next = NULL;
-        if (first_node == NULL)
-            first_node = node;
-        borrow = malloc(sizeof(Borrow));
-
-        wcscpy(borrow->student_number, input[0]);
-
-        borrow->book_name = malloc(sizeof(wchar_t) * (wcslen(input[1]) + 1));
-        wcscpy(borrow->book_name, input[1]);
-
-        wcscpy(borrow->book_number, input[2]);
-
-        borrow->loan_date = (time_t)date[0];
-        borrow->return_date = (time_t)date[1];
+        node->contents = books[i - 1];
+        node->next = result;
+        result = node;
+    }
+    return result;
+}
+void init_fuzzy_pattern(FuzzyPattern *pattern, const wchar_t *query)
+{
+    memset(pattern, 0, sizeof(FuzzyPattern));
+    pattern->length = wcslen(query);
+    pattern->word_count = (pattern->length + FUZZY_WORD_BITS - 1) / FUZZY_WORD_BITS;
 
-        node->contents = (void *)borrow;
-        if (pre_node != NULL)
-            pre_node->next = node;
-        pre_node = node;
+    wchar_t character = 0;
+    size_t position = 0;
+    for (size_t i = 0; i < pattern->length; i++)
+    {
+        // 0은 빈 슬롯이므로 글자는 항상 0이 아님
+        character = fold_character(query[i]);
+        for (position = (size_t)character * 2654435769u % SIZE_FUZZY_TABLE; pattern->slots[position].character != 0 && pattern->slots[position].character != character; position = (position + 1) % SIZE_FUZZY_TABLE)
+            ;
+        pattern->slots[position].character = character;
+        pattern->slots[position].masks[i / FUZZY_WORD_BITS] |= (uint64_t)1 << (i % FUZZY_WORD_BITS);
     }
+}
+const uint64_t *get_fuzzy_masks(const FuzzyPattern *pattern, const wchar_t character)
+{
+    size_t position = (size_t)character * 2654435769u % SIZE_FUZZY_TABLE;
 
-    fclose(file_pointer);
-    return first_node;
+    for (; pattern->slots[position].character != 0; position = (position + 1) % SIZE_FUZZY_TABLE)
+        if (pattern->slots[position].character == character)
+            return pattern->slots[position].masks;
+    return NULL;
 }
+size_t get_edit_distance(const FuzzyPattern *pattern, const wchar_t *text, const size_t text_length, const size_t max_distance)
+{
+    if (pattern->length == 0)
+        return text_length;
+
+    uint64_t positive[FUZZY_WORD_COUNT];
+    uint64_t negative[FUZZY_WORD_COUNT];
+    const uint64_t last_bit = (uint64_t)1 << ((pattern->length - 1) % FUZZY_WORD_BITS);
+    const uint64_t *masks = NULL;
+    uint64_t equal = 0, vertical = 0, horizontal = 0, plus = 0, minus = 0, high = 0;
+    int carry = 0, out = 0;
+    size_t distance = pattern->length;
+
+    // 세로 차이는 모두 +1에서 시작함
+    for (size_t word = 0; word < pattern->word_count; word++)
+    {
+        positive[word] = ~(uint64_t)0;
+        negative[word] = 0;
+    }
 
-Book *create_book(const LinkedList *book_list, const wchar_t *name, const wchar_t *publisher, const wchar_t *author, const wchar_t *ISBN, const wchar_t *location)
-{
-    Book *book_p = malloc(sizeof(Book));
-    int len;
-
-    len = wcslen(name);
-    book_p->name = malloc(sizeof(wchar_t) * (len + 1));
-    wcscpy(book_p->name, name);
-    len = wcslen(publisher);
-    book_p->publisher = malloc(sizeof(wchar_t) * (len + 1));
-    wcscpy(book_p->publisher, publisher);
-    len = wcslen(author);
-    book_p->author = malloc(sizeof(wchar_t) * (len + 1));
-    wcscpy(book_p->author, author);
-    len = wcslen(location);
-    book_p->location = malloc(sizeof(wchar_t) * (len + 1));
-    wcscpy(book_p->location, location);
-    wcscpy(book_p->ISBN, ISBN);
-    book_p->availability = L'Y';
+    for (size_t i = 0; i < text_length; i++)
+    {
+        masks = get_fuzzy_masks(pattern, fold_character(text[i]));
+        // 첫 행은 열마다 1씩 늘어남
+        carry = 1;
+        for (size_t word = 0; word < pattern->word_count; word++)
+        {
+            high = word + 1 == pattern->word_count ? last_bit : (uint64_t)1 << (FUZZY_WORD_BITS - 1);
+            equal = masks != NULL ? masks[word] : 0;
+            vertical = equal | negative[word];
+            if (carry < 0)
+                equal |= 1;
+            horizontal = (((equal & positive[word]) + positive[word]) ^ positive[word]) | equal;
+            plus = negative[word] | ~(horizontal | positive[word]);
+            minus = positive[word] & horizontal;
+
+            out = (plus & high) ? 1 : (minus & high) ? -1 : 0;
+            plus <<= 1;
+            minus <<= 1;
+            if (carry < 0)
+                minus |= 1;
+            else if (carry > 0)
+                plus |= 1;
+            positive[word] = minus | ~(vertical | plus);
+            negative[word] = plus & vertical;
+            carry = out;
+        }
+        distance += carry;
 
-    const LinkedList *current = book_list; //여기서부터는 가장 최근의(큰) 도서번호를 구하는 과정임
-    const LinkedList *largest = current;
+        // 남은 글자로 모두 줄여도 허용 거리보다 크면 멈춤
+        if (distance > max_distance + (text_length - i - 1))
+            return max_distance + 1;
+    }
+    return distance;
+}
+int get_choseong(const wchar_t character)
+{
+    // 호환용 자모의 자음 중 초성으로 쓰이는 것
+    static const wchar_t consonants[CHOSEONG_COUNT] = {
+        0x3131, 0x3132, 0x3134, 0x3137, 0x3138, 0x3139, 0x3141, 0x3142, 0x3143, 0x3145,
+        0x3146, 0x3147, 0x3148, 0x3149, 0x314A, 0x314B, 0x314C, 0x314D, 0x314E};
+
+    if (character >= GRAM_HANGUL_FIRST && character <= GRAM_HANGUL_LAST)
+        return (character - GRAM_HANGUL_FIRST) / CHOSEONG_SYLLABLE_COUNT + 1;
+    for (int i = 0; i < CHOSEONG_COUNT; i++)
+        if (consonants[i] == character)
+            return i + 1;
+    return 0;
+}
+uint64_t get_choseong_key(const wchar_t *text, size_t *length)
+{
+    uint64_t key = 0;
+    size_t count = 0;
+    int choseong = 0;
 
-    while (current != NULL)
+    for (; text != NULL && *text != L'\0'; text++)
     {
-        current = current->next;
-        if (current == NULL)
-            break;
-        if (wcscmp(((Book *)current->contents)->number, ((Book *)largest->contents)->number) > 0)
-            largest = current;
+        choseong = get_choseong(*text);
+        if (choseong == 0)
+            continue;
+        if (count < CHOSEONG_KEY_SIZE)
+            key |= (uint64_t)choseong << (CHOSEONG_KEY_SIZE - count - 1) * CHOSEONG_BITS;
+        count++;
     }
-
-    int largest_num;
-    if (book_list == NULL)
-        largest_num = 0;
-    else
-        swscanf(((Book *)(largest->contents))->number, L"%d", &largest_num);
-    swprintf(book_p->number, SIZE_BOOK_NUMBER + 1, L"%07d", largest_num + 1);
-
-    return book_p;
+    if (length != NULL)
+        *length = count;
+    return key;
 }
-Borrow *create_borrow(Client *client, Book *book)
+uint64_t get_choseong_mask(const size_t length)
 {
-    Borrow *borrow_p = (Borrow *)malloc(sizeof(Borrow));
-    borrow_p->loan_date = time(NULL);
-    struct tm *t;
-    t = localtime(&borrow_p->loan_date);
+    const size_t size = length < CHOSEONG_KEY_SIZE ? length : CHOSEONG_KEY_SIZE;
+    const uint64_t all = ((uint64_t)1 << CHOSEONG_KEY_SIZE * CHOSEONG_BITS) - 1;
 
-    wcscpy(borrow_p->student_number, client->student_number);
-    wcscpy(borrow_p->book_number, book->number);
+    return all & ~(((uint64_t)1 << (CHOSEONG_KEY_SIZE - size) * CHOSEONG_BITS) - 1);
+}
+void update_title(TitleTrie *trie, const wchar_t *title, const int book_delta, const int64_t loan_delta)
+{
+    if (title == NULL)
+        return;
+    if (trie->root == NULL)
+    {
+        if (book_delta <= 0)
+            return;
+        trie->root = create_title_node(L"", 0);
+    }
 
-    if ((t->tm_wday + 30) / 7 == 0) //(t->tm_wday+30)/7==30일 뒤의 요일
-        borrow_p->return_date = borrow_p->loan_date + 31 * 24 * 60 * 60;
-    else
-        borrow_p->return_date = borrow_p->loan_date + 30 * 24 * 60 * 60;
-    borrow_p->book_name = malloc(sizeof(wchar_t) * (wcslen(book->name) + 1));
-    wcscpy(borrow_p->book_name, book->name);
+    TitleNode **path = malloc(sizeof(TitleNode *) * (wcslen(title) + 1));
+    size_t depth = 0;
+    TitleNode *node = trie->root;
+    TitleNode *child = NULL;
+    TitleNode *middle = NULL;
+    const wchar_t *rest = title;
+    size_t position = 0;
+    size_t common = 0;
+
+    path[depth++] = node;
+    while (*rest != L'\0')
+    {
+        child = find_title_child(node, *rest, &position);
+        if (child == NULL)
+        {
+            if (book_delta <= 0)
+            {
+                free(path);
+                return;
+            }
+            child = create_title_node(rest, wcslen(rest));
+            node->children = realloc(node->children, sizeof(TitleNode *) * (node->child_count + 1));
+            memmove(&node->children[position + 1], &node->children[position], sizeof(TitleNode *) * (node->child_count - position));
+            node->children[position] = child;
+            node->child_count++;
+        }
+        else
+        {
+            for (common = 0; common < child->label_length && rest[common] == child->label[common]; common++)
+                ;
+            if (common < child->label_length)
+            {
+                if (book_delta <= 0)
+                {
+                    free(path);
+                    return;
+                }
+                // 레이블을 공통 부분에서 나눔
+                middle = create_title_node(child->label, common);
+                wmemmove(child->label, child->label + common, child->label_length - common + 1);
+                child->label_length -= common;
+                middle->children = malloc(sizeof(TitleNode *));
+                middle->children[0] = child;
+                middle->child_count = 1;
+                memcpy(middle->top, child->top, sizeof(child->top));
+                middle->top_count = child->top_count;
+                node->children[position] = middle;
+                child = middle;
+            }
+        }
+        rest += child->label_length;
+        node = child;
+        path[depth++] = node;
+    }
 
-    return borrow_p;
-}
+    TitleEntry *entry = node->entry;
+    if (entry == NULL)
+    {
+        if (book_delta <= 0)
+        {
+            free(path);
+            return;
+        }
+        entry = calloc(1, sizeof(TitleEntry));
+        entry->title = malloc(sizeof(wchar_t) * (wcslen(title) + 1));
+        wcscpy(entry->title, title);
+        node->entry = entry;
+        trie->count++;
+    }
+    entry->book_count += book_delta;
+    entry->loan_count += loan_delta;
 
-void print_client(const Client *client)
-{
-    // admin이였을 때는 출력 하지 않음.
-    if (wcscmp(L"admin", client->student_number) == 0)
+    // 순위가 오르기만 하면 경로의 목록에 넣기만 함
+    if (loan_delta >= 0 && entry->book_count > 0)
+    {
+        for (size_t i = 0; i < depth; i++)
+            raise_title_top(path[i], entry);
+        free(path);
         return;
-    wprintf(
-        L"학번 : %ls \n"
-        L"이름 : %ls \n"
-        L"전화번호 : %ls \n"
-        L"주소 : %ls \n",
-        client->student_number, client->name, client->phone_number, client->address);
+    }
+
+    if (entry->book_count == 0)
+        node->entry = NULL;
+    for (size_t i = depth; i > 0; i--)
+    {
+        node = path[i - 1];
+        // 제목이 없어진 노드는 지우거나 하나뿐인 자식과 합침
+        if (i > 1 && node->entry == NULL && node->child_count <= 1)
+        {
+            TitleNode *parent = path[i - 2];
+            find_title_child(parent, node->label[0], &position);
+            if (node->child_count == 0)
+            {
+                memmove(&parent->children[position], &parent->children[position + 1], sizeof(TitleNode *) * (parent->child_count - position - 1));
+                parent->child_count--;
+            }
+            else
+            {
+                child = node->children[0];
+                wchar_t *label = malloc(sizeof(wchar_t) * (node->label_length + child->label_length + 1));
+                wmemcpy(label, node->label, node->label_length);
+                wmemcpy(label + node->label_length, child->label, child->label_length + 1);
+                free(child->label);
+                child->label = label;
+                child->label_length += node->label_length;
+                parent->children[position] = child;
+                node->child_count = 0;
+            }
+            destroy_title_node(node);
+            continue;
+        }
+        build_title_top(node);
+    }
+    if (entry->book_count == 0)
+    {
+        free(entry->title);
+        free(entry);
+        trie->count--;
+    }
+    free(path);
 }
-void print_book(const Book *book)
+int compare_title_entry(const TitleEntry *a, const TitleEntry *b)
 {
-    wprintf(
-        L"도서명 : %ls \n"
-        L"출판사 : %ls \n"
-        L"저자명 : %ls \n"
-        L"ISBN : %ls \n"
-        L"소장처 : %ls \n"
-        L"대여가능 여부 : %lc \n",
-        book->name, book->publisher, book->author, book->ISBN, book->location, book->availability);
+    if (a->loan_count != b->loan_count)
+        return a->loan_count > b->loan_count ? -1 : 1;
+    return wcscmp(a->title, b->title);
 }
-void print_borrow(const Borrow *borrow)
+TitleNode *create_title_node(const wchar_t *label, const size_t length)
 {
-    struct tm *t;
+    TitleNode *node = calloc(1, sizeof(TitleNode));
+    node->label = malloc(sizeof(wchar_t) * (length + 1));
+    wmemcpy(node->label, label, length);
+    node->label[length] = L'\0';
+    node->label_length = length;
 
-    t = localtime(&(borrow->loan_date));
+    return node;
+}
+TitleNode *find_title_child(const TitleNode *node, const wchar_t character, size_t *position)
+{
+    size_t low = 0;
+    size_t high = node->child_count;
+    size_t middle = 0;
 
-    wprintf(
-        L"도서번호 : %ls \n"
-        L"도서명 : %ls \n"
-        L"대여일자 : %d년 %d월 %d일 ",
-        borrow->book_number, borrow->book_name, t->tm_year + 1900, t->tm_mon + 1, t->tm_mday);
+    while (low < high)
+    {
+        middle = (low + high) / 2;
+        if (node->children[middle]->label[0] < character)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    *position = low;
+    if (low < node->child_count && node->children[low]->label[0] == character)
+        return node->children[low];
+    return NULL;
+}
+void raise_title_top(TitleNode *node, TitleEntry *entry)
+{
+    size_t position = 0;
+    while (position < node->top_count && node->top[position] != entry)
+        position++;
 
-    switch (t->tm_wday)
+    if (position == node->top_count)
     {
-    case 0:
-        wprintf(L"일요일\n");
-        break;
-    case 1:
-        wprintf(L"월요일\n");
-        break;
-    case 2:
-        wprintf(L"화요일\n");
-        break;
-    case 3:
-        wprintf(L"수요일\n");
-        break;
-    case 4:
-        wprintf(L"목요일\n");
-        break;
-    case 5:
-        wprintf(L"금요일\n");
-        break;
-    case 6:
-        wprintf(L"토요일\n");
-        break;
-    default:
-        break;
+        if (node->top_count < SIZE_SUGGESTION)
+            node->top_count++;
+        else if (compare_title_entry(entry, node->top[SIZE_SUGGESTION - 1]) < 0)
+            position = SIZE_SUGGESTION - 1;
+        else
+            return;
     }
-    t = localtime(&(borrow->return_date));
-    wprintf(L"반납일자 : %d년 %d월 %d일 ", t->tm_year + 1900, t->tm_mon + 1, t->tm_mday);
-    switch (t->tm_wday)
+
+    // 앞의 제목보다 많이 대여되었으면 앞으로 옮김
+    while (position > 0 && compare_title_entry(entry, node->top[position - 1]) < 0)
     {
-    case 0:
-        wprintf(L"일요일\n");
-        break;
-    case 1:
-        wprintf(L"월요일\n");
-        break;
-    case 2:
-        wprintf(L"화요일\n");
-        break;
-    case 3:
-        wprintf(L"수요일\n");
-        break;
-    case 4:
-        wprintf(L"목요일\n");
-        break;
-    case 5:
-        wprintf(L"금요일\n");
-        break;
-    case 6:
-        wprintf(L"토요일\n");
-        break;
-    default:
-        break;
+        node->top[position] = node->top[position - 1];
+        position--;
     }
+    node->top[position] = entry;
 }
-void print_clients(const LinkedList *client_list)
+void build_title_top(TitleNode *node)
 {
-    const LinkedList *current = client_list;
-    while (current != NULL)
+    node->top_count = 0;
+    if (node->entry != NULL)
+        raise_title_top(node, node->entry);
+    for (size_t i = 0; i < node->child_count; i++)
+        for (size_t j = 0; j < node->children[i]->top_count; j++)
+            raise_title_top(node, node->children[i]->top[j]);
+}
+void destroy_title_trie(TitleTrie *trie)
+{
+    destroy_title_node(trie->root);
+    trie->root = NULL;
+    trie->count = 0;
+}
+void destroy_title_node(TitleNode *node)
+{
+    if (node == NULL)
+        return;
+
+    for (size_t i = 0; i < node->child_count; i++)
+        destroy_title_node(node->children[i]);
+    if (node->entry != NULL)
     {
-        wprintf(L"\n");
-        print_client(current->contents);
-        current = current->next;
+        free(node->entry->title);
+        free(node->entry);
     }
-    return;
+    free(node->children);
+    free(node->label);
+    free(node);
 }
-void print_books(const LinkedList *book_list)
+_Bool has_choseong_prefix(const char *text, const wchar_t *prefix)
 {
-    const LinkedList *current = book_list;
-    while (current != NULL)
+    int choseong = 0;
+    wchar_t character = 0;
+
+    // 앞에서부터 보므로 한 글자씩 변환함
+    for (; *prefix != L'\0'; prefix++)
     {
-        wprintf(L"\n");
-        print_book(current->contents);
-        current = current->next;
+        choseong = get_choseong(*prefix);
+        if (choseong == 0)
+            continue;
+        while ((character = next_text_character(&text)) != L'\0' && get_choseong(character) == 0)
+            ;
+        if (character == L'\0' || get_choseong(character) != choseong)
+            return 0;
     }
-    return;
+    return 1;
+}
+void find_borrows_by_client(const BorrowIndex *index, const Client *client, BorrowCursor *cursor)
+{
+    const TreeKey key = {client != NULL ? client->student_number : STUDENT_NUMBER_NONE, 0};
+
+    seek_tree(&index->student_tree, &key, &cursor->tree);
+    cursor->high = key.major + 1;
 }
-void print_borrows(const LinkedList *borrow_list)
+Borrow *next_borrow_cursor(BorrowCursor *cursor)
 {
-    const LinkedList *current = borrow_list;
-    while (current != NULL)
+    TreeKey key;
+    void *borrow = NULL;
+
+    if (!next_tree(&cursor->tree, &key, &borrow) || key.major >= cursor->high)
     {
-        wprintf(L"\n");
-        print_borrow(current->contents);
-        current = current->next;
+        cursor->tree.node = NULL;
+        return NULL;
     }
-    return;
+    return borrow;
 }
+Borrow *find_borrow(const BorrowIndex *index, Client *client, Book *book)
+{
+    if (index == NULL || client == NULL || book == NULL)
+        return 0;
 
-void save_clients(const LinkedList const *client_list, const char const *file_name)
+    const TreeKey key = {book->number, client->student_number};
+    return find_tree(&index->book_tree, &key);
+}
+Borrow *find_borrow_by_book(const BorrowIndex *index, const uint32_t book_number)
 {
-    FILE *file = NULL;
-    file = fopen(file_name, "w");
-    if (file == NULL)
-        return;
-    if (client_list == NULL)
-    {
-        fclose(file);
-        return;
-    } 
+    TreeCursor cursor;
+    TreeKey key = {book_number, 0};
+    void *borrow = NULL;
 
-    const LinkedList *current_member = client_list;
-    Client *client = current_member->contents;
+    seek_tree(&index->book_tree, &key, &cursor);
+    if (!next_tree(&cursor, &key, &borrow) || key.major != book_number)
+        return NULL;
+    return borrow;
+}
+void find_overdue_borrows(const BorrowIndex *index, const time_t now, BorrowCursor *cursor)
+{
+    const TreeKey key = {0, 0};
 
-    while (current_member != NULL)
-    {
-        client = current_member->contents;
-        fwprintf(file,
-            L"%ls | %ls | %ls | %ls | %ls | ",
-            client->student_number, client->password, client->name, client->address, client->phone_number);
+    seek_tree(&index->due_tree, &key, &cursor->tree);
+    cursor->high = now > 0 ? (uint64_t)now : 0;
+}
+void find_due_borrows(const BorrowIndex *index, const time_t from, BorrowCursor *cursor)
+{
+    const TreeKey key = {from > 0 ? (uint64_t)from : 0, 0};
 
-        current_member = current_member->next;
-    }
-    fclose(file);
+    seek_tree(&index->due_tree, &key, &cursor->tree);
+    cursor->high = UINT64_MAX;
 }
-void save_books(const LinkedList *book_list, const char *file_name)
+size_t print_due_borrows(BorrowCursor *cursor, const size_t limit)
 {
-    FILE *file = NULL;
-    file = fopen(file_name, "w");
-    if (file == NULL)
-        return;
-    if (book_list == NULL)
+    const Borrow *borrow = NULL;
+    size_t count = 0;
+
+    while (count < limit && (borrow = next_borrow_cursor(cursor)) != NULL)
     {
-        fclose(file);
-        return;
-    } 
+        wprintf(L"\n학번 : %08u \n", borrow->student_number);
+        print_borrow(borrow);
+        count++;
+    }
+    return count;
+}
+TreeKey get_borrow_student_key(const Borrow *borrow)
+{
+    const TreeKey key = {borrow->student_number, (uint64_t)(UINT32_MAX - (uint32_t)borrow->loan_date) << 32 | borrow->book_number};
 
-    const LinkedList *current_member = book_list;
-    Book *book = current_member->contents;
+    return key;
+}
+TreeKey get_borrow_book_key(const Borrow *borrow)
+{
+    const TreeKey key = {borrow->book_number, borrow->student_number};
 
-    while (current_member != NULL)
-    {
-        book = current_member->contents;
-        fwprintf(file,
-            L"%ls | %ls | %ls | %ls | %ls | %ls | %lc | ",
-            book->number, book->name, book->publisher, book->author, book->ISBN, book->location, book->availability);
+    return key;
+}
+TreeKey get_borrow_due_key(const Borrow *borrow)
+{
+    const TreeKey key = {borrow->return_date > 0 ? (uint64_t)borrow->return_date : 0, (uint64_t)borrow->student_number << 32 | borrow->book_number};
 
-        current_member = current_member->next;
-    }
-    fclose(file);
+    return key;
 }
-void save_borrows(const LinkedList *borrow_list, const char *file_name)
+void insert_borrow_index(BorrowIndex *index, Borrow *borrow)
 {
-    FILE *file = NULL;
-    file = fopen(file_name, "w");
-    if (file == NULL)
+    TreeKey key = get_borrow_student_key(borrow);
+    insert_tree(&index->student_tree, &key, borrow);
+    key = get_borrow_book_key(borrow);
+    insert_tree(&index->book_tree, &key, borrow);
+    key = get_borrow_due_key(borrow);
+    insert_tree(&index->due_tree, &key, borrow);
+}
+void remove_borrow_index(BorrowIndex *index, const Borrow *borrow)
+{
+    // 같은 키의 다른 대여가 들어가 있으면 지우지 않음
+    TreeKey key = get_borrow_student_key(borrow);
+    if (find_tree(&index->student_tree, &key) == borrow)
+        remove_tree(&index->student_tree, &key);
+    key = get_borrow_book_key(borrow);
+    if (find_tree(&index->book_tree, &key) == borrow)
+        remove_tree(&index->book_tree, &key);
+    key = get_borrow_due_key(borrow);
+    if (find_tree(&index->due_tree, &key) == borrow)
+        remove_tree(&index->due_tree, &key);
+}
+void destroy_borrow_index(BorrowIndex *index)
+{
+    destroy_tree(&index->student_tree);
+    destroy_tree(&index->book_tree);
+    destroy_tree(&index->due_tree);
+}
+
+void open_loan_history(const char *file_name, LoanHistory *history, const Table *borrows)
+{
+    memset(history, 0, sizeof(LoanHistory));
+    if (map_loan_history(file_name, history) != EOF)
         return;
-    if (borrow_list == NULL)
+    if (history->is_broken)
     {
-        fclose(file);
+        fwprintf(stderr, L"대여 기록 파일(%s)을 읽을 수 없습니다. 이전 기록 없이 시작합니다.\n", file_name);
         return;
-    } 
+    }
 
-    const LinkedList *current_member = borrow_list;
-    Borrow *borrow = current_member->contents;
+    // 기록 파일이 없으면 지금 대여 중인 것부터 기록함
+    const Borrow *borrow = NULL;
+    size_t position = 0;
+    while ((borrow = next_table(borrows, &position)) != NULL)
+        add_loan_history(history, borrow);
+}
+int map_loan_history(const char *file_name, LoanHistory *history)
+{
+    unmap_snapshot(&history->snapshot);
+    history->records = NULL;
+    history->count = 0;
 
-    while (current_member != NULL)
+    const SnapshotHeader *header = map_snapshot(file_name, SNAPSHOT_HISTORY, sizeof(LoanRecord), &history->snapshot);
+    if (header == NULL || header->file_size != sizeof(SnapshotHeader) + header->record_count * sizeof(LoanRecord))
     {
-        borrow = current_member->contents;
-        fwprintf(file,
-            L"%ls | %ls | %ls | %lld | %lld | ",
-            borrow->student_number, borrow->book_name, borrow->book_number, (long long)(borrow->loan_date), (long long)(borrow->return_date));
-
-        current_member = current_member->next;
+        unmap_snapshot(&history->snapshot);
+        // 기록은 다른 곳에 없으므로 파일이 없을 때만 새로 만듦
+        history->snapshot.need_rewrite = access(file_name, F_OK) != 0 && errno == ENOENT;
+        history->is_broken = !history->snapshot.need_rewrite;
+        return EOF;
     }
-    fclose(file);
+    history->is_broken = 0;
+
+    // 검색은 몇 페이지만 읽으므로 미리 읽지 않음
+    madvise(history->snapshot.address, history->snapshot.size, MADV_RANDOM);
+    history->records = (const LoanRecord *)(header + 1);
+    history->count = header->record_count;
+    if (history->fence_count > (history->count + SIZE_HISTORY_BLOCK - 1) / SIZE_HISTORY_BLOCK)
+        history->fence_count = 0;
+    return 0;
 }
+void add_loan_history(LoanHistory *history, const Borrow *borrow)
+{
+    const LoanRecord record = {borrow->loan_date, borrow->student_number, borrow->book_number};
+
+    // 같은 초에 빌린 것만 비교함
+    for (size_t i = search_loan_history(history, record.loan_date); i < history->count && history->records[i].loan_date == record.loan_date; i++)
+        if (compare_loan_record(&history->records[i], &record) == 0)
+            return;
+    for (size_t i = search_pending_loans(history, record.loan_date); i < history->pending_count && history->pending[i].loan_date == record.loan_date; i++)
+        if (compare_loan_record(&history->pending[i], &record) == 0)
+            return;
+
+    if (history->pending_count == history->pending_capacity)
+    {
+        history->pending_capacity = history->pending_capacity > 0 ? history->pending_capacity * 2 : SIZE_POSTING_INDEX_MIN;
+        history->pending = realloc(history->pending, history->pending_capacity * sizeof(LoanRecord));
+    }
 
-LinkedList *insert_client(LinkedList *client_list, Client *client)
+    // 보통은 맨 뒤에 들어감
+    size_t position = history->pending_count;
+    while (position > 0 && compare_loan_record(&history->pending[position - 1], &record) > 0)
+        position--;
+    memmove(&history->pending[position + 1], &history->pending[position], (history->pending_count - position) * sizeof(LoanRecord));
+    history->pending[position] = record;
+    history->pending_count++;
+}
+void save_loan_history(LoanHistory *history, const char *file_name)
 {
-    if (client == NULL)
-        return NULL;
-
-    LinkedList *node = malloc(sizeof(LinkedList));
-    node->contents = (void *)client;
-    node->next = NULL;
+    if (history->pending_count == 0 && !history->snapshot.need_rewrite)
+        return;
 
-    if (client_list == NULL)
-        return node;
+    SnapshotHeader header;
+    FILE *file = NULL;
 
-    LinkedList *current_member = client_list;
-    Client *current_client = NULL;
-    LinkedList *front_member = NULL;
+    // 읽을 수 없는 기록 파일은 지우지 않고 옮겨 둠
+    if (history->is_broken)
+    {
+        char broken_name[FILENAME_MAX];
+        snprintf(broken_name, sizeof(broken_name), "%s.%lld%s", file_name, (long long)time(NULL), STRING_BROKEN_EXTENSION);
+        if (rename(file_name, broken_name) != 0)
+            return;
+        fwprintf(stderr, L"읽을 수 없는 대여 기록 파일을 %s로 옮겼습니다.\n", broken_name);
+        history->is_broken = 0;
+        history->snapshot.need_rewrite = 1;
+        history->fence_count = 0;
+    }
 
-    while (current_member != NULL)
+    // 새 대여가 모두 마지막 기록 뒤에 오면 덧붙임
+    if (!history->snapshot.need_rewrite && (history->count == 0 || compare_loan_record(&history->records[history->count - 1], &history->pending[0]) < 0))
+        file = open_snapshot_to_append(file_name, &header, SNAPSHOT_HISTORY, sizeof(LoanRecord));
+    if (file != NULL && header.record_count == history->count)
     {
-        current_client = current_member->contents;
-        if (wcscmp(current_client->student_number, client->student_number) < 0)
+        fseek(file, header.file_size, SEEK_SET);
+        fwrite(history->pending, sizeof(LoanRecord), history->pending_count, file);
+        header.record_count += history->pending_count;
+        header.file_size += history->pending_count * sizeof(LoanRecord);
+        if (sync_snapshot_file(file, &header) == EOF)
         {
-            front_member = current_member;
-            current_member = current_member->next;
+            fclose(file);
+            return;
         }
-        else
+        fclose(file);
+    }
+    else
+    {
+        if (file != NULL)
+            fclose(file);
+        file = open_snapshot_file(file_name, &header, SNAPSHOT_HISTORY, sizeof(LoanRecord));
+        if (file == NULL)
+            return;
+
+        size_t record = 0, pending = 0;
+        while (record < history->count || pending < history->pending_count)
         {
-            node->next = current_member;
-            if (front_member != NULL)
-                front_member->next = node;
+            if (pending == history->pending_count || (record < history->count && compare_loan_record(&history->records[record], &history->pending[pending]) < 0))
+                fwrite(&history->records[record++], sizeof(LoanRecord), 1, file);
             else
-                client_list = node;
-            break;
+                fwrite(&history->pending[pending++], sizeof(LoanRecord), 1, file);
         }
+        header.segment_count = 1;
+        header.record_count = history->count + history->pending_count;
+        header.file_size = sizeof(SnapshotHeader) + header.record_count * sizeof(LoanRecord);
+        close_snapshot_file(file, file_name, &header);
+        history->fence_count = 0;
     }
-    if (current_member == NULL)
-        front_member->next = node;
 
-    return client_list;
+    history->pending_count = 0;
+    map_loan_history(file_name, history);
 }
-LinkedList *insert_book(LinkedList *book_list, Book *book)
+int compare_loan_record(const LoanRecord *a, const LoanRecord *b)
 {
-    if (book == NULL)
-        return NULL;
-    LinkedList *node = malloc(sizeof(LinkedList));
-    node->contents = (void *)book;
-    node->next = NULL;
-
-    if (book_list == NULL)
-        return node;
+    if (a->loan_date != b->loan_date)
+        return a->loan_date < b->loan_date ? -1 : 1;
+    if (a->student_number != b->student_number)
+        return a->student_number < b->student_number ? -1 : 1;
+    if (a->book_number != b->book_number)
+        return a->book_number < b->book_number ? -1 : 1;
+    return 0;
+}
+void build_loan_history_fences(LoanHistory *history)
+{
+    const size_t fence_count = (history->count + SIZE_HISTORY_BLOCK - 1) / SIZE_HISTORY_BLOCK;
+    if (history->fence_count >= fence_count)
+        return;
 
-    LinkedList *current_member = book_list;
-    Book *current_book = NULL;
-    LinkedList *front_member = NULL;
+    // 덧붙인 블록의 펜스만 새로 만듦
+    history->fences = realloc(history->fences, fence_count * sizeof(int64_t));
+    for (size_t i = history->fence_count; i < fence_count; i++)
+        history->fences[i] = history->records[i * SIZE_HISTORY_BLOCK].loan_date;
+    history->fence_count = fence_count;
+}
+size_t search_loan_history(LoanHistory *history, const int64_t date)
+{
+    build_loan_history_fences(history);
 
-    while (current_member != NULL)
+    size_t low = 0;
+    size_t high = history->fence_count;
+    while (low < high)
     {
-        current_book = current_member->contents;
-        if (wcscmp(current_book->ISBN, book->ISBN) < 0)
-        {
-            front_member = current_member;
-            current_member = current_member->next;
-        }
+        const size_t middle = (low + high) / 2;
+        if (history->fences[middle] < date)
+            low = middle + 1;
         else
-        {
-            node->next = current_member;
-            if (front_member != NULL)
-                front_member->next = node;
-            else
-                book_list = node;
-            break;
-        }
+            high = middle;
     }
-    if (current_member == NULL)
-        front_member->next = node;
 
-    return book_list;
+    // 찾는 레코드는 펜스 바로 앞 블록에 있음
+    high = low < history->fence_count ? low * SIZE_HISTORY_BLOCK : history->count;
+    low = low > 0 ? (low - 1) * SIZE_HISTORY_BLOCK : 0;
+    while (low < high)
+    {
+        const size_t middle = (low + high) / 2;
+        if (history->records[middle].loan_date < date)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return low;
 }
-LinkedList *insert_borrow(LinkedList *borrow_list, Borrow *borrow)
+size_t search_pending_loans(const LoanHistory *history, const int64_t date)
 {
-    if (borrow == NULL)
+    size_t low = 0;
+    size_t high = history->pending_count;
+    while (low < high)
+    {
+        const size_t middle = (low + high) / 2;
+        if (history->pending[middle].loan_date < date)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return low;
+}
+void find_loans_by_date(LoanHistory *history, const time_t from, const time_t to, LoanHistoryCursor *cursor)
+{
+    cursor->history = history;
+    cursor->record = search_loan_history(history, from);
+    cursor->pending = search_pending_loans(history, from);
+    cursor->high = to;
+}
+const LoanRecord *next_loan_history_cursor(LoanHistoryCursor *cursor)
+{
+    const LoanHistory *history = cursor->history;
+    const LoanRecord *record = NULL;
+
+    if (cursor->record < history->count)
+        record = &history->records[cursor->record];
+    if (cursor->pending < history->pending_count &&
+        (record == NULL || compare_loan_record(&history->pending[cursor->pending], record) < 0))
+        record = &history->pending[cursor->pending++];
+    else if (record != NULL)
+        cursor->record++;
+
+    if (record == NULL || record->loan_date >= cursor->high)
+    {
+        cursor->record = history->count;
+        cursor->pending = history->pending_count;
         return NULL;
-    LinkedList *node = malloc(sizeof(LinkedList));
-    node->contents = (void *)borrow;
-    node->next = borrow_list;
+    }
+    return record;
+}
+size_t count_loans_by_date(LoanHistory *history, const time_t from, const time_t to)
+{
+    if (from >= to)
+        return 0;
 
-    return node;
+    return search_loan_history(history, to) - search_loan_history(history, from) +
+           search_pending_loans(history, to) - search_pending_loans(history, from);
+}
+void destroy_loan_history(LoanHistory *history)
+{
+    unmap_snapshot(&history->snapshot);
+    free(history->fences);
+    free(history->pending);
+    memset(history, 0, sizeof(LoanHistory));
 }
 
-Client *find_client_by_student_number(const LinkedList *client_list, const wchar_t *student_number)
+void remove_client(Table *clients, ClientIndex *index, RecordArena *arena, Client *client)
 {
-	if (client_list == NULL || student_number == NULL)
-		return 0;
+    if (get_table(clients, client->handle) != client)
+        return;
 
-	const LinkedList *current = client_list;
-	Client *client;
-	while (current != NULL)
-	{
-		if (wcscmp(((Client *)current->contents)->student_number, student_number) != 0)
-			current = current->next;
-		else
-		{
-			client = ((Client *)current->contents);
-			return client;
-		}
-	}
-	return 0;
+    remove_client_index(index, client);
+    TreeKey key = get_client_name_key(client);
+    if (find_tree(&index->name_tree, &key) == client)
+        remove_tree(&index->name_tree, &key);
+    key.major = client->student_number;
+    key.minor = 0;
+    if (find_tree(&index->number_tree, &key) == client)
+        remove_tree(&index->number_tree, &key);
+    remove_table(clients, client->handle);
+    destroy_client(arena, client);
 }
-Client *find_client_by_name(const LinkedList *client_list, const wchar_t * name)
+void remove_book(Table *books, BookIndex *index, RecordArena *arena, Book *book)
 {
-	if (client_list == NULL || name == NULL)
-		return 0;
+    if (get_table(books, book->handle) != book)
+        return;
 
-	const LinkedList *current = client_list;
-	Client *client;
-	while (current != NULL)
-	{
-		if (wcscmp(((Client *)current->contents)->name, name) != 0)
-			current = current->next;
-		else
-		{
-			client = ((Client *)current->contents);
-			return client;
-		}
-	}
-	return 0;
+    remove_book_index(index, book);
+    remove_table(books, book->handle);
+    destroy_book(arena, book);
 }
-LinkedList *find_books_by_name(const LinkedList *book_list, const wchar_t *book_name)
+void remove_borrow(Table *borrows, BorrowIndex *index, RecordArena *arena, Borrow *borrow)
 {
-    if (book_list == NULL || book_name == NULL)
-        return 0;
+    if (get_table(borrows, borrow->handle) != borrow)
+        return;
 
-    LinkedList *result = NULL;
+    remove_borrow_index(index, borrow);
+    remove_table(borrows, borrow->handle);
+    destroy_borrow(arena, borrow);
+}
 
-    for (const LinkedList *current = book_list; current != NULL; current = current->next)
-        if (wcscmp(((Book *)current->contents)->name, book_name) == 0)
-            result = insert_book(result, (Book *)current->contents);
+void destroy_list(LinkedList *list)
+{
+    LinkedList *before_node = NULL;
+    while (list != NULL)
+    {
+        before_node = list;
+        list = list->next;
+        free(before_node);
+    }
+}
 
-    return result;
+void destroy_clients(Table *clients, const ClientIndex *index, const char *file_name, RecordArena *arena)
+{
+    if (file_name != NULL)
+        save_clients(index, file_name);
+    destroy_table(clients);
+    release_record_arena(arena);
 }
-LinkedList *find_books_by_ISBN(const LinkedList *book_list, const wchar_t *book_ISBN)
+void destroy_books(Table *books, const BookIndex *index, const char *file_name, RecordArena *arena)
 {
-    if (book_list == NULL || book_ISBN == NULL)
-        return 0;
-
-    LinkedList *result = NULL;
-
-    for (const LinkedList *current = book_list; current != NULL; current = current->next)
-        if (wcscmp(((Book *)current->contents)->ISBN, book_ISBN) == 0)
-            result = insert_book(result, (Book *)current->contents);
-
-    return result;
+    if (file_name != NULL)
+        save_books(index, file_name);
+    destroy_table(books);
+    release_record_arena(arena);
 }
-LinkedList *find_books_by_author(const LinkedList *book_list, const wchar_t *book_author)
+void destroy_borrows(Table *borrows, const char *file_name, RecordArena *arena)
 {
-    if (book_list == NULL || book_author == NULL)
-        return 0;
+    if (file_name != NULL)
+        save_borrows(borrows, file_name);
+    destroy_table(borrows);
+    release_record_arena(arena);
+}
 
-    LinkedList *result = NULL;
+void destroy_client(RecordArena *arena, Client *client)
+{
+    free_record(arena, client);
+}
+void destroy_book(RecordArena *arena, Book *book)
+{
+    free_record(arena, book);
+}
+void destroy_borrow(RecordArena *arena, Borrow *borrow)
+{
+    free_record(arena, borrow);
+}
 
-    for (const LinkedList *current = book_list; current != NULL; current = current->next)
-        if (wcscmp(((Book *)current->contents)->author, book_author) == 0)
-            result = insert_book(result, (Book *)current->contents);
+int open_journal(Journal *journal, const char *file_name, const _Bool is_read_only)
+{
+    memset(journal, 0, sizeof(Journal));
+    journal->is_read_only = is_read_only;
+    journal->file = is_read_only ? open(file_name, O_RDONLY) : open(file_name, O_RDWR | O_CREAT | O_APPEND, 0644);
+    if (journal->file < 0)
+        return EOF;
 
-    return result;
+    return 0;
 }
-LinkedList *find_books_by_publisher(const LinkedList *book_list, const wchar_t *book_publisher)
+void replay_journal(Data *data)
 {
-    if (book_list == NULL || book_publisher == NULL)
-        return 0;
+    Journal *journal = &data->journal;
+    if (journal->file < 0)
+        return;
 
-    LinkedList *result = NULL;
+    off_t size = lseek(journal->file, 0, SEEK_END);
+    if (size <= 0)
+        return;
 
-    for (const LinkedList *current = book_list; current != NULL; current = current->next)
-        if (wcscmp(((Book *)current->contents)->publisher, book_publisher) == 0)
-            result = insert_book(result, (Book *)current->contents);
+    char *buffer = malloc(size);
+    off_t read_size = 0;
+    ssize_t result;
+    while (read_size < size)
+    {
+        result = pread(journal->file, buffer + read_size, size - read_size, read_size);
+        if (result <= 0)
+            break;
+        read_size += result;
+    }
 
-    return result;
-}
-Book *find_book_by_number(const LinkedList *book_list, const wchar_t *book_number)
-{
-    if (book_list == NULL || book_number == NULL)
-        return NULL;
+    JournalEntryHeader header;
+    const wchar_t *fields[SIZE_JOURNAL_FIELD_MAX];
+    off_t position = 0;
 
-    Book *result = NULL;
-    int num1, num2;
-    for (const LinkedList *current = book_list; current != NULL; current = current->next)
+    while (position + (off_t)sizeof(JournalEntryHeader) <= read_size)
     {
-        result = current->contents;
-        swscanf(result->number, L"%8d", &num1);
-        swscanf(book_number, L"%d", &num2);
-        if (num1 == num2)
+        memcpy(&header, buffer + position, sizeof(JournalEntryHeader));
+        if (header.type >= JOURNAL_MAX ||
+            header.count > SIZE_JOURNAL_FIELD_MAX ||
+            header.size % sizeof(wchar_t) != 0 ||
+            header.size > read_size - position - sizeof(JournalEntryHeader))
             break;
-        if (current->next == NULL)
+
+        // 필드는 wchar_t 단위로 정렬되도록 따로 복사함
+        wchar_t *string = malloc(header.size + sizeof(wchar_t));
+        memcpy(string, buffer + position + sizeof(JournalEntryHeader), header.size);
+        string[header.size / sizeof(wchar_t)] = L'\0';
+        if (get_journal_checksum(&header, string) != header.checksum)
         {
-            result = NULL;
+            free(string);
             break;
         }
-    }
-    return result;
-}
-LinkedList *find_borrows_by_client(const LinkedList *borrow_list, Client *client)
-{
-    if (borrow_list == NULL || client == NULL)
-        return 0;
 
-    LinkedList *result = NULL;
+        uint32_t now_field = 0;
+        size_t now_char = 0;
+        const size_t len = header.size / sizeof(wchar_t);
+        while (now_field < header.count && now_char < len)
+        {
+            fields[now_field++] = string + now_char;
+            now_char += wcslen(string + now_char) + 1;
+        }
+        if (now_field == header.count)
+            apply_journal_entry(data, header.type, header.count, fields);
+        free(string);
 
-    for (const LinkedList *current = borrow_list; current != NULL; current = current->next)
-        if (wcscmp(((Borrow *)current->contents)->student_number, client->student_number) == 0)
-            result = insert_borrow(result, (Borrow *)current->contents);
+        position += sizeof(JournalEntryHeader) + header.size;
+        journal->entry_count++;
+    }
+    free(buffer);
 
-    return result;
+    // 마지막에 쓰다가 끊긴 엔트리는 버림
+    if (position < size && !journal->is_read_only)
+        ftruncate(journal->file, position);
 }
-Borrow *find_borrow(const LinkedList *borrow_list, Client *client, Book *book)
+void apply_journal_entry(Data *data, const uint32_t type, const uint32_t count, const wchar_t **fields)
 {
-    if (borrow_list == NULL || client == NULL || book == NULL)
-        return 0;
-
+    Client *client = NULL;
+    Book *book = NULL;
     Borrow *borrow = NULL;
+    uint64_t phone_number = 0;
 
-    for (const LinkedList *current = borrow_list; current != NULL; current = current->next)
-        if (wcscmp(((Borrow *)current->contents)->student_number, client->student_number) == 0 && wcscmp(((Borrow *)current->contents)->book_number, book->number) == 0)
-        {
-            borrow = (Borrow *)current->contents;
+    switch (type)
+    {
+    case JOURNAL_INSERT_CLIENT:
+        if (count != 5 || get_student_number(fields[0]) == STUDENT_NUMBER_NONE)
             break;
+        client = find_client_by_student_number(&data->client_index, get_student_number(fields[0]));
+        if (client != NULL)
+        {
+            mark_removed(&data->snapshots[SNAPSHOT_CLIENT], client, client->snapshot_offset, client->dirty);
+            remove_client(&data->clients, &data->client_index, &data->arenas[SNAPSHOT_CLIENT], client);
         }
-    if (borrow == NULL)
-        return NULL; //결과 없음
-
-    return borrow;
-}
-
-LinkedList *remove_client(LinkedList *client_list, Client *client)
-{
-    LinkedList *first_node = client_list;
-    LinkedList *pre_node = NULL;
-    while (client_list != NULL)
+        phone_number = get_phone_number(fields[4]);
+        client = create_client(&data->arenas[SNAPSHOT_CLIENT], get_student_number(fields[0]), fields[1], fields[2], fields[3], phone_number != PHONE_NUMBER_NONE ? phone_number : 0);
+        insert_client(&data->clients, &data->client_index, client);
+        mark_dirty(&data->snapshots[SNAPSHOT_CLIENT], client, &client->dirty, DIRTY_INSERTED);
+        break;
+    case JOURNAL_UPDATE_CLIENT:
+        if (count != 4)
+            break;
+        client = find_client_by_student_number(&data->client_index, get_student_number(fields[0]));
+        if (client == NULL)
+            break;
+        client->password = create_arena_string(&data->arenas[SNAPSHOT_CLIENT], fields[1]);
+        client->address = create_arena_string(&data->arenas[SNAPSHOT_CLIENT], fields[2]);
+        phone_number = get_phone_number(fields[3]);
+        client->phone_number = phone_number != PHONE_NUMBER_NONE ? phone_number : 0;
+        mark_dirty(&data->snapshots[SNAPSHOT_CLIENT], client, &client->dirty, DIRTY_STRINGS | DIRTY_PHONE_NUMBER);
+        break;
+    case JOURNAL_REMOVE_CLIENT:
+        if (count != 1)
+            break;
+        client = find_client_by_student_number(&data->client_index, get_student_number(fields[0]));
+        if (client == NULL)
+            break;
+        mark_removed(&data->snapshots[SNAPSHOT_CLIENT], client, client->snapshot_offset, client->dirty);
+        remove_client(&data->clients, &data->client_index, &data->arenas[SNAPSHOT_CLIENT], client);
+        break;
+    case JOURNAL_INSERT_BOOK:
+        if (count != 7 || get_book_number(fields[0]) == 0 || find_book_by_number(&data->book_index, get_book_number(fields[0])) != NULL)
+            break;
+        book = allocate_record(&data->arenas[SNAPSHOT_BOOK]);
+        book->number = get_book_number(fields[0]);
+        book->name = create_arena_string(&data->arenas[SNAPSHOT_BOOK], fields[1]);
+        book->publisher = intern_arena_string(&data->arenas[SNAPSHOT_BOOK], fields[2]);
+        book->author = intern_arena_string(&data->arenas[SNAPSHOT_BOOK], fields[3]);
+        book->ISBN = get_ISBN_key(fields[4]);
+        book->location = intern_arena_string(&data->arenas[SNAPSHOT_BOOK], fields[5]);
+        book->availability = fields[6][0];
+        book->loan_count = 0;
+        book->dirty = 0;
+        book->snapshot_offset = 0;
+        insert_book(&data->books, &data->book_index, book);
+        mark_dirty(&data->snapshots[SNAPSHOT_BOOK], book, &book->dirty, DIRTY_INSERTED);
+        break;
+    case JOURNAL_REMOVE_BOOK:
+        if (count != 1)
+            break;
+        book = find_book_by_number(&data->book_index, get_book_number(fields[0]));
+        if (book == NULL)
+            break;
+        mark_removed(&data->snapshots[SNAPSHOT_BOOK], book, book->snapshot_offset, book->dirty);
+        remove_book(&data->books, &data->book_index, &data->arenas[SNAPSHOT_BOOK], book);
+        break;
+    case JOURNAL_BORROW_BOOK:
+        if (count != 5)
+            break;
+        client = find_client_by_student_number(&data->client_index, get_student_number(fields[0]));
+        book = find_book_by_number(&data->book_index, get_book_number(fields[1]));
+        if (client == NULL || book == NULL)
+            break;
+        set_book_availability(&data->book_index, book, L'N');
+        mark_dirty(&data->snapshots[SNAPSHOT_BOOK], book, &book->dirty, DIRTY_AVAILABILITY);
+        if (find_borrow(&data->borrow_index, client, book) != NULL)
+            break;
+        count_book_loan(&data->book_index, book);
+        mark_dirty(&data->snapshots[SNAPSHOT_BOOK], book, &book->dirty, DIRTY_LOAN_COUNT);
+        borrow = allocate_record(&data->arenas[SNAPSHOT_BORROW]);
+        borrow->student_number = client->student_number;
+        borrow->book_number = book->number;
+        borrow->book_name = create_arena_string(&data->arenas[SNAPSHOT_BORROW], fields[2]);
+        borrow->loan_date = (time_t)wcstoll(fields[3], NULL, 10);
+        borrow->return_date = (time_t)wcstoll(fields[4], NULL, 10);
+        borrow->dirty = 0;
+        borrow->snapshot_offset = 0;
+        insert_borrow(&data->borrows, &data->borrow_index, borrow);
+        add_loan_history(&data->history, borrow);
+        mark_dirty(&data->snapshots[SNAPSHOT_BORROW], borrow, &borrow->dirty, DIRTY_INSERTED);
+        break;
+    case JOURNAL_RETURN_BOOK:
+        if (count != 2)
+            break;
+        client = find_client_by_student_number(&data->client_index, get_student_number(fields[0]));
+        book = find_book_by_number(&data->book_index, get_book_number(fields[1]));
+        if (client == NULL || book == NULL)
+            break;
+        set_book_availability(&data->book_index, book, L'Y');
+        mark_dirty(&data->snapshots[SNAPSHOT_BOOK], book, &book->dirty, DIRTY_AVAILABILITY);
+        borrow = find_borrow(&data->borrow_index, client, book);
+        if (borrow == NULL)
+            break;
+        mark_removed(&data->snapshots[SNAPSHOT_BORROW], borrow, borrow->snapshot_offset, borrow->dirty);
+        remove_borrow(&data->borrows, &data->borrow_index, &data->arenas[SNAPSHOT_BORROW], borrow);
+        break;
+    case JOURNAL_RESERVE_BOOK_NUMBERS:
     {
-        if (client_list->contents == client)
-        {
-            if (pre_node != NULL)
-                pre_node->next = client_list->next;
-            else
-                first_node = client_list->next;
-            destroy_client(client);
-            free(client_list);
+        if (count != 1)
             break;
-        }
-        pre_node = client_list;
-        client_list = client_list->next;
+        const unsigned long next_number = wcstoul(fields[0], NULL, 10);
+        if (next_number > data->book_index.next_number && next_number <= BOOK_NUMBER_MAX + 1ul)
+            data->book_index.next_number = (uint32_t)next_number;
+        break;
+    }
+    default:
+        break;
     }
-    return first_node;
 }
-LinkedList *remove_book(LinkedList *book_list, Book *book)
+void write_journal(Journal *journal, const uint32_t type, const uint32_t count, const wchar_t **fields)
 {
-    LinkedList *first_node = book_list;
-    LinkedList *pre_node = NULL;
-    while (book_list != NULL)
+    if (journal->file < 0 || journal->is_read_only)
+        return;
+
+    JournalEntryHeader header;
+    header.type = type;
+    header.count = count;
+    header.size = 0;
+    for (uint32_t i = 0; i < count; i++)
+        header.size += sizeof(wchar_t) * (wcslen(fields[i]) + 1);
+
+    // 엔트리가 한 번에 써지도록 버퍼에 모아서 씀
+    char *buffer = malloc(sizeof(JournalEntryHeader) + header.size);
+    size_t position = sizeof(JournalEntryHeader);
+    for (uint32_t i = 0; i < count; i++)
     {
-        if (book_list->contents == book)
-        {
-            if (pre_node != NULL)
-                pre_node->next = book_list->next;
-            else
-                first_node = book_list->next;
-            destroy_book(book);
-            free(book_list);
-            break;
-        }
-        pre_node = book_list;
-        book_list = book_list->next;
+        size_t size = sizeof(wchar_t) * (wcslen(fields[i]) + 1);
+        memcpy(buffer + position, fields[i], size);
+        position += size;
     }
-    return first_node;
+    header.checksum = get_journal_checksum(&header, buffer + sizeof(JournalEntryHeader));
+    memcpy(buffer, &header, sizeof(JournalEntryHeader));
+
+    if (journal->buffer_size + position > journal->buffer_capacity)
+    {
+        journal->buffer_capacity = (journal->buffer_size + position) * 2;
+        journal->buffer = realloc(journal->buffer, journal->buffer_capacity);
+    }
+    memcpy(journal->buffer + journal->buffer_size, buffer, position);
+    journal->buffer_size += position;
+    free(buffer);
+
+    if (journal->pending_count == 0)
+        clock_gettime(CLOCK_MONOTONIC, &journal->pending_time);
+    journal->pending_count++;
+    journal->entry_count++;
 }
-LinkedList *remove_borrow(LinkedList *borrow_list, Borrow *borrow)
+int commit_journal(Journal *journal)
 {
-    LinkedList *first_node = borrow_list;
-    LinkedList *pre_node = NULL;
-    while (borrow_list != NULL)
+    if (journal->pending_count == 0)
+        return 0;
+
+    const off_t size = lseek(journal->file, 0, SEEK_END);
+    size_t written = 0;
+    ssize_t result;
+    while (written < journal->buffer_size)
     {
-        if (borrow_list->contents == borrow)
-        {
-            if (pre_node != NULL)
-                pre_node->next = borrow_list->next;
-            else
-                first_node = borrow_list->next;
-            destroy_borrow(borrow);
-            free(borrow_list);
+        result = write(journal->file, journal->buffer + written, journal->buffer_size - written);
+        if (result <= 0)
             break;
-        }
-        pre_node = borrow_list;
-        borrow_list = borrow_list->next;
+        written += result;
+    }
+    // 반쯤 쓴 그룹은 잘라내고 다음 커밋에서 다시 씀
+    if (size < 0 || written < journal->buffer_size || (JOURNAL_SYNC && fdatasync(journal->file) != 0))
+    {
+        if (size >= 0)
+            ftruncate(journal->file, size);
+        return EOF;
     }
-    return first_node;
-}
 
-void destroy_list(LinkedList *list)
+    uint64_t latency = get_elapsed_ns(&journal->pending_time);
+    journal->stat.commit_count++;
+    journal->stat.entry_count += journal->pending_count;
+    journal->stat.total_latency_ns += latency;
+    if (latency > journal->stat.max_latency_ns)
+        journal->stat.max_latency_ns = latency;
+
+    journal->buffer_size = 0;
+    journal->pending_count = 0;
+
+    return 0;
+}
+int wait_journal_commit(Journal *journal)
 {
-    LinkedList *before_node = NULL;
-    while (list != NULL)
+    if (journal->pending_count == 0)
+        return 0;
+
+    const uint64_t window = (uint64_t)JOURNAL_COMMIT_WINDOW_MS * 1000000;
+    uint64_t elapsed = window > 0 ? get_elapsed_ns(&journal->pending_time) : 0;
+    if (JOURNAL_SYNC && journal->pending_count < JOURNAL_COMMIT_SIZE && elapsed < window)
     {
-        before_node = list;
-        list = list->next;
-        free(before_node);
+        // 같은 윈도우 안의 변경은 한 번의 fsync로 묶임
+        struct timespec rest;
+        rest.tv_sec = (window - elapsed) / 1000000000;
+        rest.tv_nsec = (window - elapsed) % 1000000000;
+        nanosleep(&rest, NULL);
     }
+    return commit_journal(journal);
 }
+void print_journal_stat(const Journal *journal)
+{
+    const JournalStat *stat = &journal->stat;
+    if (stat->commit_count == 0)
+        return;
 
-void destroy_clients(LinkedList *client_list, const char *file_name)
+    fwprintf(stderr,
+        L"journal: %llu commits, %llu entries, %.2f entries/fsync, latency avg %.3f ms max %.3f ms\n",
+        (unsigned long long)stat->commit_count, (unsigned long long)stat->entry_count,
+        (double)stat->entry_count / stat->commit_count,
+        (double)stat->total_latency_ns / stat->commit_count / 1000000.0,
+        (double)stat->max_latency_ns / 1000000.0);
+}
+uint64_t get_elapsed_ns(const struct timespec *begin)
 {
-    LinkedList *current = client_list;
-    save_clients(client_list, file_name);
-    while (current != NULL)
-    {
-        destroy_client((Client *)current->contents);
-        current = current->next;
-    }
-    destroy_list(client_list);
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)(now.tv_sec - begin->tv_sec) * 1000000000 + now.tv_nsec - begin->tv_nsec;
 }
-void destroy_books(LinkedList *book_list, const char *file_name)
+void clear_journal(Journal *journal)
 {
-    LinkedList *current = book_list;
-    save_books(book_list, file_name);
-    while (current != NULL)
+    if (journal->file >= 0 && !journal->is_read_only)
     {
-        destroy_book((Book *)current->contents);
-        current = current->next;
+        ftruncate(journal->file, 0);
+        if (JOURNAL_SYNC)
+            fdatasync(journal->file);
     }
-    destroy_list(book_list);
+    journal->entry_count = journal->pending_count;
 }
-void destroy_borrows(LinkedList *borrow_list, const char *file_name)
+void close_journal(Journal *journal)
 {
-    LinkedList *current = borrow_list;
-    save_borrows(borrow_list, file_name);
-    while (current != NULL)
+    if (journal->file >= 0)
     {
-        destroy_borrow((Borrow *)current->contents);
-        current = current->next;
+        commit_journal(journal);
+        close(journal->file);
     }
-    destroy_list(borrow_list);
+    journal->file = -1;
+    free(journal->buffer);
+    journal->buffer = NULL;
+    journal->buffer_size = 0;
+    journal->buffer_capacity = 0;
+}
+uint32_t get_journal_checksum(const JournalEntryHeader *header, const void *fields)
+{
+    // FNV-1a
+    uint32_t checksum = 2166136261u;
+    const unsigned char *bytes = (const unsigned char *)header;
+    for (size_t i = 0; i < offsetof(JournalEntryHeader, checksum); i++)
+        checksum = (checksum ^ bytes[i]) * 16777619u;
+    bytes = fields;
+    for (size_t i = 0; i < header->size; i++)
+        checksum = (checksum ^ bytes[i]) * 16777619u;
+
+    return checksum;
 }
 
-void destroy_client(Client *client)
+void journal_insert_client(Journal *journal, const Client *client)
 {
-    if (client != NULL)
-    {
-        if (client->password != NULL)
-            free(client->password);
-        if (client->name != NULL)
-            free(client->name);
-        if (client->address != NULL)
-            free(client->address);
-        free(client);
-    }
+    // 저널은 와이드 문자열로 씀
+    wchar_t strings[3][SIZE_TEXT_MAX];
+    decode_text(client->password, strings[0], SIZE_TEXT_MAX);
+    decode_text(client->name, strings[1], SIZE_TEXT_MAX);
+    decode_text(client->address, strings[2], SIZE_TEXT_MAX);
+    wchar_t student_number[SIZE_STUDENT_NUMBER + 1];
+    wchar_t phone_number[SIZE_PHONE_NUMBER + 1];
+    format_student_number(client->student_number, student_number);
+    format_phone_number(client->phone_number, phone_number);
+
+    const wchar_t *fields[5] = {student_number, strings[0], strings[1], strings[2], phone_number};
+    write_journal(journal, JOURNAL_INSERT_CLIENT, 5, fields);
 }
-void destroy_book(Book *book)
+void journal_update_client(Journal *journal, const Client *client)
 {
-    if (book != NULL)
-    {
-        if (book->name != NULL)
-            free(book->name);
-        if (book->publisher != NULL)
-            free(book->publisher);
-        if (book->author != NULL)
-            free(book->author);
-        if (book->location != NULL)
-            free(book->location);
-        free(book);
-    }
+    wchar_t strings[2][SIZE_TEXT_MAX];
+    decode_text(client->password, strings[0], SIZE_TEXT_MAX);
+    decode_text(client->address, strings[1], SIZE_TEXT_MAX);
+    wchar_t student_number[SIZE_STUDENT_NUMBER + 1];
+    wchar_t phone_number[SIZE_PHONE_NUMBER + 1];
+    format_student_number(client->student_number, student_number);
+    format_phone_number(client->phone_number, phone_number);
+
+    const wchar_t *fields[4] = {student_number, strings[0], strings[1], phone_number};
+    write_journal(journal, JOURNAL_UPDATE_CLIENT, 4, fields);
+}
+void journal_remove_client(Journal *journal, const Client *client)
+{
+    wchar_t student_number[SIZE_STUDENT_NUMBER + 1];
+    format_student_number(client->student_number, student_number);
+
+    const wchar_t *fields[1] = {student_number};
+    write_journal(journal, JOURNAL_REMOVE_CLIENT, 1, fields);
+}
+void journal_insert_book(Journal *journal, const Book *book)
+{
+    const wchar_t availability[2] = {book->availability, L'\0'};
+    wchar_t number[SIZE_BOOK_NUMBER + 1];
+    swprintf(number, SIZE_BOOK_NUMBER + 1, L"%07u", book->number);
+    wchar_t strings[4][SIZE_TEXT_MAX];
+    decode_text(book->name, strings[0], SIZE_TEXT_MAX);
+    decode_text(book->publisher, strings[1], SIZE_TEXT_MAX);
+    decode_text(book->author, strings[2], SIZE_TEXT_MAX);
+    decode_text(book->location, strings[3], SIZE_TEXT_MAX);
+    wchar_t ISBN[SIZE_ISBN + 1];
+    format_ISBN(book->ISBN, ISBN);
+
+    const wchar_t *fields[7] = {number, strings[0], strings[1], strings[2], ISBN, strings[3], availability};
+    write_journal(journal, JOURNAL_INSERT_BOOK, 7, fields);
+}
+void journal_remove_book(Journal *journal, const Book *book)
+{
+    wchar_t number[SIZE_BOOK_NUMBER + 1];
+    swprintf(number, SIZE_BOOK_NUMBER + 1, L"%07u", book->number);
+
+    const wchar_t *fields[1] = {number};
+    write_journal(journal, JOURNAL_REMOVE_BOOK, 1, fields);
+}
+void journal_borrow_book(Journal *journal, const Borrow *borrow)
+{
+    wchar_t date[2][SIZE_INPUT_MAX];
+    swprintf(date[0], SIZE_INPUT_MAX, L"%lld", (long long)borrow->loan_date);
+    swprintf(date[1], SIZE_INPUT_MAX, L"%lld", (long long)borrow->return_date);
+    wchar_t number[SIZE_BOOK_NUMBER + 1];
+    swprintf(number, SIZE_BOOK_NUMBER + 1, L"%07u", borrow->book_number);
+    wchar_t book_name[SIZE_TEXT_MAX];
+    decode_text(borrow->book_name, book_name, SIZE_TEXT_MAX);
+    wchar_t student_number[SIZE_STUDENT_NUMBER + 1];
+    format_student_number(borrow->student_number, student_number);
+
+    const wchar_t *fields[5] = {student_number, number, book_name, date[0], date[1]};
+    write_journal(journal, JOURNAL_BORROW_BOOK, 5, fields);
+}
+void journal_return_book(Journal *journal, const Borrow *borrow)
+{
+    wchar_t number[SIZE_BOOK_NUMBER + 1];
+    swprintf(number, SIZE_BOOK_NUMBER + 1, L"%07u", borrow->book_number);
+    wchar_t student_number[SIZE_STUDENT_NUMBER + 1];
+    format_student_number(borrow->student_number, student_number);
+
+    const wchar_t *fields[2] = {student_number, number};
+    write_journal(journal, JOURNAL_RETURN_BOOK, 2, fields);
+}
+void journal_reserve_book_numbers(Journal *journal, const uint32_t next_number)
+{
+    wchar_t number[SIZE_INPUT_MAX];
+    swprintf(number, SIZE_INPUT_MAX, L"%u", next_number);
+
+    const wchar_t *fields[1] = {number};
+    write_journal(journal, JOURNAL_RESERVE_BOOK_NUMBERS, 1, fields);
+}
+
+void save_checkpoint(Data *data)
+{
+    // 스냅샷에 들어간 엔트리만 지워지도록 먼저 커밋함, 커밋하지 못하면 저널을 남겨 둠
+    const int result = commit_journal(&data->journal);
+
+    // 바뀐 레코드만 덧붙이고, 안 되면 전체를 다시 씀
+    Snapshot *snapshot = &data->snapshots[SNAPSHOT_CLIENT];
+    if (snapshot->need_rewrite || append_clients_snapshot(snapshot, STRING_CLIENT_SNAPSHOT_FILE) == EOF)
+        save_clients_snapshot(&data->client_index, STRING_CLIENT_SNAPSHOT_FILE);
+    clear_snapshot_changes(snapshot);
+
+    snapshot = &data->snapshots[SNAPSHOT_BOOK];
+    if (snapshot->need_rewrite || append_books_snapshot(snapshot, data->book_index.next_number, STRING_BOOK_SNAPSHOT_FILE) == EOF)
+        save_books_snapshot(&data->book_index, STRING_BOOK_SNAPSHOT_FILE);
+    clear_snapshot_changes(snapshot);
+
+    snapshot = &data->snapshots[SNAPSHOT_BORROW];
+    if (snapshot->need_rewrite || append_borrows_snapshot(snapshot, STRING_BORROW_SNAPSHOT_FILE) == EOF)
+        save_borrows_snapshot(&data->borrows, STRING_BORROW_SNAPSHOT_FILE);
+    clear_snapshot_changes(snapshot);
+
+    save_loan_history(&data->history, STRING_HISTORY_FILE);
+
+    if (result != EOF)
+        clear_journal(&data->journal);
 }
-void destroy_borrow(Borrow *borrow)
+int commit_changes(Data *data)
 {
-    if (borrow != NULL)
+    if (wait_journal_commit(&data->journal) == EOF)
     {
-        if (borrow->book_name != NULL)
-            free(borrow->book_name);
-        free(borrow);
+        wprintf(STRING_JOURNAL_FAILED);
+        sleep(1);
+        return EOF;
     }
+    if (data->journal.entry_count >= JOURNAL_CHECKPOINT_SIZE)
+        save_checkpoint(data);
+
+    return 0;
 }
 
 Screens *init_screens(void)
@@ -1624,6 +8435,10 @@ Screens *init_screens(void)
     screens->screens[SCREEN_MODIFY_CLIENT].draw = draw_modify_client_screen;
     screens->screens[SCREEN_MODIFY_CLIENT].input = input_modify_client_screen;
 
+    screens->screens[SCREEN_DUE_BORROW].type = SCREEN_DUE_BORROW;
+    screens->screens[SCREEN_DUE_BORROW].draw = draw_due_borrow_screen;
+    screens->screens[SCREEN_DUE_BORROW].input = input_due_borrow_screen;
+
     return screens;
 }
 void change_screen(Screens *screens, char type)
@@ -1695,7 +8510,15 @@ void input_sign_up_screen(const wchar_t *input, Data *data)
 {
     if (input == NULL || data == NULL)
         return;
-    if (find_client_by_student_number(data->clients, input) != NULL)
+    const uint32_t student_number = get_student_number(input);
+    if (student_number == STUDENT_NUMBER_NONE || student_number == STUDENT_NUMBER_ADMIN)
+    {
+        wprintf(L"학번은 숫자 8자리로 입력하세요.\n");
+        sleep(1);
+        change_screen(data->screens, SCREEN_INIT);
+        return;
+    }
+    if (find_client_by_student_number(&data->client_index, student_number) != NULL)
     {
         wprintf(L"이미 존재하는 학번입니다.\n");
         sleep(1);
@@ -1703,41 +8526,43 @@ void input_sign_up_screen(const wchar_t *input, Data *data)
         return;
     }
     wchar_t input_tmp[SIZE_INPUT_MAX] = {0};
-    wchar_t *input_p = NULL;
-    size_t len = 0;
+    RecordArena *arena = &data->arenas[SNAPSHOT_CLIENT];
 
-    Client *client = malloc(sizeof(Client));
+    Client *client = allocate_record(arena);
 
-    wcscpy(client->student_number, input);
+    client->student_number = student_number;
 
     wprintf(L"비밀번호: ");
     read_string_by_token(stdin, L"\n", 1, input_tmp);
-    len = wcslen(input_tmp);
-    input_p = malloc(sizeof(wchar_t) * (len + 1));
-    wcscpy(input_p, input_tmp);
-    client->password = input_p;
+    client->password = create_arena_string(arena, input_tmp);
 
     wprintf(L"이름: ");
     read_string_by_token(stdin, L"\n", 1, input_tmp);
-    len = wcslen(input_tmp);
-    input_p = malloc(sizeof(wchar_t) * (len + 1));
-    wcscpy(input_p, input_tmp);
-    client->name = input_p;
+    client->name = create_arena_string(arena, input_tmp);
 
     wprintf(L"주소: ");
     read_string_by_token(stdin, L"\n", 1, input_tmp);
-    len = wcslen(input_tmp);
-    input_p = malloc(sizeof(wchar_t) * (len + 1));
-    wcscpy(input_p, input_tmp);
-    client->address = input_p;
+    client->address = create_arena_string(arena, input_tmp);
 
     wprintf(L"전화번호: ");
     read_string_by_token(stdin, L"\n", 1, input_tmp);
-    wcscpy(client->phone_number, input_tmp);
-
-    data->clients = insert_client(data->clients, client);
-    save_clients(data->clients, STRING_CLIENT_FILE);
-    wprintf(L"회원가입이 되셨습니다.\n");
+    client->phone_number = get_phone_number(input_tmp);
+    if (client->phone_number == PHONE_NUMBER_NONE)
+    {
+        destroy_client(arena, client);
+        wprintf(L"전화번호는 숫자 %d자리 이하로 입력하세요.\n", SIZE_PHONE_NUMBER);
+        sleep(1);
+        change_screen(data->screens, SCREEN_INIT);
+        return;
+    }
+    client->dirty = 0;
+    client->snapshot_offset = 0;
+
+    insert_client(&data->clients, &data->client_index, client);
+    mark_dirty(&data->snapshots[SNAPSHOT_CLIENT], client, &client->dirty, DIRTY_INSERTED);
+    journal_insert_client(&data->journal, client);
+    if (commit_changes(data) != EOF)
+        wprintf(L"회원가입이 되셨습니다.\n");
     sleep(1);
     change_screen(data->screens, SCREEN_INIT);
 }
@@ -1754,18 +8579,19 @@ void input_sign_in_screen(const wchar_t *input, Data *data)
         return;
     wchar_t input_tmp[SIZE_INPUT_MAX] = {0};
 
-    Client *client = find_client_by_student_number(data->clients, input);
+    const uint32_t student_number = get_student_number(input);
+    Client *client = find_client_by_student_number(&data->client_index, student_number);
 
-    if (wcscmp(L"admin", input) == 0)
+    if (student_number == STUDENT_NUMBER_ADMIN)
     {
         if (client == NULL)
         {
-            client = malloc(sizeof(Client));
-
-            wcscpy(client->student_number, input);
+            client = create_client(&data->arenas[SNAPSHOT_CLIENT], student_number, L"", L"", L"", 0);
 
-            data->clients = insert_client(data->clients, client);
-            save_clients(data->clients, STRING_CLIENT_FILE);
+            insert_client(&data->clients, &data->client_index, client);
+            mark_dirty(&data->snapshots[SNAPSHOT_CLIENT], client, &client->dirty, DIRTY_INSERTED);
+            journal_insert_client(&data->journal, client);
+            commit_changes(data);
         }
 
         data->is_admin = 1;
@@ -1790,7 +8616,7 @@ void input_sign_in_screen(const wchar_t *input, Data *data)
         change_screen(data->screens, SCREEN_MENU_ADMIN);
         return;
     }
-    if (wcscmp(client->password, input_tmp) == 0)
+    if (compare_text(client->password, input_tmp) == 0)
     {
         data->login_client = client;
         wprintf(L"로그인이 되셨습니다.\n");
@@ -1826,26 +8652,36 @@ void input_menu_member_screen(const wchar_t *input, Data *data)
         change_screen(data->screens, SCREEN_FIND_BOOK);
         break;
     case L'2':
+    {
+        BorrowCursor borrows;
         clear_screen();
         wprintf(L">> 내 대여 목록 <<\n");
-        print_borrows(find_borrows_by_client(data->borrows, data->login_client));
+        find_borrows_by_client(&data->borrow_index, data->login_client, &borrows);
+        print_borrows(&borrows);
         sleep(5);
         break;
+    }
     case L'3':
         change_screen(data->screens, SCREEN_MODIFY_CLIENT);
         break;
     case L'4':
-        if (find_borrows_by_client(data->borrows, data->login_client) != NULL) {
+    {
+        BorrowCursor borrows;
+        find_borrows_by_client(&data->borrow_index, data->login_client, &borrows);
+        if (next_borrow_cursor(&borrows) != NULL) {
 			clear_screen();
 			wprintf(L"대여중인 책이 있으니 탈퇴가 불가합니다\n");
 			sleep(5);
 			break;
         }
-		data->clients = remove_client(data->clients, data->login_client);
+        journal_remove_client(&data->journal, data->login_client);
+        mark_removed(&data->snapshots[SNAPSHOT_CLIENT], data->login_client, data->login_client->snapshot_offset, data->login_client->dirty);
+		remove_client(&data->clients, &data->client_index, &data->arenas[SNAPSHOT_CLIENT], data->login_client);
         data->login_client = NULL;
-        save_clients(data->clients, STRING_CLIENT_FILE);
+        commit_changes(data);
         change_screen(data->screens, SCREEN_INIT);
         break;
+    }
     case L'5':
         change_screen(data->screens, SCREEN_INIT);
         break;
@@ -1865,6 +8701,7 @@ void draw_menu_admin_screen(Data *data)
         L"3. 도서 대여           4. 도서 반납\n"
         L"5. 도서 검색           6. 회원 목록\n"
         L"7. 로그아웃            8. 프로그램 종료\n"
+        L"9. 연체 관리\n"
         L"\n"
         L"번호를 선택하세요: ");
 }
@@ -1896,17 +8733,19 @@ void input_menu_admin_screen(const wchar_t *input, Data *data)
 			L">>회원 목록<<\n"
 			L"1. 이름 검색 2. 학번 검색\n"
 			L"3. 전체 검색 4. 이전 메뉴\n"
+			L"5. 초성 검색\n"
 			L"\n"
 			L"번호를 선택하세요: ");
 		wscanf(L"%ls", input);
 		Client * client;
+		LinkedList *clients;
 		switch (input[0])
 		{
 		case L'1':
 			clear_screen();
 			wprintf(L"이름을 입력하세요\n");
 			wscanf(L"%ls", input);
-			client = find_client_by_name(data->clients, input);
+			client = find_client_by_name(&data->clients, input);
 			clear_screen();
 			if (client != NULL)
 				print_client(client);
@@ -1918,7 +8757,7 @@ void input_menu_admin_screen(const wchar_t *input, Data *data)
 			clear_screen();
 			wprintf(L"학번을 입력하세요\n");
 			wscanf(L"%ls", input);
-			client = find_client_by_student_number(data->clients, input);
+			client = find_client_by_student_number(&data->client_index, get_student_number(input));
 			clear_screen();
 			if (client != NULL)
 				print_client(client);
@@ -1929,11 +8768,27 @@ void input_menu_admin_screen(const wchar_t *input, Data *data)
 		case L'3':
 			clear_screen();
 			wprintf(L">> 내 회원 목록 <<\n");
-			print_clients(data->clients);
+			print_clients(&data->client_index);
 			sleep(5);
 			break;
 		case L'4':
 			break;
+		case L'5':
+			clear_screen();
+			wprintf(L"초성을 입력하세요\n");
+			wscanf(L"%ls", input);
+			clients = find_clients_by_choseong(&data->client_index, input);
+			clear_screen();
+			for (const LinkedList *current = clients; current != NULL; current = current->next)
+			{
+				wprintf(L"\n");
+				print_client(current->contents);
+			}
+			if (clients == NULL)
+				wprintf(L"해당하는 회원이 없습니다\n");
+			destroy_list(clients);
+			sleep(5);
+			break;
 		default:
 			break;
 		}
@@ -1947,6 +8802,9 @@ void input_menu_admin_screen(const wchar_t *input, Data *data)
     case L'8':
         data->is_running = 0;
         break;
+    case L'9':
+        change_screen(data->screens, SCREEN_DUE_BORROW);
+        break;
     default:
         break;
     }
@@ -1975,27 +8833,78 @@ void input_regist_book_screen(const wchar_t *input, Data *data)
     wprintf(L"소장처: ");
     read_string_by_token(stdin, L"\n", 1, input_tmp[3]);
 
-    book =  create_book(data->books, input, input_tmp[0], input_tmp[1], input_tmp[2], input_tmp[3]);
+    const uint64_t ISBN = get_ISBN_key(input_tmp[2]);
+    if (ISBN == ISBN_KEY_OTHER)
+    {
+        wprintf(L"ISBN은 숫자 %d자리로 입력하세요.\n", SIZE_ISBN);
+        sleep(1);
+        change_screen(data->screens, data->screens->pre_screen_type);
+        return;
+    }
+    book = create_book(&data->arenas[SNAPSHOT_BOOK], &data->book_index, input, input_tmp[0], input_tmp[1], ISBN, input_tmp[3]);
+    if (book == NULL)
+    {
+        wprintf(L"도서번호를 모두 사용하여 더 등록할 수 없습니다.\n");
+        sleep(1);
+        change_screen(data->screens, data->screens->pre_screen_type);
+        return;
+    }
 
     wprintf(
         L"\n"
         L"자동입력 사항\n"
         L"\n"
         L"대여가능 여부: %lc\n"
-        L"도서번호: %ls\n"
+        L"도서번호: %07u\n"
         L"\n"
-        L"등록하시겠습니까? ",
+        L"등록하시겠습니까?(여러 권이면 권수) ",
         book->availability, book->number
     );
     wscanf(L"%ls", input_tmp[0]);
 
-    if (input_tmp[0][0] == L'Y' || input_tmp[0][0] == L'y')
+    // 권수를 입력하면 같은 책을 연속된 번호로 한꺼번에 등록함
+    wchar_t *end = NULL;
+    const unsigned long copy_count = input_tmp[0][0] == L'Y' || input_tmp[0][0] == L'y' ? 1 : wcstoul(input_tmp[0], &end, 10);
+    const uint32_t number = copy_count > 1 && *end == L'\0' && copy_count <= BOOK_NUMBER_MAX ? allocate_book_numbers(&data->book_index, (uint32_t)copy_count) : 0;
+
+    if (copy_count == 1)
+    {
+        insert_book(&data->books, &data->book_index, book);
+        mark_dirty(&data->snapshots[SNAPSHOT_BOOK], book, &book->dirty, DIRTY_INSERTED);
+        journal_insert_book(&data->journal, book);
+        commit_changes(data);
+    }
+    else if (number != 0)
     {
-        data->books = insert_book(data->books, book);
-        save_books(data->books, STRING_BOOK_FILE);
+        journal_reserve_book_numbers(&data->journal, data->book_index.next_number);
+        for (uint32_t i = 0; i < copy_count; i++)
+        {
+            // 문자열은 아레나에서 바뀌지 않으므로 같이 씀
+            Book *copy = book;
+            if (i > 0)
+            {
+                copy = allocate_record(&data->arenas[SNAPSHOT_BOOK]);
+                *copy = *book;
+                copy->dirty = 0;
+            }
+            copy->number = number + i;
+            insert_book(&data->books, &data->book_index, copy);
+            mark_dirty(&data->snapshots[SNAPSHOT_BOOK], copy, &copy->dirty, DIRTY_INSERTED);
+            journal_insert_book(&data->journal, copy);
+        }
+        if (commit_changes(data) != EOF)
+            wprintf(L"%07u부터 %07u까지 %lu권을 등록했습니다.\n", number, number + (uint32_t)copy_count - 1, copy_count);
+        sleep(1);
     }
     else
-        destroy_book(book);
+    {
+        if (copy_count > 1)
+        {
+            wprintf(L"도서번호는 %07u까지만 쓸 수 있어 등록할 수 없습니다.\n", BOOK_NUMBER_MAX);
+            sleep(1);
+        }
+        destroy_book(&data->arenas[SNAPSHOT_BOOK], book);
+    }
 
     change_screen(data->screens, data->screens->pre_screen_type);
 }
@@ -2014,19 +8923,19 @@ void input_remove_book_screen(const wchar_t *input, Data *data)
         return;
 
     wchar_t find_data[SIZE_INPUT_MAX] = {0};
-    LinkedList *current_books = NULL;
+    BookCursor current_books;
 
     switch (input[0])
     {
     case L'1':
         wprintf(L"도서명을 입력하세요: ");
         read_string_by_token(stdin, L"\n", 1, find_data);
-        current_books = find_books_by_name(data->books, find_data);
+        find_books_by_name(&data->book_index, find_data, &current_books);
         break;
     case L'2':
         wprintf(L"ISBN을 입력하세요: ");
         wscanf(L"%ls", find_data);
-        current_books = find_books_by_ISBN(data->books, find_data);
+        find_books_by_ISBN(&data->book_index, find_data, &current_books);
         break;
     default:
         return;
@@ -2034,7 +8943,9 @@ void input_remove_book_screen(const wchar_t *input, Data *data)
 
     clear_screen();
     wprintf(L">> 검색 결과 <<\n");
-    if (current_books == NULL)
+    BookCursor current = current_books;
+    const Book *first_book = next_book_cursor(&current);
+    if (first_book == NULL)
     {
         wprintf(L"검색결과가 없습니다.\n");
         sleep(1);
@@ -2042,26 +8953,31 @@ void input_remove_book_screen(const wchar_t *input, Data *data)
         return;
     }
 
-    const LinkedList *current = current_books;
+    const Book *current_book = first_book;
     wchar_t book_num[SIZE_BOOK_NUMBER+1] = {0};
+    wchar_t ISBN[SIZE_ISBN + 1];
+    format_ISBN(first_book->ISBN, ISBN);
     wprintf(L"도서번호: ");
-    while (current != NULL)
+    while (current_book != NULL)
     {
-        wprintf(L"%ls(삭제 가능 여부 : %lc) ", ((Book *)current->contents)->number, ((Book *)current->contents)->availability);
-        current = current->next;
+        wprintf(L"%07u(삭제 가능 여부 : %lc) ", current_book->number, current_book->availability);
+        current_book = next_book_cursor(&current);
     }
     wprintf(
         L"\n"
-        L"도서명 : %ls \n"
-        L"출판사 : %ls \n"
-        L"저자명 : %ls \n"
+        L"도서명 : %s \n"
+        L"출판사 : %s \n"
+        L"저자명 : %s \n"
         L"ISBN : %ls \n"
-        L"소장처 : %ls \n"
+        L"소장처 : %s \n"
         L"\n"
         L"삭제할 도서의 번호를 입력하세요: ",
-        ((Book *)current_books->contents)->name, ((Book *)current_books->contents)->publisher, ((Book *)current_books->contents)->author, ((Book *)current_books->contents)->ISBN, ((Book *)current_books->contents)->location);
+        first_book->name, first_book->publisher, first_book->author, ISBN, first_book->location);
     wscanf(L"%ls", book_num);
-    Book *book = find_book_by_number(current_books, book_num);
+    // 검색 결과에 있는 도서만 삭제할 수 있음
+    Book *book = find_book_by_number(&data->book_index, get_book_number(book_num));
+    if (book != NULL && !has_book(&current_books, book))
+        book = NULL;
     if (book == NULL)
     {
         wprintf(L"검색결과가 없습니다.\n");
@@ -2069,17 +8985,17 @@ void input_remove_book_screen(const wchar_t *input, Data *data)
         change_screen(data->screens, data->screens->pre_screen_type);
         return;
     }
-    if (book->availability == L'Y')
+    if (book->availability == L'Y' && find_borrow_by_book(&data->borrow_index, book->number) == NULL)
     {
-        data->books = remove_book(data->books, book);
-        save_books(data->books, STRING_BOOK_FILE);
-        wprintf(L"삭제되었습니다.\n");
+        journal_remove_book(&data->journal, book);
+        mark_removed(&data->snapshots[SNAPSHOT_BOOK], book, book->snapshot_offset, book->dirty);
+        remove_book(&data->books, &data->book_index, &data->arenas[SNAPSHOT_BOOK], book);
+        if (commit_changes(data) != EOF)
+            wprintf(L"삭제되었습니다.\n");
     }
     else
         wprintf(L"이 도서는 삭제할 수 없습니다.\n");
-        
-    if (current_books != data->books)
-        destroy_list(current_books);
+
     sleep(1);
     change_screen(data->screens, data->screens->pre_screen_type);
 }
@@ -2098,7 +9014,7 @@ void input_borrow_book_screen(const wchar_t *input, Data *data)
         return;
 
     wchar_t find_data[SIZE_INPUT_MAX] = {0};
-    LinkedList *current_books = NULL;
+    BookCursor current_books;
 
     clear_screen();
     switch (input[0])
@@ -2106,12 +9022,12 @@ void input_borrow_book_screen(const wchar_t *input, Data *data)
     case L'1':
         wprintf(L"도서명을 입력하세요: ");
         read_string_by_token(stdin, L"\n", 1, find_data);
-        current_books = find_books_by_name(data->books, find_data);
+        find_books_by_name(&data->book_index, find_data, &current_books);
         break;
     case L'2':
         wprintf(L"ISBN을 입력하세요: ");
         wscanf(L"%ls", find_data);
-        current_books = find_books_by_ISBN(data->books, find_data);
+        find_books_by_ISBN(&data->book_index, find_data, &current_books);
         break;
     default:
         return;
@@ -2119,7 +9035,9 @@ void input_borrow_book_screen(const wchar_t *input, Data *data)
 
     clear_screen();
     wprintf(L"\n>> 검색 결과 <<\n");
-    if (current_books == NULL)
+    BookCursor current = current_books;
+    const Book *first_book = next_book_cursor(&current);
+    if (first_book == NULL)
     {
         wprintf(L"검색결과가 없습니다.\n");
         sleep(1);
@@ -2127,31 +9045,35 @@ void input_borrow_book_screen(const wchar_t *input, Data *data)
         return;
     }
 
-    const LinkedList *current = current_books;
+    const Book *current_book = first_book;
     wchar_t book_num[SIZE_BOOK_NUMBER+1] = {0};
     wchar_t student_num[SIZE_STUDENT_NUMBER+1] = {0};
+    wchar_t ISBN[SIZE_ISBN + 1];
+    format_ISBN(first_book->ISBN, ISBN);
     wprintf(L"도서번호: ");
-    while (current != NULL)
+    while (current_book != NULL)
     {
-        wprintf(L"%ls(대여 가능 여부 : %lc) ", ((Book *)current->contents)->number, ((Book *)current->contents)->availability);
-        current = current->next;
+        wprintf(L"%07u(대여 가능 여부 : %lc) ", current_book->number, current_book->availability);
+        current_book = next_book_cursor(&current);
     }
     wprintf(
         L"\n"
-        L"도서명 : %ls \n"
-        L"출판사 : %ls \n"
-        L"저자명 : %ls \n"
+        L"도서명 : %s \n"
+        L"출판사 : %s \n"
+        L"저자명 : %s \n"
         L"ISBN : %ls \n"
-        L"소장처 : %ls \n"
+        L"소장처 : %s \n"
         L"\n"
         L"학번을 입력하세요: ",
-        ((Book *)current_books->contents)->name, ((Book *)current_books->contents)->publisher, ((Book *)current_books->contents)->author, ((Book *)current_books->contents)->ISBN, ((Book *)current_books->contents)->location);
+        first_book->name, first_book->publisher, first_book->author, ISBN, first_book->location);
     wscanf(L"%ls", student_num);
     wprintf(L"도서번호를 입력하세요: ");
     wscanf(L"%ls", book_num);
     
-    Book *book = find_book_by_number(current_books, book_num);
-    Client *student = find_client_by_student_number(data->clients, student_num);
+    Book *book = find_book_by_number(&data->book_index, get_book_number(book_num));
+    if (book != NULL && !has_book(&current_books, book))
+        book = NULL;
+    Client *student = find_client_by_student_number(&data->client_index, get_student_number(student_num));
     if (book == NULL || student == NULL)
     {
         wprintf(L"검색결과가 없습니다.\n");
@@ -2167,20 +9089,23 @@ void input_borrow_book_screen(const wchar_t *input, Data *data)
 
         if (input_tmp[0] == L'Y' || input_tmp[0] == L'y')
         {
-            data->borrows = insert_borrow(data->borrows, create_borrow(student, book));
-            book->availability = L'N';
-            save_books(data->books, STRING_BOOK_FILE);
-            save_borrows(data->borrows, STRING_BORROW_FILE);
-            wprintf(L"대여되었습니다.\n");
+            Borrow *borrow = create_borrow(&data->arenas[SNAPSHOT_BORROW], student, book);
+            insert_borrow(&data->borrows, &data->borrow_index, borrow);
+            add_loan_history(&data->history, borrow);
+            set_book_availability(&data->book_index, book, L'N');
+            count_book_loan(&data->book_index, book);
+            mark_dirty(&data->snapshots[SNAPSHOT_BORROW], borrow, &borrow->dirty, DIRTY_INSERTED);
+            mark_dirty(&data->snapshots[SNAPSHOT_BOOK], book, &book->dirty, DIRTY_AVAILABILITY | DIRTY_LOAN_COUNT);
+            journal_borrow_book(&data->journal, borrow);
+            if (commit_changes(data) != EOF)
+                wprintf(L"대여되었습니다.\n");
         }
         else
             wprintf(L"취소되었습니다.\n");
     }
     else
         wprintf(L"이 도서는 대여할 수 없습니다.\n");
-        
-    if (current_books != data->books)
-        destroy_list(current_books);
+
     sleep(1);
     change_screen(data->screens, data->screens->pre_screen_type);
 }
@@ -2191,27 +9116,34 @@ void draw_return_book_screen(Data *data)
 }
 void input_return_book_screen(const wchar_t *input, Data *data)
 {
-    Client *student = find_client_by_student_number(data->clients, input);
-    LinkedList *borrows = find_borrows_by_client(data->borrows, student);
+    Client *student = find_client_by_student_number(&data->client_index, get_student_number(input));
+    BorrowCursor borrows;
     wchar_t input_tmp[SIZE_BOOK_NUMBER+1] = {0};
 
     clear_screen();
     wprintf(L"\n>> 회원의 대여 목록 <<\n");
-    print_borrows(borrows);
+    find_borrows_by_client(&data->borrow_index, student, &borrows);
+    print_borrows(&borrows);
     wprintf(L"\n반납할 도서번호를 입력하세요: ");
     wscanf(L"%ls", input_tmp);
 
-    Book *book = find_book_by_number(data->books, input_tmp);
+    Book *book = find_book_by_number(&data->book_index, get_book_number(input_tmp));
 
     wprintf(L"도서 반납처리를 할까요? ");
     wscanf(L"%ls", input_tmp);
 
     if (input_tmp[0] == L'Y' || input_tmp[0] == L'y')
     {
-        book->availability = L'Y';
-        save_books(data->books, STRING_BOOK_FILE);
-        data->borrows = remove_borrow(data->borrows, find_borrow(data->borrows, student, book));
-        save_borrows(data->borrows, STRING_BORROW_FILE);
+        Borrow *borrow = find_borrow(&data->borrow_index, student, book);
+        set_book_availability(&data->book_index, book, L'Y');
+        mark_dirty(&data->snapshots[SNAPSHOT_BOOK], book, &book->dirty, DIRTY_AVAILABILITY);
+        if (borrow != NULL)
+        {
+            journal_return_book(&data->journal, borrow);
+            mark_removed(&data->snapshots[SNAPSHOT_BORROW], borrow, borrow->snapshot_offset, borrow->dirty);
+            remove_borrow(&data->borrows, &data->borrow_index, &data->arenas[SNAPSHOT_BORROW], borrow);
+        }
+        commit_changes(data);
     }
     else
         wprintf(L"취소하였습니다.\n");
@@ -2227,6 +9159,8 @@ void draw_find_book_screen(Data *data)
         L"1. 도서명 검색           2. 출판사 검색\n"
         L"3. ISBN 검색            4. 저자명 검색\n"
         L"5. 전체 검색             6. 이전 메뉴\n"
+        L"7. 키워드 검색           8. 초성 검색\n"
+        L"9. 도서명 자동 완성      0. 조건 검색\n"
         L"\n"
         L"번호를 선택하세요: ");
 }
@@ -2236,7 +9170,8 @@ void input_find_book_screen(const wchar_t *input, Data *data)
         return;
 
     wchar_t find_data[SIZE_INPUT_MAX] = {0};
-    LinkedList *current_books = NULL;
+    BookCursor current_books;
+    init_book_cursor(&data->book_index, -1, NULL, 0, 0, &current_books);
 
     clear_screen();
     switch (input[0])
@@ -2244,37 +9179,114 @@ void input_find_book_screen(const wchar_t *input, Data *data)
     case L'1':
         wprintf(L"도서명을 입력하세요: ");
         read_string_by_token(stdin, L"\n", 1, find_data);
-        current_books = find_books_by_name(data->books, find_data);
+        find_books_by_name(&data->book_index, find_data, &current_books);
+        // 같은 도서명이 없으면 비슷한 도서명을 찾음
+        BookCursor current = current_books;
+        if (next_book_cursor(&current) == NULL && get_fuzzy_distance(find_data) > 0)
+        {
+            LinkedList *similar_books = find_books_by_similar_name(&data->book_index, find_data, get_fuzzy_distance(find_data));
+            if (similar_books != NULL)
+            {
+                clear_screen();
+                wprintf(L">> 비슷한 도서명 검색 결과 <<\n");
+                init_book_list_cursor(similar_books, &current_books);
+                print_books(&current_books);
+                destroy_list(similar_books);
+                sleep(5);
+                return;
+            }
+        }
         break;
     case L'2':
         wprintf(L"출판사를 입력하세요: ");
         read_string_by_token(stdin, L"\n", 1, find_data);
-        current_books = find_books_by_publisher(data->books, find_data);
+        find_books_by_publisher(&data->book_index, find_data, &current_books);
         break;
     case L'3':
         wprintf(L"ISBN을 입력하세요: ");
         wscanf(L"%ls", find_data);
-        current_books = find_books_by_ISBN(data->books, find_data);
+        find_books_by_ISBN_prefix(&data->book_index, find_data, &current_books);
         break;
     case L'4':
         wprintf(L"저자명을 입력하세요: ");
         read_string_by_token(stdin, L"\n", 1, find_data);
-        current_books = find_books_by_author(data->books, find_data);
+        find_books_by_author(&data->book_index, find_data, &current_books);
         break;
     case L'5':
-        current_books = data->books;
+        init_book_cursor(&data->book_index, QUERY_FIELD_MAX, NULL, 0, 0, &current_books);
         break;
     case L'6':
         change_screen(data->screens, data->screens->pre_screen_type);
         return;
+    case L'7':
+        wprintf(L"검색어를 입력하세요: ");
+        read_string_by_token(stdin, L"\n", 1, find_data);
+        find_books_by_keyword(&data->book_index, find_data, &current_books);
+        break;
+    case L'8':
+        wprintf(L"초성을 입력하세요: ");
+        read_string_by_token(stdin, L"\n", 1, find_data);
+        find_books_by_choseong(&data->book_index, find_data, &current_books);
+        break;
+    case L'9':
+    {
+        const TitleEntry *suggestions[SIZE_SUGGESTION];
+        size_t count = 0;
+
+        wprintf(L"도서명 앞부분을 입력하세요: ");
+        read_string_by_token(stdin, L"\n", 1, find_data);
+        count = find_title_suggestions(&data->book_index, find_data, suggestions);
+        if (count == 0)
+            break;
+
+        wprintf(L"\n>> 추천 도서명 <<\n");
+        for (size_t i = 0; i < count; i++)
+            wprintf(L"%zu. %ls (대여 %llu회)\n", i + 1, suggestions[i]->title, (unsigned long long)suggestions[i]->loan_count);
+        wprintf(L"\n번호를 선택하세요: ");
+        read_string_by_token(stdin, L"\n", 1, find_data);
+        const size_t choice = wcstoul(find_data, NULL, 10);
+        if (choice >= 1 && choice <= count)
+            find_books_by_name(&data->book_index, suggestions[choice - 1]->title, &current_books);
+        break;
+    }
+    case L'0':
+    {
+        Query *query = malloc(sizeof(Query));
+        size_t count = 0;
+
+        wprintf(
+            L"예) author = 김명호 AND available OR keyword = 알고리즘\n"
+            L"앞에 EXPLAIN을 붙이면 실행 계획을 보여줍니다.\n"
+            L"검색 조건을 입력하세요: ");
+        read_string_by_token(stdin, L"\n", 1, find_data);
+        clear_screen();
+        if (parse_query(find_data, query) == EOF)
+            wprintf(L"잘못된 검색 조건입니다.\n");
+        else
+        {
+            plan_query(&data->book_index, query);
+            if (query->is_explain)
+            {
+                print_query_plan(query);
+                count = run_query(&data->book_index, query, NULL, NULL);
+            }
+            else
+            {
+                wprintf(L">> 검색 결과 <<\n");
+                count = run_query(&data->book_index, query, print_query_book, NULL);
+            }
+            wprintf(L"\n검색된 도서: %zu권\n", count);
+        }
+        free(query);
+        sleep(5);
+        return;
+    }
     default:
         return;
     }
     clear_screen();
     wprintf(L">> 검색 결과 <<\n");
-    print_books(current_books);
-    if (current_books != data->books)
-        destroy_list(current_books);
+    print_books(&current_books);
     sleep(5);
 }
 
@@ -2289,37 +9301,81 @@ void input_modify_client_screen(const wchar_t *input, Data *data)
     if (input == NULL || data == NULL)
         return;
 
-    wchar_t input_tmp[SIZE_INPUT_MAX] = {0};
-    wchar_t *input_p = NULL;
-    size_t len = 0;
-
-    if (data->login_client->password != NULL)
-        free(data->login_client->password);
-    if (data->login_client->address != NULL)
-        free(data->login_client->address);
-
-    len = wcslen(input);
-    input_p = malloc(sizeof(wchar_t) * (len + 1));
-    wcscpy(input_p, input);
-    data->login_client->password = input_p;
+    wchar_t input_tmp[2][SIZE_INPUT_MAX] = {0};
 
     wprintf(L"주소: ");
-    read_string_by_token(stdin, L"\n", 1, input_tmp);
-    len = wcslen(input_tmp);
-    input_p = malloc(sizeof(wchar_t) * (len + 1));
-    wcscpy(input_p, input_tmp);
-    data->login_client->address = input_p;
+    read_string_by_token(stdin, L"\n", 1, input_tmp[0]);
 
     wprintf(L"전화번호: ");
-    read_string_by_token(stdin, L"\n", 1, input_tmp);
-    wcscpy(data->login_client->phone_number, input_tmp);
+    read_string_by_token(stdin, L"\n", 1, input_tmp[1]);
+    const uint64_t phone_number = get_phone_number(input_tmp[1]);
+    if (phone_number == PHONE_NUMBER_NONE)
+    {
+        wprintf(L"전화번호는 숫자 %d자리 이하로 입력하세요.\n", SIZE_PHONE_NUMBER);
+        sleep(1);
+        change_screen(data->screens, SCREEN_MENU_MEMBER);
+        return;
+    }
 
-    save_clients(data->clients, STRING_CLIENT_FILE);
-    wprintf(L"개인정보 수정이 되셨습니다.\n");
+    // 이전 문자열은 아레나와 함께 해제됨
+    data->login_client->password = create_arena_string(&data->arenas[SNAPSHOT_CLIENT], input);
+    data->login_client->address = create_arena_string(&data->arenas[SNAPSHOT_CLIENT], input_tmp[0]);
+    data->login_client->phone_number = phone_number;
+
+    mark_dirty(&data->snapshots[SNAPSHOT_CLIENT], data->login_client, &data->login_client->dirty, DIRTY_STRINGS | DIRTY_PHONE_NUMBER);
+    journal_update_client(&data->journal, data->login_client);
+    if (commit_changes(data) != EOF)
+        wprintf(L"개인정보 수정이 되셨습니다.\n");
     sleep(1);
     change_screen(data->screens, SCREEN_MENU_MEMBER);
 }
 
+void draw_due_borrow_screen(Data *data)
+{
+    wprintf(
+        L">> 연체 관리 <<\n"
+        L"1. 연체 목록 2. 반납 예정 목록\n"
+        L"3. 이전 메뉴\n"
+        L"\n"
+        L"번호를 선택하세요: ");
+}
+void input_due_borrow_screen(const wchar_t *input, Data *data)
+{
+    if (input == NULL || data == NULL)
+        return;
+
+    BorrowCursor borrows;
+    wchar_t input_tmp[SIZE_INPUT_MAX] = {0};
+    size_t count = 0;
+
+    switch (input[0])
+    {
+    case L'1':
+        clear_screen();
+        wprintf(L">> 연체 목록 <<\n");
+        find_overdue_borrows(&data->borrow_index, time(NULL), &borrows);
+        count = print_due_borrows(&borrows, SIZE_MAX);
+        wprintf(L"\n연체된 대여: %zu건\n", count);
+        break;
+    case L'2':
+        wprintf(L"조회할 건수를 입력하세요: ");
+        wscanf(L"%ls", input_tmp);
+        count = wcstoul(input_tmp, NULL, 10);
+        clear_screen();
+        wprintf(L">> 반납 예정 목록 <<\n");
+        find_due_borrows(&data->borrow_index, time(NULL), &borrows);
+        count = print_due_borrows(&borrows, count > 0 ? count : SIZE_DUE_LIST);
+        wprintf(L"\n반납 예정 대여: %zu건\n", count);
+        break;
+    case L'3':
+        change_screen(data->screens, SCREEN_MENU_ADMIN);
+        return;
+    default:
+        return;
+    }
+    sleep(5);
+}
+
 int read_string_by_token(FILE *file, const wchar_t *token, const size_t len, wchar_t *string)
 {
     wchar_t input[SIZE_INPUT_MAX] = {0};
@@ -2345,3 +9401,389 @@ int read_string_by_token(FILE *file, const wchar_t *token, const size_t len, wch
 
     return 0;
 }
+
+
+FieldReader *open_field_reader(const char *file_name)
+{
+    FILE *file_pointer;
+    file_pointer = fopen(file_name, "r");
+    if (file_pointer == NULL)
+        return NULL;
+
+    FieldReader *reader = malloc(sizeof(FieldReader));
+    reader->file = file_pointer;
+    reader->capacity = SIZE_READ_BLOCK;
+    reader->buffer = malloc(reader->capacity);
+    reader->begin = 0;
+    reader->end = 0;
+    reader->is_eof = 0;
+
+    return reader;
+}
+int read_fields(FieldReader *reader, const char *token, const size_t count, FieldView *fields)
+{
+    const size_t token_len = strlen(token);
+    size_t now_field = 0;
+    size_t position = reader->begin;
+    size_t search = position;
+    const char *found = NULL;
+
+    while (now_field < count)
+    {
+        // 토큰의 첫 글자를 memchr로 찾은 후 나머지를 비교함
+        found = NULL;
+        while (search + token_len <= reader->end)
+        {
+            found = memchr(reader->buffer + search, token[0], reader->end - search - token_len + 1);
+            if (found == NULL || memcmp(found, token, token_len) == 0)
+                break;
+            search = (found - reader->buffer) + 1;
+            found = NULL;
+        }
+        if (found != NULL)
+        {
+            fields[now_field].text = reader->buffer + position;
+            fields[now_field].size = found - (reader->buffer + position);
+            position = (found - reader->buffer) + token_len;
+            search = position;
+            now_field++;
+            continue;
+        }
+        if (reader->is_eof)
+            return EOF;
+
+        // 읽던 레코드를 버퍼 앞으로 옮기고, 레코드가 버퍼보다 크면 버퍼를 늘림
+        size_t used = reader->end - reader->begin;
+        memmove(reader->buffer, reader->buffer + reader->begin, used);
+        reader->begin = 0;
+        reader->end = used;
+        if (reader->end == reader->capacity)
+        {
+            reader->capacity *= 2;
+            reader->buffer = realloc(reader->buffer, reader->capacity);
+        }
+
+        size_t read_size = fread(reader->buffer + reader->end, 1, reader->capacity - reader->end, reader->file);
+        if (read_size == 0)
+            reader->is_eof = 1;
+        reader->end += read_size;
+
+        // 버퍼가 옮겨졌으므로 레코드의 처음부터 다시 찾음
+        now_field = 0;
+        position = 0;
+        search = 0;
+    }
+    reader->begin = position;
+
+    return 0;
+}
+void close_field_reader(FieldReader *reader)
+{
+    if (reader != NULL)
+    {
+        fclose(reader->file);
+        free(reader->buffer);
+        free(reader);
+    }
+}
+size_t copy_field(const FieldView *field, wchar_t *string, const size_t size)
+{
+    mbstate_t state;
+    size_t now_byte = 0;
+    size_t now_char = 0;
+    size_t char_size;
+
+    memset(&state, 0, sizeof(state));
+    while (now_byte < field->size && now_char + 1 < size)
+    {
+        // ASCII 문자는 변환 없이 바로 복사함
+        if ((unsigned char)field->text[now_byte] < 0x80)
+        {
+            string[now_char++] = (wchar_t)field->text[now_byte++];
+            continue;
+        }
+        char_size = mbrtowc(&string[now_char], field->text + now_byte, field->size - now_byte, &state);
+        if (char_size == (size_t)-1 || char_size == (size_t)-2 || char_size == 0)
+            break;
+        now_byte += char_size;
+        now_char++;
+    }
+    string[now_char] = L'\0';
+
+    return now_char;
+}
+int reject_fields(const char *file_name, FILE **rejected, const FieldView *fields, const size_t count, const _Bool is_read_only)
+{
+    if (is_read_only)
+        return 0;
+    if (*rejected == NULL)
+    {
+        char rejected_name[FILENAME_MAX];
+        snprintf(rejected_name, sizeof(rejected_name), "%s%s", file_name, STRING_REJECTED_EXTENSION);
+        *rejected = fopen(rejected_name, "a");
+        if (*rejected == NULL)
+            return EOF;
+    }
+
+    // 읽은 그대로 쓰므로 원래 파일처럼 다시 읽을 수 있음
+    for (size_t i = 0; i < count; i++)
+    {
+        fwrite(fields[i].text, 1, fields[i].size, *rejected);
+        fputs(" | ", *rejected);
+    }
+
+    return ferror(*rejected) ? EOF : 0;
+}
+int close_rejected_fields(const char *file_name, FILE *rejected, const size_t rejected_count, int result)
+{
+    if (rejected != NULL && fclose(rejected) != 0)
+        result = EOF;
+    if (rejected_count == 0)
+        return 0;
+
+    if (result != 0)
+        fwprintf(stderr, L"%s: 읽을 수 없는 %zu개 행을 %s%s에 보관하지 못했습니다.\n", file_name, rejected_count, file_name, STRING_REJECTED_EXTENSION);
+    else if (rejected == NULL)
+        fwprintf(stderr, L"%s: 읽을 수 없는 %zu개 행을 불러오지 않았습니다.\n", file_name, rejected_count);
+    else
+        fwprintf(stderr, L"%s: 읽을 수 없는 %zu개 행을 %s%s에 옮겼습니다.\n", file_name, rejected_count, file_name, STRING_REJECTED_EXTENSION);
+
+    return result;
+}
+wchar_t next_text_character(const char **text)
+{
+    const unsigned char *bytes = (const unsigned char *)*text;
+    uint32_t character = 0;
+    size_t size = 0;
+
+    if (bytes[0] < 0x80)
+    {
+        if (bytes[0] != 0)
+            (*text)++;
+        return (wchar_t)bytes[0];
+    }
+    if (bytes[0] >= 0xC2 && bytes[0] < 0xE0)
+    {
+        character = bytes[0] & 0x1F;
+        size = 2;
+    }
+    else if (bytes[0] >= 0xE0 && bytes[0] < 0xF0)
+    {
+        character = bytes[0] & 0x0F;
+        size = 3;
+    }
+    else if (bytes[0] >= 0xF0 && bytes[0] < 0xF5)
+    {
+        character = bytes[0] & 0x07;
+        size = 4;
+    }
+    else
+    {
+        (*text)++;
+        return (wchar_t)0xFFFD;
+    }
+
+    for (size_t i = 1; i < size; i++)
+    {
+        // NUL도 여기서 걸러지므로 문자열 밖을 읽지 않음
+        if ((bytes[i] & 0xC0) != 0x80)
+        {
+            *text += i;
+            return (wchar_t)0xFFFD;
+        }
+        character = character << 6 | (bytes[i] & 0x3F);
+    }
+    *text += size;
+    return (wchar_t)character;
+}
+size_t put_text_character(const wchar_t character, char *text)
+{
+    uint32_t code = (uint32_t)character;
+
+    if (code < 0x80)
+    {
+        text[0] = (char)code;
+        return 1;
+    }
+    if (code < 0x800)
+    {
+        text[0] = (char)(0xC0 | code >> 6);
+        text[1] = (char)(0x80 | (code & 0x3F));
+        return 2;
+    }
+    if (code > 0x10FFFF)
+        code = 0xFFFD;
+    if (code < 0x10000)
+    {
+        text[0] = (char)(0xE0 | code >> 12);
+        text[1] = (char)(0x80 | (code >> 6 & 0x3F));
+        text[2] = (char)(0x80 | (code & 0x3F));
+        return 3;
+    }
+    text[0] = (char)(0xF0 | code >> 18);
+    text[1] = (char)(0x80 | (code >> 12 & 0x3F));
+    text[2] = (char)(0x80 | (code >> 6 & 0x3F));
+    text[3] = (char)(0x80 | (code & 0x3F));
+    return 4;
+}
+size_t encode_text(const wchar_t *string, char *text, const size_t size)
+{
+    char character[4];
+    size_t character_size = 0;
+    size_t used = 0;
+
+    for (; *string != L'\0'; string++)
+    {
+        character_size = put_text_character(*string, character);
+        if (used + character_size + 1 > size)
+            break;
+        memcpy(text + used, character, character_size);
+        used += character_size;
+    }
+    text[used] = '\0';
+
+    return used;
+}
+size_t decode_text(const char *text, wchar_t *string, const size_t size)
+{
+    size_t length = 0;
+
+    while (length + 1 < size && (string[length] = next_text_character(&text)) != L'\0')
+        length++;
+    string[length] = L'\0';
+
+    return length;
+}
+size_t get_text_size(const wchar_t *string)
+{
+    char character[4];
+    size_t size = 0;
+
+    for (; *string != L'\0'; string++)
+        size += put_text_character(*string, character);
+    return size;
+}
+int compare_text(const char *text, const wchar_t *string)
+{
+    wchar_t character = 0;
+
+    do
+    {
+        character = next_text_character(&text);
+        if (character != *string)
+            return character < *string ? -1 : 1;
+    } while (*string++ != L'\0');
+    return 0;
+}
+int set_utf8_locale(void)
+{
+    const char *locales[] = {"C.UTF-8", "C.utf8", "en_US.UTF-8", "ko_KR.UTF-8"};
+
+    setlocale(LC_ALL, "");
+    if (strcmp(nl_langinfo(CODESET), "UTF-8") == 0)
+        return 0;
+    for (size_t i = 0; i < sizeof(locales) / sizeof(locales[0]); i++)
+        if (setlocale(LC_CTYPE, locales[i]) != NULL && strcmp(nl_langinfo(CODESET), "UTF-8") == 0)
+            return 0;
+
+    return EOF;
+}
+int run_command(Data *data, const int argc, char *argv[])
+{
+    BorrowCursor borrows;
+    size_t count = 0;
+
+    if (strcmp(argv[0], "overdue") == 0)
+    {
+        const time_t now = argc > 1 ? get_date(argv[1]) : time(NULL);
+        if (now == EOF)
+        {
+            fwprintf(stderr, L"날짜는 YYYY-MM-DD로 입력하세요.\n");
+            return EOF;
+        }
+        find_overdue_borrows(&data->borrow_index, now, &borrows);
+        count = print_due_borrows(&borrows, SIZE_MAX);
+        wprintf(L"\n연체된 대여: %zu건\n", count);
+        return 0;
+    }
+    if (strcmp(argv[0], "due") == 0)
+    {
+        count = argc > 1 ? strtoul(argv[1], NULL, 10) : SIZE_DUE_LIST;
+        find_due_borrows(&data->borrow_index, time(NULL), &borrows);
+        count = print_due_borrows(&borrows, count);
+        wprintf(L"\n반납 예정 대여: %zu건\n", count);
+        return 0;
+    }
+    if (strcmp(argv[0], "loans") == 0 || strcmp(argv[0], "loan-count") == 0)
+    {
+        const time_t from = argc > 2 ? get_date(argv[1]) : EOF;
+        const time_t to = argc > 2 ? get_date(argv[2]) : EOF;
+        if (from == EOF || to == EOF)
+        {
+            fwprintf(stderr, L"사용법: %s YYYY-MM-DD YYYY-MM-DD\n", argv[0]);
+            return EOF;
+        }
+        if (data->history.is_broken)
+            return EOF;
+
+        if (strcmp(argv[0], "loans") == 0)
+        {
+            LoanHistoryCursor loans;
+            const LoanRecord *loan = NULL;
+            struct tm *t;
+
+            find_loans_by_date(&data->history, from, get_next_date(to), &loans);
+            while ((loan = next_loan_history_cursor(&loans)) != NULL)
+            {
+                const time_t loan_date = loan->loan_date;
+                t = localtime(&loan_date);
+                wprintf(L"%04d-%02d-%02d %02d:%02d:%02d | %08u | %07u\n",
+                        t->tm_year + 1900, t->tm_mon + 1, t->tm_mday, t->tm_hour, t->tm_min, t->tm_sec,
+                        loan->student_number, loan->book_number);
+                count++;
+            }
+            wprintf(L"\n대여: %zu건\n", count);
+            return 0;
+        }
+
+        // 날마다 범위의 양 끝만 찾음
+        for (time_t date = from, next = 0; date <= to; date = next)
+        {
+            next = get_next_date(date);
+            const size_t day_count = count_loans_by_date(&data->history, date, next);
+            const struct tm *t = localtime(&date);
+            wprintf(L"%04d-%02d-%02d | %zu\n", t->tm_year + 1900, t->tm_mon + 1, t->tm_mday, day_count);
+            count += day_count;
+        }
+        wprintf(L"\n대여: %zu건\n", count);
+        return 0;
+    }
+    fwprintf(stderr, L"사용법: overdue [YYYY-MM-DD] | due [N] | loans FROM TO | loan-count FROM TO\n");
+    return EOF;
+}
+time_t get_date(const char *string)
+{
+    struct tm date = {0};
+
+    if (sscanf(string, "%d-%d-%d", &date.tm_year, &date.tm_mon, &date.tm_mday) != 3 ||
+        date.tm_mon < 1 || date.tm_mon > 12 || date.tm_mday < 1 || date.tm_mday > 31)
+        return EOF;
+    date.tm_year -= 1900;
+    date.tm_mon -= 1;
+    date.tm_isdst = -1;
+
+    return mktime(&date);
+}
+time_t get_next_date(const time_t date)
+{
+    struct tm t = *localtime(&date);
+
+    // 서머타임이 있어도 다음 날 0시가 됨
+    t.tm_mday++;
+    t.tm_hour = 0;
+    t.tm_min = 0;
+    t.tm_sec = 0;
+    t.tm_isdst = -1;
+
+    return mktime(&t);
+}